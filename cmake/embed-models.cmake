@@ -0,0 +1,49 @@
+# Generate a source file that compiles model files into the library.
+#
+# Configure mode:  vad_embed_models(<output.cc> <models_dir> [model files...])
+# Script mode:     cmake -DOUTPUT=... -DMODELS_DIR=... -DMODELS=a;b -P embed-models.cmake
+#
+# With no models the generated table only holds the terminating null entry.
+
+function(vad_embed_models output models_dir)
+    set(model_paths)
+    foreach(name IN LISTS ARGN)
+        if(NOT EXISTS "${models_dir}/${name}")
+            message(FATAL_ERROR "VAD_EMBED_MODELS: ${models_dir}/${name} not found")
+        endif()
+        list(APPEND model_paths "${models_dir}/${name}")
+    endforeach()
+    string(REPLACE ";" "\\;" models_arg "${ARGN}")
+    add_custom_command(
+        OUTPUT ${output}
+        COMMAND ${CMAKE_COMMAND}
+            -DOUTPUT=${output}
+            -DMODELS_DIR=${models_dir}
+            "-DMODELS=${models_arg}"
+            -P ${CMAKE_CURRENT_FUNCTION_LIST_FILE}
+        DEPENDS ${model_paths} ${CMAKE_CURRENT_FUNCTION_LIST_FILE}
+        COMMENT "Embedding VAD models: ${ARGN}"
+        VERBATIM
+    )
+endfunction()
+
+if(CMAKE_SCRIPT_MODE_FILE)
+    set(content "// Generated by cmake/embed-models.cmake, do not edit\n")
+    string(APPEND content "#include \"utils/embedded-models.h\"\n\nnamespace VadFilterOnnx {\n\n")
+    set(entries)
+    set(index 0)
+    foreach(name IN LISTS MODELS)
+        file(READ "${MODELS_DIR}/${name}" hex HEX)
+        file(SIZE "${MODELS_DIR}/${name}" size)
+        string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1," bytes "${hex}")
+        string(REGEX REPLACE "(0x..,0x..,0x..,0x..,0x..,0x..,0x..,0x..,0x..,0x..,0x..,0x..,0x..,0x..,0x..,0x..,)"
+               "\\1\n" bytes "${bytes}")
+        # 64-byte alignment lets ORT-format models be used in place
+        string(APPEND content "alignas(64) static const unsigned char kModel${index}[] = {\n${bytes}};\n\n")
+        string(APPEND entries "    { \"${name}\", kModel${index}, ${size} },\n")
+        math(EXPR index "${index} + 1")
+    endforeach()
+    string(APPEND content "extern const EmbeddedModel kEmbeddedModels[] = {\n${entries}")
+    string(APPEND content "    { nullptr, nullptr, 0 },\n};\n\n} // namespace VadFilterOnnx\n")
+    file(WRITE "${OUTPUT}" "${content}")
+endif()
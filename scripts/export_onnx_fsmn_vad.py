@@ -26,6 +26,12 @@ def get_args():
     parser.add_argument(
         "--quantize", type=int, default=1, help="Export quantized int8 model"
     )
+    parser.add_argument(
+        "--backbone-only",
+        action="store_true",
+        help="Export the network without StreamingFbankLFR; it takes LFR+CMVN features "
+        "computed by the native C++ frontend (CMVN is stored in the metadata)",
+    )
     return parser.parse_args()
 
 
@@ -197,6 +203,41 @@ class FsmnVadStreamingExport(nn.Module):
         )
 
 
+class FsmnVadBackboneExport(FsmnVadStreamingExport):
+    """FsmnVadStreamingExport without the frontend: takes (B, T, 400) LFR+CMVN features."""
+
+    def forward(
+        self,
+        feats: torch.Tensor,
+        in_cache0: torch.Tensor,
+        in_cache1: torch.Tensor,
+        in_cache2: torch.Tensor,
+        in_cache3: torch.Tensor,
+    ):
+        x = self.in_linear1(feats)
+        x = self.in_linear2(x)
+        x = self.relu(x)
+
+        caches = [in_cache0, in_cache1, in_cache2, in_cache3]
+        out_caches = []
+        for i, d in enumerate(self.fsmn):
+            x, out_cache = d(x, caches[i])
+            out_caches.append(out_cache)
+
+        x = self.out_linear1(x)
+        x = self.out_linear2(x)
+        x = self.softmax(x)
+        x = x[:, :, 0]
+
+        return (
+            x,
+            out_caches[0],
+            out_caches[1],
+            out_caches[2],
+            out_caches[3],
+        )
+
+
 def create_dummy_inputs(encoder_conf):
     """创建用于ONNX导出的dummy inputs"""
     num_samples = 1 * 16000
@@ -294,7 +335,9 @@ def quantize_onnx_model(input_path, output_path):
     print(f"Quantized model saved to: {output_path}")
 
 
-def export_onnx(model_dir, output_path, sample_rate=8000, quantize=False):
+def export_onnx(
+    model_dir, output_path, sample_rate=8000, quantize=False, backbone_only=False
+):
     """导出FsmnVadStreaming模型为ONNX格式"""
     # 加载模型
     model = AutoModel(model=model_dir, device="cpu", disable_update=True)
@@ -305,12 +348,32 @@ def export_onnx(model_dir, output_path, sample_rate=8000, quantize=False):
     # 创建导出模型
     print(model.model.encoder)
     preprocess_module = StreamingFbankLFR(sample_rate, cmvn)
-    export_model = FsmnVadStreamingExport(model.model.encoder, preprocess_module).to(
-        "cpu"
-    )
+    export_class = FsmnVadBackboneExport if backbone_only else FsmnVadStreamingExport
+    export_model = export_class(model.model.encoder, preprocess_module).to("cpu")
 
     # 创建dummy inputs
     dummy_inputs = create_dummy_inputs(encoder_conf)
+    input_names = [
+        "speech",
+        "in_cache0",
+        "in_cache1",
+        "in_cache2",
+        "in_cache3",
+        "first_padding",
+        "last_padding",
+    ]
+    dynamic_axes = {
+        "speech": {1: "num_samples"},
+        "logits": {1: "num_frames"},
+    }
+    if backbone_only:
+        feat_dim = cmvn.shape[-1]
+        dummy_inputs = (torch.randn(1, 20, feat_dim),) + dummy_inputs[1:5]
+        input_names = ["feats"] + input_names[1:5]
+        dynamic_axes = {
+            "feats": {1: "num_frames"},
+            "logits": {1: "num_frames"},
+        }
 
     # 设置模型为评估模式
     export_model.eval()
@@ -320,15 +383,7 @@ def export_onnx(model_dir, output_path, sample_rate=8000, quantize=False):
         export_model,
         dummy_inputs,
         output_path,
-        input_names=[
-            "speech",
-            "in_cache0",
-            "in_cache1",
-            "in_cache2",
-            "in_cache3",
-            "first_padding",
-            "last_padding",
-        ],
+        input_names=input_names,
         output_names=[
             "logits",
             "out_cache0",
@@ -336,10 +391,7 @@ def export_onnx(model_dir, output_path, sample_rate=8000, quantize=False):
             "out_cache2",
             "out_cache3",
         ],
-        dynamic_axes={
-            "speech": {1: "num_samples"},
-            "logits": {1: "num_frames"},
-        },
+        dynamic_axes=dynamic_axes,
         opset_version=opset_version,
         verbose=False,
         dynamo=False,
@@ -353,6 +405,11 @@ def export_onnx(model_dir, output_path, sample_rate=8000, quantize=False):
         "model_type": "fsmn_vad",
         "sample_rate": sample_rate,
     }
+    if backbone_only:
+        # Read by FsmnVadModel::load_frontend(); applied as (x + shift) * scale
+        metadata["frontend"] = "fbank_lfr_cmvn"
+        metadata["cmvn_shift"] = ",".join(repr(float(v)) for v in cmvn[0].tolist())
+        metadata["cmvn_scale"] = ",".join(repr(float(v)) for v in cmvn[1].tolist())
     add_metadata_to_onnx(output_path, metadata)
 
     # 量化模型
@@ -373,6 +430,10 @@ if __name__ == "__main__":
         onnx_filename = "fsmn_vad.16k.onnx"
     else:
         raise ValueError(f"Invalid sample rate: {args.sample_rate}")
+    if args.backbone_only:
+        onnx_filename = onnx_filename.replace(".onnx", ".backbone.onnx")
 
     onnx_path = os.path.join(args.model_dir, onnx_filename)
-    export_onnx(args.model_dir, onnx_path, args.sample_rate, args.quantize)
+    export_onnx(
+        args.model_dir, onnx_path, args.sample_rate, args.quantize, args.backbone_only
+    )
@@ -0,0 +1,40 @@
+import os
+import sys
+import wave
+sys.path.append(os.path.join(os.path.dirname(__file__), "../../build/vad-filter-onnx/python/Release"))
+import numpy as np
+import vad_filter_onnx as vad
+
+def decode(model_handle, config, data):
+    instance = model_handle.init(config)
+    return instance.decode(data, True)
+
+def test_decode_dtypes():
+    config = vad.VadConfig()
+    config.sample_rate = 16000
+
+    model_path = os.path.join(os.path.dirname(__file__), "../../public/models/silero_vad.v5.onnx")
+    wav_path = os.path.join(os.path.dirname(__file__), "../../public/wavs/zh.wav")
+    with wave.open(wav_path) as f:
+        pcm16 = np.frombuffer(f.readframes(f.getnframes()), dtype=np.int16)
+    float32 = pcm16.astype(np.float32) / 32768
+    # numpy's default dtype, and what soundfile returns
+    float64 = pcm16.astype(np.float64) / 32768
+    # Strided view, converted to a contiguous float32 copy
+    strided = np.repeat(float64, 2)[::2]
+
+    model_handle = vad.AutoVadModel.create(model_path, num_threads=1, device_id=-1)
+    expected = decode(model_handle, config, float32)
+    assert len(expected) > 0
+    for data in (pcm16, float64, strided):
+        segments = decode(model_handle, config, data)
+        assert np.array_equal(segments, expected), data.dtype
+
+    instance = model_handle.init(config)
+    segments, probs, frame_starts = instance.decode_with_probs(float64, True)
+    assert np.array_equal(segments, expected)
+    assert len(probs) == len(frame_starts) > 0
+    print(f"{len(expected)} segments for int16, float32 and float64 input")
+
+if __name__ == "__main__":
+    test_decode_dtypes()
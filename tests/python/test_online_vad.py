@@ -52,8 +52,9 @@ def test_online_vad():
     segments = instance.decode(mono_data, True)
     print(f"Decoded segments: {segments}")
 
+    # Structured array of vad.segment_dtype
     for segment in segments:
-        print(f"Segment: {segment}")
+        print(f"Segment {segment['idx']}: {segment['start_ms']} - {segment['end_ms']} ms")
 
     # Finalize
     last_segment = instance.flush()
@@ -0,0 +1,35 @@
+import os
+import sys
+import time
+sys.path.append(os.path.join(os.path.dirname(__file__), "../../build/vad-filter-onnx/python/Release"))
+import numpy as np
+import vad_filter_onnx as vad
+
+def test_process_batch():
+    config = vad.VadConfig()
+    config.sample_rate = 16000
+
+    model_path = os.path.join(os.path.dirname(__file__), "../../public/models/silero_vad.v5.onnx")
+    wav_path = os.path.join(os.path.dirname(__file__), "../../public/wavs/zh.wav")
+
+    # One session shared by all workers; each worker runs single threaded
+    model_handle = vad.AutoVadModel.create(model_path, num_threads=1, device_id=-1)
+
+    # Paths and in-memory arrays can be mixed
+    rng = np.random.default_rng(0)
+    noise = (rng.standard_normal(16000 * 5) * 0.01).astype(np.float32)
+    inputs = [wav_path] * 16 + [noise, (noise * 32767).astype(np.int16)]
+
+    begin = time.perf_counter()
+    results = model_handle.process_batch(inputs, config, num_workers=0)
+    print(f"{len(inputs)} inputs in {time.perf_counter() - begin:.3f} s")
+
+    assert len(results) == len(inputs)
+    assert all(segments.dtype == vad.segment_dtype for segments in results)
+    for segments in results[1:16]:
+        assert np.array_equal(segments, results[0])
+    for segment in results[0]:
+        print(f"Segment {segment['idx']}: {segment['start_ms']} - {segment['end_ms']} ms")
+
+if __name__ == "__main__":
+    test_process_batch()
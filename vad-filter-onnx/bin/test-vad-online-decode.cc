@@ -1,7 +1,6 @@
 #include <iostream>
 #include <vector>
 #include <string>
-#include <fstream>
 #include <cstdint>
 #include <algorithm>
 #include <memory>
@@ -9,12 +8,10 @@
 #include <cstdlib>
 #include <cstdio>
 #include <format>
-#include <filesystem>
+#include "utils/wave-reader.h"
 #include "vad-filter-onnx-cxx-api.h"
 #include "vad-config.h"
 
-
-constexpr std::size_t WAV_HEADER_SIZE = 44;
 using namespace VadFilterOnnx;
 
 static void print_usage(char **argv) {
@@ -24,6 +21,7 @@ static void print_usage(char **argv) {
     fprintf(stderr, "  --model-path PATH     path to ONNX model (required)\n");
     fprintf(stderr, "  --wav-path PATH       path to input WAV file (required)\n");
     fprintf(stderr, "  --sample-rate RATE    target sample rate (default: 16000)\n");
+    fprintf(stderr, "  --input-sample-rate RATE  sample rate of the WAV if it differs (default: same)\n");
     fprintf(stderr, "  --threshold THR       VAD threshold (default: 0.4)\n");
     fprintf(stderr, "  --chunk-size-ms MS    chunk size in milliseconds (default: 100)\n");
     fprintf(stderr, "  --speech-win-size-ms MS   speech detection window size (default: 300)\n");
@@ -48,6 +46,8 @@ static void parse_args(int argc, char **argv, std::string &model_path, std::stri
             wav_path = argv[++i];
         } else if (arg == "--sample-rate" && i + 1 < argc) {
             config.sample_rate = std::stoi(argv[++i]);
+        } else if (arg == "--input-sample-rate" && i + 1 < argc) {
+            config.input_sample_rate = std::stoi(argv[++i]);
         } else if (arg == "--threshold" && i + 1 < argc) {
             config.threshold = std::stof(argv[++i]);
         } else if (arg == "--chunk-size-ms" && i + 1 < argc) {
@@ -86,48 +86,6 @@ static void parse_args(int argc, char **argv, std::string &model_path, std::stri
     }
 }
 
-std::vector<float> load_wav(const std::string& path)
-{
-    std::ifstream file(path, std::ios::binary);
-    if (!file) {
-        std::cerr << "Failed to open file: " << path << '\n';
-        return {};
-    }
-
-    const std::uintmax_t file_size = std::filesystem::file_size(path);
-    if (file_size <= WAV_HEADER_SIZE) {
-        std::cerr << "Invalid WAV file: " << path << '\n';
-        return {};
-    }
-
-    file.seekg(WAV_HEADER_SIZE, std::ios::beg);  // 跳过 WAV header
-
-    const std::size_t sample_count =
-        (file_size - WAV_HEADER_SIZE) / sizeof(int16_t);
-
-    std::vector<int16_t> raw(sample_count);
-    file.read(reinterpret_cast<char*>(raw.data()),
-              sample_count * sizeof(int16_t));
-
-    if (!file) {
-        std::cerr << "Read error or truncated file: " << path << '\n';
-        return {};
-    }
-
-    constexpr float scale = 1.0f / 32768.0f;
-    std::vector<float> data(sample_count);
-
-    std::transform(raw.begin(), raw.end(), data.begin(),
-                   [](int16_t v) {
-                       return static_cast<float>(v) * scale;
-                   });
-
-    std::cout << "Loaded " << path
-              << ": " << data.size() << " samples\n";
-
-    return data;
-}
-
 int main(int argc, char *argv[]) {
     std::string model_path;
     std::string wav_path;
@@ -143,9 +101,12 @@ int main(int argc, char *argv[]) {
         std::cout << "  - " << p << std::endl;
     }
 
-    std::vector<float> samples = load_wav(wav_path);
-    if (samples.empty())
+    // Streamed from a memory mapping chunk by chunk, so memory does not grow with the file
+    std::unique_ptr<WaveReader> wav = WaveReader::open(wav_path);
+    if (!wav)
         return 1;
+    std::cout << "Loaded " << wav_path << ": " << wav->num_frames() << " frames, "
+              << wav->num_channels() << " channels, " << wav->sample_rate() << " Hz\n";
 
     // 1. Create model handle (shared resources) using AutoVadModel API
     std::unique_ptr<AutoVadModel> handle = AutoVadModel::create(model_path);
@@ -161,17 +122,26 @@ int main(int argc, char *argv[]) {
         return 1;
     }
 
-    int chunk_size = (config.sample_rate * chunk_size_ms) / 1000;
-    int total_samples = samples.size();
+    int input_rate = config.input_sample_rate > 0 ? config.input_sample_rate : config.sample_rate;
+    if (wav->sample_rate() != input_rate) {
+        std::cerr << "WAV is " << wav->sample_rate() << " Hz, expected " << input_rate
+                  << " Hz (see --input-sample-rate)" << std::endl;
+        return 1;
+    }
+    int chunk_size = (input_rate * chunk_size_ms) / 1000;
+    int channels = wav->num_channels();
+    std::vector<float> chunk(static_cast<size_t>(chunk_size) * channels);
 
     std::cout << "Starting VAD online decoding simulation using AutoVadModel..." << std::endl;
-    for (int i = 0; i < total_samples; i += chunk_size) {
-        int n = std::min(chunk_size, total_samples - i);
-        bool last = (i + n >= total_samples);
-        // printf("Processing chunk %d of %d samples, last: %d\n", i, total_samples, last);
-
-        // Simulating online/streaming data input
-        std::vector<VadSegment> segments = model->decode(samples.data() + i, n, last);
+    do {
+        int n = wav->read(chunk.data(), chunk_size);
+        bool last = wav->position() >= wav->num_frames();
+
+        // Simulating online/streaming data input; multichannel audio is downmixed
+        std::vector<VadSegment> segments =
+            channels == 1 ? model->decode(chunk.data(), n, last)
+                          : model->decode_interleaved(chunk.data(), n, channels,
+                                                      ChannelMode::Downmix, last);
         for (const auto &seg : segments) {
             std::string msg = std::format("[VadSegment] idx {} | start_ms {} | end_ms {}", seg.idx,
                                           seg.start_ms, seg.end_ms);
@@ -181,7 +151,7 @@ int main(int argc, char *argv[]) {
             }
             std::cout << msg << std::endl;
         }
-    }
+    } while (wav->position() < wav->num_frames());
 
     return 0;
 }
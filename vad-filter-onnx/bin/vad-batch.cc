@@ -0,0 +1,356 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+#include "utils/wave-reader.h"
+#include "vad-filter-onnx-cxx-api.h"
+#include "vad-config.h"
+
+using namespace VadFilterOnnx;
+using Clock = std::chrono::steady_clock;
+
+// Voice activity detection over a manifest of WAV files: one shared model handle, one
+// instance per worker, one JSONL record per file written as soon as the file is done.
+//
+// Record: {"path":"a.wav","duration_ms":5230,"segments":[{"idx":0,"start_ms":..,"end_ms":..}]}
+// Failed files get {"path":"b.wav","error":"..."} instead and are retried by --resume.
+
+struct BatchOptions {
+    std::string model_path;
+    std::string manifest_path;
+    std::string output_path = "-";
+    int num_workers = 0;
+    int num_threads = 1;
+    int chunk_ms = 10000;
+    bool resume = false;
+    VadConfig config;
+};
+
+static void print_usage(char **argv) {
+    fprintf(stderr, "Usage: %s [options]\n\n", argv[0]);
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr, "  -h, --help            print this help message and exit\n");
+    fprintf(stderr, "  --model-path PATH     path to ONNX model (required)\n");
+    fprintf(stderr, "  --manifest PATH       text file with one WAV path per line (required)\n");
+    fprintf(stderr, "  --output PATH         JSONL output, - for stdout (default: -)\n");
+    fprintf(stderr, "  --resume              append to --output, skipping files it already has\n");
+    fprintf(stderr, "  --num-workers N       decoding threads, 0 for one per core (default: 0)\n");
+    fprintf(stderr, "  --num-threads N       ORT threads of the shared session (default: 1)\n");
+    fprintf(stderr, "  --chunk-ms MS         audio decoded per call (default: 10000)\n");
+    fprintf(stderr, "  --sample-rate RATE    target sample rate (default: 16000)\n");
+    fprintf(stderr, "  --input-sample-rate RATE  sample rate of the WAVs if it differs (default: same)\n");
+    fprintf(stderr, "  --threshold THR       VAD threshold (default: 0.4)\n");
+    fprintf(stderr, "  --speech-win-size-ms MS   speech detection window size (default: 300)\n");
+    fprintf(stderr, "  --speech-win-thr-ms MS    speech detection threshold (default: 250)\n");
+    fprintf(stderr, "  --silence-win-size-ms MS  silence detection window size (default: 600)\n");
+    fprintf(stderr, "  --silence-win-thr-ms MS   silence detection threshold (default: 500)\n");
+    fprintf(stderr, "  --max-speech-ms MS    max speech duration in milliseconds (default: 10000)\n");
+    fprintf(stderr, "  --left-padding-ms MS  left padding in milliseconds (default: 100)\n");
+    fprintf(stderr, "  --right-padding-ms MS right padding in milliseconds (default: 100)\n");
+}
+
+static BatchOptions parse_args(int argc, char **argv) {
+    BatchOptions options;
+    VadConfig &config = options.config;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            print_usage(argv);
+            exit(0);
+        } else if (arg == "--model-path" && i + 1 < argc) {
+            options.model_path = argv[++i];
+        } else if (arg == "--manifest" && i + 1 < argc) {
+            options.manifest_path = argv[++i];
+        } else if (arg == "--output" && i + 1 < argc) {
+            options.output_path = argv[++i];
+        } else if (arg == "--resume") {
+            options.resume = true;
+        } else if (arg == "--num-workers" && i + 1 < argc) {
+            options.num_workers = std::stoi(argv[++i]);
+        } else if (arg == "--num-threads" && i + 1 < argc) {
+            options.num_threads = std::stoi(argv[++i]);
+        } else if (arg == "--chunk-ms" && i + 1 < argc) {
+            options.chunk_ms = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--sample-rate" && i + 1 < argc) {
+            config.sample_rate = std::stoi(argv[++i]);
+        } else if (arg == "--input-sample-rate" && i + 1 < argc) {
+            config.input_sample_rate = std::stoi(argv[++i]);
+        } else if (arg == "--threshold" && i + 1 < argc) {
+            config.threshold = std::stof(argv[++i]);
+        } else if (arg == "--speech-win-size-ms" && i + 1 < argc) {
+            config.speech_window_size_ms = std::stoi(argv[++i]);
+        } else if (arg == "--speech-win-thr-ms" && i + 1 < argc) {
+            config.speech_window_threshold_ms = std::stoi(argv[++i]);
+        } else if (arg == "--silence-win-size-ms" && i + 1 < argc) {
+            config.silence_window_size_ms = std::stoi(argv[++i]);
+        } else if (arg == "--silence-win-thr-ms" && i + 1 < argc) {
+            config.silence_window_threshold_ms = std::stoi(argv[++i]);
+        } else if (arg == "--max-speech-ms" && i + 1 < argc) {
+            config.max_speech_ms = std::stoi(argv[++i]);
+        } else if (arg == "--left-padding-ms" && i + 1 < argc) {
+            config.left_padding_ms = std::stoi(argv[++i]);
+        } else if (arg == "--right-padding-ms" && i + 1 < argc) {
+            config.right_padding_ms = std::stoi(argv[++i]);
+        } else {
+            std::cerr << "Unknown argument: " << arg << std::endl;
+            print_usage(argv);
+            exit(1);
+        }
+    }
+    if (options.model_path.empty() || options.manifest_path.empty()) {
+        std::cerr << "Error: --model-path and --manifest are required." << std::endl;
+        print_usage(argv);
+        exit(1);
+    }
+    if (options.resume && options.output_path == "-") {
+        std::cerr << "Error: --resume needs an --output file." << std::endl;
+        exit(1);
+    }
+    return options;
+}
+
+static std::string json_string(const std::string &s) {
+    std::string out = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "\\u%04x", c);
+            out += buf;
+        } else {
+            out += c;
+        }
+    }
+    return out + "\"";
+}
+
+// Path of a record written by this tool (the first key), empty for failed or torn records
+static std::string completed_path(const std::string &line) {
+    static const std::string kPrefix = "{\"path\":\"";
+    if (line.compare(0, kPrefix.size(), kPrefix) != 0 || line.back() != '}' ||
+        line.find("\"error\":") != std::string::npos) {
+        return {};
+    }
+    std::string path;
+    for (size_t i = kPrefix.size(); i < line.size(); ++i) {
+        char c = line[i];
+        if (c == '"') {
+            return path;
+        }
+        if (c == '\\' && i + 1 < line.size()) {
+            c = line[++i];
+            if (c == 'u' && i + 4 < line.size()) {
+                c = static_cast<char>(std::stoi(line.substr(i + 1, 4), nullptr, 16));
+                i += 4;
+            }
+        }
+        path += c;
+    }
+    return {};
+}
+
+static std::vector<std::string> read_manifest(const std::string &path) {
+    std::vector<std::string> paths;
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "Failed to open manifest: " << path << std::endl;
+        exit(1);
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+        line.erase(line.find_last_not_of(" \t\r") + 1);
+        line.erase(0, std::min(line.size(), line.find_first_not_of(" \t")));
+        if (!line.empty() && line[0] != '#') {
+            paths.push_back(line);
+        }
+    }
+    return paths;
+}
+
+// Files done by a previous run; a torn last line (killed mid-write) is terminated
+static std::unordered_set<std::string> read_completed(const std::string &path) {
+    std::unordered_set<std::string> done;
+    std::ifstream file(path, std::ios::binary);
+    std::string line;
+    bool terminated = true;
+    while (std::getline(file, line)) {
+        terminated = !file.eof();
+        std::string done_path = terminated ? completed_path(line) : std::string();
+        if (!done_path.empty()) {
+            done.insert(done_path);
+        }
+    }
+    if (!terminated) {
+        std::ofstream(path, std::ios::app) << '\n';
+    }
+    return done;
+}
+
+struct FileResult {
+    std::string record;
+    int64_t audio_ms = 0;
+    bool ok = false;
+};
+
+// Decode one file in chunk_ms blocks streamed from the mapping; the instance is reset first
+static FileResult decode_file(AutoVadModel *model, const std::string &path, int input_rate,
+                              int chunk_ms, std::vector<float> *block) {
+    FileResult result;
+    auto wav = WaveReader::open(path);
+    std::string error;
+    if (!wav) {
+        error = "cannot read WAV";
+    } else if (wav->sample_rate() != input_rate) {
+        error = "sample rate " + std::to_string(wav->sample_rate()) + " Hz, expected " +
+                std::to_string(input_rate) + " Hz";
+    }
+    if (!error.empty()) {
+        result.record = "{\"path\":" + json_string(path) + ",\"error\":" + json_string(error) + "}";
+        return result;
+    }
+
+    model->reset();
+    int channels = wav->num_channels();
+    int64_t total = wav->num_frames();
+    int chunk = std::max(1, static_cast<int>(static_cast<int64_t>(input_rate) * chunk_ms / 1000));
+    block->resize(static_cast<size_t>(chunk) * channels);
+    std::string segments;
+    do {
+        int n = wav->read(block->data(), chunk);
+        bool last = wav->position() >= total;
+        auto segs = channels == 1 ? model->decode(block->data(), n, last)
+                                  : model->decode_interleaved(block->data(), n, channels,
+                                                              ChannelMode::Downmix, last);
+        for (const auto &seg : segs) {
+            if (seg.end == -1) {
+                continue;
+            }
+            segments += segments.empty() ? "" : ",";
+            segments += "{\"idx\":" + std::to_string(seg.idx) +
+                        ",\"start_ms\":" + std::to_string(seg.start_ms) +
+                        ",\"end_ms\":" + std::to_string(seg.end_ms) + "}";
+        }
+    } while (wav->position() < total);
+
+    result.audio_ms = total * 1000 / input_rate;
+    result.record = "{\"path\":" + json_string(path) +
+                    ",\"duration_ms\":" + std::to_string(result.audio_ms) + ",\"segments\":[" +
+                    segments + "]}";
+    result.ok = true;
+    return result;
+}
+
+int main(int argc, char *argv[]) {
+    BatchOptions options = parse_args(argc, argv);
+    const VadConfig &config = options.config;
+    int input_rate = config.input_sample_rate > 0 ? config.input_sample_rate : config.sample_rate;
+
+    std::vector<std::string> paths = read_manifest(options.manifest_path);
+    size_t num_skipped = 0;
+    if (options.resume) {
+        auto done = read_completed(options.output_path);
+        size_t before = paths.size();
+        paths.erase(std::remove_if(paths.begin(), paths.end(),
+                                   [&](const std::string &p) { return done.count(p) > 0; }),
+                    paths.end());
+        num_skipped = before - paths.size();
+    }
+
+    FILE *out = stdout;
+    if (options.output_path != "-") {
+        out = fopen(options.output_path.c_str(), options.resume ? "ab" : "wb");
+        if (!out) {
+            std::cerr << "Failed to open output: " << options.output_path << std::endl;
+            return 1;
+        }
+    }
+
+    // Workers run single-threaded sessions side by side
+    SessionConfig session_config;
+    session_config.num_threads = options.num_threads;
+    auto handle = AutoVadModel::create(options.model_path, session_config);
+    if (!handle) {
+        std::cerr << "Failed to create VAD model handle" << std::endl;
+        return 1;
+    }
+
+    int num_workers = options.num_workers > 0
+                          ? options.num_workers
+                          : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    num_workers = std::max(1, std::min(num_workers, static_cast<int>(paths.size())));
+    std::cerr << paths.size() << " files to decode (" << num_skipped << " already done), "
+              << num_workers << " workers" << std::endl;
+
+    // Each worker holds one instance and streams one file at a time through a chunk_ms block;
+    // WaveReader releases the pages it has read, so memory does not grow with file length.
+    std::atomic<size_t> next{ 0 };
+    std::atomic<size_t> num_ok{ 0 };
+    std::atomic<size_t> num_failed{ 0 };
+    std::atomic<int64_t> audio_ms{ 0 };
+    std::atomic<int64_t> busy_us{ 0 };
+    std::atomic<bool> init_failed{ false };
+    std::mutex out_mutex;
+    auto begin = Clock::now();
+    auto work = [&]() {
+        auto model = handle->init(config);
+        if (!model) {
+            init_failed = true;
+            return;
+        }
+        std::vector<float> block;
+        for (size_t i = next++; i < paths.size(); i = next++) {
+            auto file_begin = Clock::now();
+            FileResult result =
+                decode_file(model.get(), paths[i], input_rate, options.chunk_ms, &block);
+            busy_us += std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() -
+                                                                             file_begin)
+                           .count();
+            audio_ms += result.audio_ms;
+            (result.ok ? num_ok : num_failed)++;
+            std::lock_guard<std::mutex> lock(out_mutex);
+            fputs(result.record.c_str(), out);
+            fputc('\n', out);
+            // Flushed per record, so an interrupted run can be resumed
+            fflush(out);
+        }
+    };
+    std::vector<std::thread> workers;
+    for (int i = 0; i < num_workers; ++i) {
+        workers.emplace_back(work);
+    }
+    for (auto &t : workers) {
+        t.join();
+    }
+    double wall_s = std::chrono::duration<double>(Clock::now() - begin).count();
+    if (out != stdout) {
+        fclose(out);
+    }
+    if (init_failed && next.load() < paths.size()) {
+        std::cerr << "Failed to init VAD model instance" << std::endl;
+        return 1;
+    }
+
+    double audio_s = audio_ms.load() / 1000.0;
+    double busy_s = busy_us.load() / 1e6;
+    fprintf(stderr, "Files: %zu ok, %zu failed, %zu skipped\n", num_ok.load(), num_failed.load(),
+            num_skipped);
+    fprintf(stderr, "Audio: %.1f s (%.2f h) in %.2f s wall\n", audio_s, audio_s / 3600.0, wall_s);
+    if (wall_s > 0.0 && audio_s > 0.0) {
+        fprintf(stderr, "Throughput: %.1f files/s, %.1fx real time\n",
+                (num_ok.load() + num_failed.load()) / wall_s, audio_s / wall_s);
+        fprintf(stderr, "RTF: %.5f wall, %.5f per worker\n", wall_s / audio_s, busy_s / audio_s);
+    }
+    return num_failed.load() > 0 ? 2 : 0;
+}
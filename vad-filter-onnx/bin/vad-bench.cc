@@ -0,0 +1,488 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "utils/wave-reader.h"
+#include "vad-filter-onnx-cxx-api.h"
+#include "vad-config.h"
+
+using namespace VadFilterOnnx;
+using Clock = std::chrono::steady_clock;
+
+// Counts heap allocations made through global operator new (library and ORT C++ wrappers),
+// so the bench can report allocations per frame without an external profiler
+static std::atomic<int64_t> g_num_allocs{ 0 };
+
+void *operator new(std::size_t size) {
+    g_num_allocs.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+struct BenchOptions {
+    std::vector<std::string> model_paths;
+    std::string wav_path;
+    std::string output_path = "vad-bench.json";
+    std::vector<int> chunk_sizes_ms = { 10, 32, 100, 320 };
+    int num_threads = 1;
+    int repeats = 10;
+    int synthetic_seconds = 30;
+    int warmup_runs = 0;
+    std::vector<int> pool_workers = { 1, 2, 4, 8 };
+    int pool_streams = 16;
+};
+
+struct Stats {
+    double mean = 0.0, p50 = 0.0, p99 = 0.0, p999 = 0.0, max = 0.0;
+    size_t count = 0;
+};
+
+static double elapsed_ms(Clock::time_point begin) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - begin).count();
+}
+
+static Stats compute_stats(std::vector<double> v) {
+    Stats s;
+    s.count = v.size();
+    if (v.empty()) {
+        return s;
+    }
+    std::sort(v.begin(), v.end());
+    for (double x : v) {
+        s.mean += x;
+    }
+    s.mean /= v.size();
+    auto pct = [&](double q) { return v[std::min(v.size() - 1, static_cast<size_t>(q * v.size()))]; };
+    s.p50 = pct(0.5);
+    s.p99 = pct(0.99);
+    s.p999 = pct(0.999);
+    s.max = v.back();
+    return s;
+}
+
+static std::string json_string(const std::string &s) {
+    std::string out = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+        }
+        out += c;
+    }
+    return out + "\"";
+}
+
+static std::string json_stats(const Stats &s) {
+    char buf[256];
+    snprintf(buf, sizeof(buf),
+             "{\"count\": %zu, \"mean\": %.4f, \"p50\": %.4f, \"p99\": %.4f, \"p999\": %.4f, "
+             "\"max\": %.4f}",
+             s.count, s.mean, s.p50, s.p99, s.p999, s.max);
+    return buf;
+}
+
+static void print_usage(char **argv) {
+    fprintf(stderr, "Usage: %s [options]\n\n", argv[0]);
+    fprintf(stderr, "Benchmarks create/init/reset cost, first-chunk and per-call latency,\n");
+    fprintf(stderr, "per-frame forward latency, real-time factor, allocations per frame and\n");
+    fprintf(stderr, "stream pool thread scaling for each model, and writes the results as JSON.\n\n");
+    fprintf(stderr, "options:\n");
+    fprintf(stderr, "  -h, --help              print this help message and exit\n");
+    fprintf(stderr, "  --model-path PATH       ONNX model to benchmark (repeatable)\n");
+    fprintf(stderr, "  --models-dir DIR        benchmark every .onnx model in DIR\n");
+    fprintf(stderr, "  --wav-path PATH         16 kHz mono 16-bit WAV input (default: synthetic)\n");
+    fprintf(stderr, "  --seconds N             length of the synthetic input (default: 30)\n");
+    fprintf(stderr, "  --chunk-sizes-ms LIST   comma separated chunk sizes (default: 10,32,100,320)\n");
+    fprintf(stderr, "  --num-threads N         session threads (default: 1)\n");
+    fprintf(stderr, "  --repeats N             repetitions of create/init/reset (default: 10)\n");
+    fprintf(stderr, "  --warmup-runs N         warm-up inferences in init (default: 0)\n");
+    fprintf(stderr, "  --pool-workers LIST     stream pool sizes for the thread scaling run\n");
+    fprintf(stderr, "                          (default: 1,2,4,8; empty to skip)\n");
+    fprintf(stderr, "  --pool-streams N        concurrent streams in the scaling run (default: 16)\n");
+    fprintf(stderr, "  --output PATH           JSON output file, - for stdout\n");
+    fprintf(stderr, "                          (default: vad-bench.json)\n");
+}
+
+static std::vector<int> parse_int_list(const std::string &s) {
+    std::vector<int> out;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) {
+            out.push_back(std::stoi(item));
+        }
+    }
+    return out;
+}
+
+static void parse_args(int argc, char **argv, BenchOptions &opts) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            print_usage(argv);
+            exit(0);
+        } else if (arg == "--model-path" && i + 1 < argc) {
+            opts.model_paths.push_back(argv[++i]);
+        } else if (arg == "--models-dir" && i + 1 < argc) {
+            std::vector<std::string> found;
+            std::error_code ec;
+            for (const auto &entry : std::filesystem::directory_iterator(argv[++i], ec)) {
+                if (entry.path().extension() == ".onnx") {
+                    found.push_back(entry.path().string());
+                }
+            }
+            if (ec) {
+                std::cerr << "Error: cannot list " << argv[i] << ": " << ec.message() << std::endl;
+                exit(1);
+            }
+            std::sort(found.begin(), found.end());
+            opts.model_paths.insert(opts.model_paths.end(), found.begin(), found.end());
+        } else if (arg == "--wav-path" && i + 1 < argc) {
+            opts.wav_path = argv[++i];
+        } else if (arg == "--seconds" && i + 1 < argc) {
+            opts.synthetic_seconds = std::stoi(argv[++i]);
+        } else if (arg == "--chunk-sizes-ms" && i + 1 < argc) {
+            opts.chunk_sizes_ms = parse_int_list(argv[++i]);
+        } else if (arg == "--num-threads" && i + 1 < argc) {
+            opts.num_threads = std::stoi(argv[++i]);
+        } else if (arg == "--repeats" && i + 1 < argc) {
+            opts.repeats = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--warmup-runs" && i + 1 < argc) {
+            opts.warmup_runs = std::stoi(argv[++i]);
+        } else if (arg == "--pool-workers" && i + 1 < argc) {
+            opts.pool_workers = parse_int_list(argv[++i]);
+        } else if (arg == "--pool-streams" && i + 1 < argc) {
+            opts.pool_streams = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--output" && i + 1 < argc) {
+            opts.output_path = argv[++i];
+        } else {
+            std::cerr << "Unknown argument: " << arg << std::endl;
+            print_usage(argv);
+            exit(1);
+        }
+    }
+
+    if (opts.model_paths.empty()) {
+        std::cerr << "Error: --model-path or --models-dir is required." << std::endl;
+        print_usage(argv);
+        exit(1);
+    }
+    if (opts.chunk_sizes_ms.empty()) {
+        std::cerr << "Error: --chunk-sizes-ms is empty." << std::endl;
+        exit(1);
+    }
+}
+
+// Mono 16-bit copy of a WAV file (channels averaged); the repeats need it in memory
+static std::vector<int16_t> load_wav(const std::string &path) {
+    auto wav = WaveReader::open(path);
+    if (!wav) {
+        return {};
+    }
+    // Input positions, RTF and the resampler setup all assume 16 kHz
+    if (wav->sample_rate() != 16000) {
+        std::cerr << "Error: " << path << " is " << wav->sample_rate()
+                  << " Hz, the bench needs 16 kHz input." << std::endl;
+        return {};
+    }
+    const int block_frames = 4096;
+    int channels = wav->num_channels();
+    std::vector<float> block(static_cast<size_t>(block_frames) * channels);
+    std::vector<int16_t> pcm;
+    pcm.reserve(static_cast<size_t>(wav->num_frames()));
+    while (int n = wav->read(block.data(), block_frames)) {
+        for (int i = 0; i < n; ++i) {
+            float sum = 0.0f;
+            for (int c = 0; c < channels; ++c) {
+                sum += block[static_cast<size_t>(i) * channels + c];
+            }
+            float v = std::clamp(sum / channels * 32768.0f, -32768.0f, 32767.0f);
+            pcm.push_back(static_cast<int16_t>(std::lrint(v)));
+        }
+    }
+    return pcm;
+}
+
+// Alternating noise bursts and silence at 16 kHz, so both the speech and the silence paths
+// of every model are exercised
+static std::vector<int16_t> synthetic_audio(int seconds) {
+    const int rate = 16000;
+    std::vector<int16_t> audio(static_cast<size_t>(rate) * seconds);
+    uint32_t state = 1;
+    for (size_t i = 0; i < audio.size(); ++i) {
+        state = state * 1664525u + 1013904223u;
+        double noise = (static_cast<double>(state >> 8) / (1 << 24) - 0.5);
+        bool burst = (i / (rate / 2)) % 3 != 2;
+        double voiced = burst ? 0.3 * std::sin(2.0 * 3.14159265358979 * 180.0 * i / rate) : 0.0;
+        audio[i] = static_cast<int16_t>(32767.0 * (voiced + (burst ? 0.2 : 0.005) * noise));
+    }
+    return audio;
+}
+
+// The 8 kHz FSMN models are named *.8k.*; everything else runs at 16 kHz
+static int model_sample_rate(const std::string &path) {
+    return std::filesystem::path(path).filename().string().find("8k") != std::string::npos ? 8000
+                                                                                            : 16000;
+}
+
+// Thread scaling of the stream pool: every stream gets the whole input in 100 ms chunks, fed
+// up front, and the run ends when the last stream is flushed. The spread of the per-stream
+// completion times shows whether the workers serve the streams fairly.
+static std::string bench_pool(const std::string &model_path, const BenchOptions &opts,
+                              const VadConfig &config, std::vector<float> &audio) {
+    // Parallelism comes from the workers, not from the session
+    SessionConfig session_config;
+    session_config.num_threads = 1;
+    session_config.warmup_runs = opts.warmup_runs;
+    auto handle = AutoVadModel::create(model_path, session_config);
+    if (!handle) {
+        return "";
+    }
+
+    std::ostringstream js;
+    const double audio_seconds = audio.size() / 16000.0;
+    const int total = static_cast<int>(audio.size());
+    const int chunk_size = 1600;
+    double base_ms = 0.0;
+    for (size_t p = 0; p < opts.pool_workers.size(); ++p) {
+        int num_workers = opts.pool_workers[p];
+        auto pool = handle->create_stream_pool(num_workers);
+        std::vector<int> ids;
+        for (int k = 0; k < opts.pool_streams; ++k) {
+            int id = pool->add_stream(config);
+            if (id < 0) {
+                return "";
+            }
+            ids.push_back(id);
+        }
+
+        auto t0 = Clock::now();
+        for (int i = 0; i < total; i += chunk_size) {
+            int n = std::min(chunk_size, total - i);
+            for (int id : ids) {
+                pool->feed(id, audio.data() + i, n, i + n >= total);
+            }
+        }
+        std::vector<double> done_ms;
+        VadStreamResult result;
+        while (static_cast<int>(done_ms.size()) < opts.pool_streams && pool->poll(&result, 60000)) {
+            if (result.finished) {
+                done_ms.push_back(elapsed_ms(t0));
+            }
+        }
+        double wall_ms = elapsed_ms(t0);
+        if (static_cast<int>(done_ms.size()) < opts.pool_streams) {
+            return "";
+        }
+        if (p == 0) {
+            base_ms = wall_ms;
+        }
+
+        char buf[256];
+        snprintf(buf, sizeof(buf),
+                 "%s\n        {\"workers\": %d, \"streams\": %d, \"wall_ms\": %.3f, "
+                 "\"rtf\": %.6f, \"speedup\": %.3f, ",
+                 p ? "," : "", num_workers, opts.pool_streams, wall_ms,
+                 wall_ms / 1000.0 / (audio_seconds * opts.pool_streams), base_ms / wall_ms);
+        js << buf << "\"done_ms\": " << json_stats(compute_stats(done_ms)) << "}";
+    }
+    return js.str();
+}
+
+static std::string bench_model(const std::string &model_path, const BenchOptions &opts,
+                               std::vector<float> &audio) {
+    std::ostringstream js;
+    js << "    {\n      \"model\": " << json_string(model_path);
+
+    SessionConfig session_config;
+    session_config.num_threads = opts.num_threads;
+    session_config.warmup_runs = opts.warmup_runs;
+    VadConfig config;
+    config.sample_rate = model_sample_rate(model_path);
+    // The input is 16 kHz; 8 kHz models go through the built-in resampler
+    config.input_sample_rate = 16000;
+    js << ",\n      \"sample_rate\": " << config.sample_rate;
+
+    // Startup without the in-process session cache, then the cached path
+    std::vector<double> create_cold, create_cached;
+    SessionConfig uncached = session_config;
+    uncached.enable_session_cache = false;
+    for (int r = 0; r < opts.repeats; ++r) {
+        auto t0 = Clock::now();
+        auto h = AutoVadModel::create(model_path, uncached);
+        create_cold.push_back(elapsed_ms(t0));
+        if (!h) {
+            js << ",\n      \"error\": \"create failed\"\n    }";
+            return js.str();
+        }
+    }
+    auto handle = AutoVadModel::create(model_path, session_config);
+    for (int r = 0; r < opts.repeats; ++r) {
+        auto t0 = Clock::now();
+        auto h = AutoVadModel::create(model_path, session_config);
+        create_cached.push_back(elapsed_ms(t0));
+    }
+
+    // Each fresh instance also times its first decode() call, which pays for whatever init()
+    // did not warm up; compare with call_ms of the same chunk size
+    const int first_chunk = std::min(static_cast<int>(audio.size()),
+                                     std::max(1, 16000 * opts.chunk_sizes_ms[0] / 1000));
+    std::vector<double> init_ms, first_chunk_ms, reset_ms;
+    std::unique_ptr<AutoVadModel> model;
+    for (int r = 0; r < opts.repeats; ++r) {
+        auto t0 = Clock::now();
+        model = handle ? handle->init(config) : nullptr;
+        init_ms.push_back(elapsed_ms(t0));
+        if (!model) {
+            js << ",\n      \"error\": \"init failed\"\n    }";
+            return js.str();
+        }
+        t0 = Clock::now();
+        model->decode(audio.data(), first_chunk, false);
+        first_chunk_ms.push_back(elapsed_ms(t0));
+    }
+    for (int r = 0; r < opts.repeats; ++r) {
+        auto t0 = Clock::now();
+        model->reset();
+        reset_ms.push_back(elapsed_ms(t0));
+    }
+
+    js << ",\n      \"create_ms\": " << json_stats(compute_stats(create_cold));
+    js << ",\n      \"create_cached_ms\": " << json_stats(compute_stats(create_cached));
+    js << ",\n      \"init_ms\": " << json_stats(compute_stats(init_ms));
+    js << ",\n      \"first_chunk_ms\": " << json_stats(compute_stats(first_chunk_ms));
+    js << ",\n      \"reset_ms\": " << json_stats(compute_stats(reset_ms));
+    js << ",\n      \"chunks\": [";
+
+    const double audio_seconds = audio.size() / 16000.0;
+    const int total = static_cast<int>(audio.size());
+    for (size_t c = 0; c < opts.chunk_sizes_ms.size(); ++c) {
+        int chunk_ms = opts.chunk_sizes_ms[c];
+        int chunk_size = std::max(1, 16000 * chunk_ms / 1000);
+        int capacity = model->max_frames(chunk_size);
+        std::vector<float> probs(capacity);
+        std::vector<int> frame_starts(capacity);
+
+        model->reset();
+        std::vector<double> call_ms;
+        double decode_ms = 0.0;
+        int64_t frames = 0;
+        int64_t allocs_before = g_num_allocs.load();
+        for (int i = 0; i < total; i += chunk_size) {
+            int n = std::min(chunk_size, total - i);
+            int num_frames = 0;
+            auto t0 = Clock::now();
+            model->decode(audio.data() + i, n, i + n >= total, probs.data(), frame_starts.data(),
+                          capacity, &num_frames);
+            double ms = elapsed_ms(t0);
+            decode_ms += ms;
+            frames += num_frames;
+            call_ms.push_back(ms);
+        }
+        int64_t allocs = g_num_allocs.load() - allocs_before;
+
+        char buf[256];
+        snprintf(buf, sizeof(buf),
+                 "%s\n        {\"chunk_ms\": %d, \"frames\": %lld, \"rtf\": %.6f, "
+                 "\"allocs_per_frame\": %.3f, ",
+                 c ? "," : "", chunk_ms, static_cast<long long>(frames),
+                 decode_ms / 1000.0 / audio_seconds,
+                 frames ? static_cast<double>(allocs) / frames : 0.0);
+        js << buf << "\"call_ms\": " << json_stats(compute_stats(call_ms)) << "}";
+    }
+    js << "\n      ]";
+
+    // Per-frame forward latency: 1 ms of input per decode() call, so a call scores at most one
+    // frame and a call that scores one times exactly that frame's forward pass
+    {
+        const int step = 16;
+        // Room for the frames flushed by the final call
+        int capacity = model->max_frames(total);
+        std::vector<float> probs(capacity);
+        std::vector<int> frame_starts(capacity);
+        model->reset();
+        std::vector<double> frame_ms;
+        for (int i = 0; i < total; i += step) {
+            int n = std::min(step, total - i);
+            int num_frames = 0;
+            auto t0 = Clock::now();
+            model->decode(audio.data() + i, n, i + n >= total, probs.data(), frame_starts.data(),
+                          capacity, &num_frames);
+            double ms = elapsed_ms(t0);
+            if (num_frames == 1) {
+                frame_ms.push_back(ms);
+            }
+        }
+        js << ",\n      \"frame_ms\": " << json_stats(compute_stats(frame_ms));
+    }
+
+    if (!opts.pool_workers.empty()) {
+        std::string pool = bench_pool(model_path, opts, config, audio);
+        if (pool.empty()) {
+            js << ",\n      \"pool_error\": \"stream pool run failed\"";
+        } else {
+            js << ",\n      \"pool\": [" << pool << "\n      ]";
+        }
+    }
+    js << "\n    }";
+    return js.str();
+}
+
+int main(int argc, char *argv[]) {
+    BenchOptions opts;
+    parse_args(argc, argv, opts);
+
+    std::vector<int16_t> pcm =
+        opts.wav_path.empty() ? synthetic_audio(opts.synthetic_seconds) : load_wav(opts.wav_path);
+    if (pcm.empty()) {
+        return 1;
+    }
+    std::vector<float> audio(pcm.begin(), pcm.end());
+    for (auto &v : audio) {
+        v /= 32768.0f;
+    }
+
+    std::ostringstream js;
+    js << "{\n  \"schema\": 1";
+    js << ",\n  \"timestamp\": " << static_cast<long long>(std::time(nullptr));
+    js << ",\n  \"hardware_threads\": " << std::thread::hardware_concurrency();
+    js << ",\n  \"num_threads\": " << opts.num_threads;
+    js << ",\n  \"input\": " << json_string(opts.wav_path.empty() ? "synthetic" : opts.wav_path);
+    js << ",\n  \"input_seconds\": " << audio.size() / 16000.0;
+    js << ",\n  \"models\": [\n";
+    for (size_t m = 0; m < opts.model_paths.size(); ++m) {
+        std::cerr << "Benchmarking " << opts.model_paths[m] << std::endl;
+        js << (m ? ",\n" : "") << bench_model(opts.model_paths[m], opts, audio);
+    }
+    js << "\n  ]\n}\n";
+
+    if (opts.output_path == "-") {
+        std::cout << js.str();
+    } else {
+        std::ofstream out(opts.output_path);
+        out << js.str();
+        if (!out) {
+            std::cerr << "Failed to write " << opts.output_path << std::endl;
+            return 1;
+        }
+        std::cerr << "Results written to " << opts.output_path << std::endl;
+    }
+    return 0;
+}
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <cstdint>
+#include <string>
+#include <vector>
+
 namespace VadFilterOnnx {
 
 enum class VadType {
@@ -17,14 +21,43 @@ struct VadSegment {
     int end;
     int start_ms;
     int end_ms;
+    int channel; // input channel for ChannelMode::PerChannel, 0 otherwise
+
+    VadSegment(int idx = -1, int start = -1, int end = -1, int start_ms = -1, int end_ms = -1,
+               int channel = 0)
+        : idx(idx), start(start), end(end), start_ms(start_ms), end_ms(end_ms), channel(channel) {}
+};
+
+// Speech audio emitted by decode_speech(): a view of n samples starting at input position
+// `start`. Consecutive chunks of a segment are contiguous; the last one has segment_end set.
+struct SpeechChunk {
+    const float *data = nullptr;
+    int n = 0;
+    int idx = -1;   // segment index
+    int start = 0;  // input sample position of data[0]
+    bool segment_end = false;
+};
+
+// How decode_interleaved() treats multichannel input
+enum class ChannelMode {
+    Downmix,    // average the channels into a single VAD
+    PerChannel, // an independent VAD per channel, segments tagged with their channel
+};
 
-    VadSegment(int idx = -1, int start = -1, int end = -1, int start_ms = -1, int end_ms = -1)
-        : idx(idx), start(start), end(end), start_ms(start_ms), end_ms(end_ms) {}
+struct VadStreamResult {
+    int stream_id = -1;
+    std::vector<VadSegment> segments;
+    bool finished = false; // input_finished was processed, the stream is flushed
 };
 
 struct VadConfig {
     float threshold = 0.4f;
-    int sample_rate = 16000;
+    int sample_rate = 16000;              // model rate, 8000 or 16000
+    // Rate of the audio passed to decode(), 0 for sample_rate. Other rates are resampled to
+    // sample_rate inside the decoder; segment sample positions stay in the input rate.
+    // 16000 with sample_rate 8000 runs the 8k model through a half-band decimator at about
+    // half the inference cost.
+    int input_sample_rate = 0;
     int speech_window_size_ms = 300;      // window size for speech detection (silence -> speech)
     int speech_window_threshold_ms = 250; // speech duration threshold within speech window
     int silence_window_size_ms = 600;     // window size for silence detection (speech -> silence)
@@ -32,6 +65,104 @@ struct VadConfig {
     int max_speech_ms = 10000;            // max speech duration per segment
     int left_padding_ms = 100;            // padding for speech start
     int right_padding_ms = 100;           // padding for speech end
+    bool enable_stats = false;            // keep hot-path counters, see VadStats
+    // Frames whose mean square is below energy_gate_dbfs (full scale is +-1) skip inference:
+    // they score 0 and the recurrent state jumps to the model's settled-on-silence state.
+    // For the frame-based models (Silero, TEN); FSMN ignores it.
+    bool enable_energy_gate = false;
+    float energy_gate_dbfs = -70.0f;
+    // While in silence and the probability stays below adaptive_stride_prob, run the model on
+    // every 2nd, then every 4th... frame and repeat the last probability in between. Any
+    // higher probability returns to full rate. The stride is capped so that a speech onset is
+    // seen at most adaptive_stride_max_latency_ms late. Silero and TEN only.
+    bool enable_adaptive_stride = false;
+    float adaptive_stride_prob = 0.1f;
+    int adaptive_stride_max_latency_ms = 96;
+    // decode_speech(): linear fade-in/out of this length at both ends of every segment, so
+    // the concatenated speech has no clicks at the joins. 0 keeps the samples unchanged.
+    int filter_fade_ms = 0;
+};
+
+// Snapshot of the hot-path counters of an instance, or of all instances of a handle.
+// Times are in nanoseconds. Counters are published at the end of every decode() call.
+struct VadStats {
+    // Bucket 0 counts Session::Run calls under 1us, bucket i those in [2^(i-1), 2^i) us,
+    // the last bucket everything above
+    static constexpr int kNumLatencyBuckets = 16;
+
+    uint64_t decode_calls = 0;
+    uint64_t samples = 0;           // input samples consumed
+    uint64_t frames = 0;            // frames scored
+    uint64_t gated_frames = 0;      // frames skipped by the energy gate, included in frames
+    uint64_t strided_frames = 0;    // frames skipped by the adaptive stride, included in frames
+    uint64_t inference_runs = 0;    // Session::Run calls
+    uint64_t inference_ns = 0;      // time in Session::Run
+    uint64_t state_ns = 0;          // time in the speech/silence state machine
+    uint64_t framing_ns = 0;        // rest of decode(): framing, conversion, resampling
+    uint64_t segments = 0;          // segments closed
+    uint64_t max_speech_splits = 0; // segments split by max_speech_ms
+    int64_t buffered_bytes = 0;     // audio carried to the next decode() call
+    uint64_t inference_latency_us[kNumLatencyBuckets] = {};
+};
+
+struct ShardedDecodeOptions {
+    int num_threads = 4;              // number of shards decoded in parallel
+    int overlap_ms = 3000;            // audio before each shard used to warm up recurrent state
+    int min_shard_ms = 60000;         // shorter inputs are split into fewer shards
+    bool compare_sequential = false;  // also run sequentially and report the deviation
+};
+
+struct ShardedDecodeReport {
+    int num_shards = 0;
+    int num_segments = 0;
+    int num_sequential_segments = -1;  // -1 when compare_sequential is off
+    int num_unmatched_segments = 0;    // segments without an overlapping counterpart
+    int max_boundary_deviation_ms = 0; // max |start/end difference| of matched segments
+    float mean_boundary_deviation_ms = 0.0f;
+};
+
+// One input of AutoVadModel::process_batch: samples in memory, or a WAV file
+struct VadBatchInput {
+    const float *data = nullptr;    // mono samples, read only
+    const int16_t *pcm16 = nullptr; // mono 16-bit PCM, used when data is null
+    int n = 0;                      // number of samples of data / pcm16
+    std::string path;               // WAV file at the input rate, when both are null
+};
+
+struct VadBatchResult {
+    std::vector<VadSegment> segments;
+    bool ok = false; // false if the input could not be read or the instance not created
+};
+
+struct SessionConfig {
+    int num_threads = 1;                // intra/inter op threads of the session
+    int device_id = -1;                 // -1 for CPU, >=0 for GPU
+    bool enable_cpu_mem_arena = false;  // reuse ORT buffers across Run calls instead of malloc
+
+    // Process-wide thread pools shared by every session that opts in. The pools are created
+    // with the global Ort::Env, i.e. by the first model loaded in the process; the global_*
+    // sizes and allow_spinning of later configs are ignored. num_threads is unused then.
+    bool use_global_thread_pools = false;
+    int global_intra_op_threads = 0;    // 0 for ORT's default (one per physical core)
+    int global_inter_op_threads = 0;    // 0 for ORT's default
+    bool allow_spinning = true;         // idle pool threads spin before sleeping
+
+    // Startup
+    bool enable_session_cache = true;   // reuse a loaded session for the same path and options
+    // Directory for graph-optimized models in ORT format, reused by later processes.
+    // Empty disables the cache. CPU only; entries are tied to the ORT build and the machine.
+    std::string optimized_model_cache_dir;
+    // Dummy inferences in init() before the first real frame. Every instance pays them (per
+    // channel, pool or batch stream, shard), so opt in where first-frame latency matters.
+    int warmup_runs = 0;
+    // Map model files instead of reading them. ORT-format models (e.g. from the optimized
+    // model cache) then run from page-cache pages shared between processes.
+    bool use_mmap = false;
+
+    // Run Silero V5 models with the built-in engine (vad/silero-v5-native.h) instead of
+    // Session::Run; the session is still loaded for model detection. Falls back to ONNX Runtime
+    // with a warning if the weights cannot be read. Ignored for other models.
+    bool native_silero_v5 = false;
 };
 
 } // namespace VadFilterOnnx
@@ -1,5 +1,10 @@
 #include "vad-filter-onnx-cxx-api.h"
+#include "utils/embedded-models.h"
+#include "vad/vad-batch-engine.h"
+#include "vad/vad-file-batch.h"
 #include "vad/vad-model.h"
+#include "vad/vad-sharded-decode.h"
+#include "vad/vad-stream-pool.h"
 #include <onnxruntime_cxx_api.h>
 
 namespace VadFilterOnnx {
@@ -14,12 +19,42 @@ public:
     explicit Impl(std::unique_ptr<VadModel> model) : internal_model_(std::move(model)) {}
 };
 
+class AutoVadBatchEngine::Impl {
+public:
+    std::unique_ptr<VadBatchEngine> engine_;
+};
+
+class AutoVadStreamPool::Impl {
+public:
+    std::unique_ptr<VadStreamPool> pool_;
+};
+
 AutoVadModel::AutoVadModel() : impl_(std::make_unique<Impl>()) {}
 
 AutoVadModel::~AutoVadModel() = default;
 
 std::unique_ptr<AutoVadModel> AutoVadModel::create(const std::string &path, int num_threads, int device_id) {
-    auto model = VadModel::create(path, num_threads, device_id);
+    SessionConfig session_config;
+    session_config.num_threads = num_threads;
+    session_config.device_id = device_id;
+    return create(path, session_config);
+}
+
+std::unique_ptr<AutoVadModel> AutoVadModel::create(const std::string &path, const SessionConfig &session_config) {
+    return wrap(VadModel::create(path, session_config));
+}
+
+std::unique_ptr<AutoVadModel> AutoVadModel::create_from_buffer(const void *data, size_t size,
+                                                               const SessionConfig &session_config) {
+    return wrap(VadModel::create_from_buffer(data, size, session_config));
+}
+
+std::unique_ptr<AutoVadModel> AutoVadModel::create_embedded(const std::string &name,
+                                                            const SessionConfig &session_config) {
+    return wrap(VadModel::create_embedded(name, session_config));
+}
+
+std::unique_ptr<AutoVadModel> AutoVadModel::wrap(std::unique_ptr<VadModel> model) {
     if (!model) {
         return nullptr;
     }
@@ -55,6 +90,79 @@ std::vector<VadSegment> AutoVadModel::decode(float *data, int n, bool input_fini
     return impl_->internal_model_->decode(data, n, input_finished);
 }
 
+int AutoVadModel::decode(float *data, int n, bool input_finished, VadSegment *segments, int max_segments) {
+    if (!impl_->internal_model_) {
+        return 0;
+    }
+    return impl_->internal_model_->decode(data, n, input_finished, segments, max_segments);
+}
+
+std::vector<VadSegment> AutoVadModel::decode(const int16_t *data, int n, bool input_finished) {
+    if (!impl_->internal_model_) {
+        return {};
+    }
+    return impl_->internal_model_->decode(data, n, input_finished);
+}
+
+int AutoVadModel::decode(const int16_t *data, int n, bool input_finished, VadSegment *segments,
+                         int max_segments) {
+    if (!impl_->internal_model_) {
+        return 0;
+    }
+    return impl_->internal_model_->decode(data, n, input_finished, segments, max_segments);
+}
+
+std::vector<VadSegment> AutoVadModel::decode_interleaved(const float *data, int num_frames,
+                                                         int num_channels, ChannelMode mode,
+                                                         bool input_finished) {
+    if (!impl_->internal_model_) {
+        return {};
+    }
+    return impl_->internal_model_->decode_interleaved(data, num_frames, num_channels, mode,
+                                                      input_finished);
+}
+
+std::vector<VadSegment> AutoVadModel::decode_interleaved(const int16_t *data, int num_frames,
+                                                         int num_channels, ChannelMode mode,
+                                                         bool input_finished) {
+    if (!impl_->internal_model_) {
+        return {};
+    }
+    return impl_->internal_model_->decode_interleaved(data, num_frames, num_channels, mode,
+                                                      input_finished);
+}
+
+std::vector<VadSegment> AutoVadModel::decode(float *data, int n, bool input_finished, float *probs,
+                                             int *frame_starts, int max_frames, int *num_frames) {
+    *num_frames = 0;
+    if (!impl_->internal_model_) {
+        return {};
+    }
+    return impl_->internal_model_->decode(data, n, input_finished, probs, frame_starts, max_frames,
+                                          num_frames);
+}
+
+std::vector<VadSegment> AutoVadModel::decode_speech(float *data, int n, bool input_finished,
+                                                    std::vector<SpeechChunk> *chunks) {
+    chunks->clear();
+    if (!impl_->internal_model_) {
+        return {};
+    }
+    return impl_->internal_model_->decode_speech(data, n, input_finished, chunks);
+}
+
+int AutoVadModel::max_frames(int n) const {
+    return impl_->internal_model_ ? impl_->internal_model_->max_frames(n) : 0;
+}
+
+VadStats AutoVadModel::stats() const {
+    return impl_->internal_model_ ? impl_->internal_model_->stats() : VadStats();
+}
+
+VadStats AutoVadModel::handle_stats() const {
+    return impl_->internal_model_ ? impl_->internal_model_->handle_stats() : VadStats();
+}
+
 void AutoVadModel::reset() {
     if (impl_->internal_model_) {
         impl_->internal_model_->reset();
@@ -68,9 +176,105 @@ VadSegment AutoVadModel::flush() {
     return VadSegment();
 }
 
+std::vector<VadSegment> AutoVadModel::flush_channels() {
+    if (impl_->internal_model_) {
+        return impl_->internal_model_->flush_channels();
+    }
+    return {};
+}
+
+void AutoVadModel::set_listener(VadListener *listener) {
+    if (impl_->internal_model_) {
+        impl_->internal_model_->set_listener(listener);
+    }
+}
+
+std::vector<VadSegment> AutoVadModel::decode_sharded(const VadConfig &config, float *data, int n,
+                                                     const ShardedDecodeOptions &options,
+                                                     ShardedDecodeReport *report) {
+    if (!impl_->internal_model_) {
+        return {};
+    }
+    return VadFilterOnnx::decode_sharded(impl_->internal_model_.get(), config, data, n, options, report);
+}
+
+std::vector<VadBatchResult> AutoVadModel::process_batch(const VadConfig &config,
+                                                        const std::vector<VadBatchInput> &inputs,
+                                                        int num_workers) {
+    if (!impl_->internal_model_) {
+        return std::vector<VadBatchResult>(inputs.size());
+    }
+    return VadFilterOnnx::process_batch(impl_->internal_model_.get(), config, inputs, num_workers);
+}
+
+std::unique_ptr<AutoVadBatchEngine> AutoVadModel::create_batch_engine(int max_batch_size) {
+    if (!impl_->internal_model_) {
+        return nullptr;
+    }
+    auto engine = VadBatchEngine::create(impl_->internal_model_.get(), max_batch_size);
+    if (!engine) {
+        return nullptr;
+    }
+    std::unique_ptr<AutoVadBatchEngine> api_engine(new AutoVadBatchEngine());
+    api_engine->impl_->engine_ = std::move(engine);
+    return api_engine;
+}
+
+AutoVadBatchEngine::AutoVadBatchEngine() : impl_(std::make_unique<Impl>()) {}
+
+AutoVadBatchEngine::~AutoVadBatchEngine() = default;
+
+int AutoVadBatchEngine::add_stream(const VadConfig &config) {
+    return impl_->engine_->add_stream(config);
+}
+
+void AutoVadBatchEngine::remove_stream(int stream_id) { impl_->engine_->remove_stream(stream_id); }
+
+bool AutoVadBatchEngine::accept(int stream_id, const float *data, int n, bool input_finished) {
+    return impl_->engine_->accept(stream_id, data, n, input_finished);
+}
+
+int AutoVadBatchEngine::run() { return impl_->engine_->run(); }
+
+std::vector<VadSegment> AutoVadBatchEngine::fetch(int stream_id) {
+    return impl_->engine_->fetch(stream_id);
+}
+
+VadStats AutoVadBatchEngine::stats(int stream_id) const { return impl_->engine_->stats(stream_id); }
+
+std::unique_ptr<AutoVadStreamPool> AutoVadModel::create_stream_pool(int num_workers) {
+    if (!impl_->internal_model_) {
+        return nullptr;
+    }
+    std::unique_ptr<AutoVadStreamPool> api_pool(new AutoVadStreamPool());
+    api_pool->impl_->pool_ =
+        std::make_unique<VadStreamPool>(impl_->internal_model_.get(), num_workers);
+    return api_pool;
+}
+
+AutoVadStreamPool::AutoVadStreamPool() : impl_(std::make_unique<Impl>()) {}
+
+AutoVadStreamPool::~AutoVadStreamPool() = default;
+
+int AutoVadStreamPool::add_stream(const VadConfig &config) {
+    return impl_->pool_->add_stream(config);
+}
+
+void AutoVadStreamPool::remove_stream(int stream_id) { impl_->pool_->remove_stream(stream_id); }
+
+bool AutoVadStreamPool::feed(int stream_id, const float *data, int n, bool input_finished) {
+    return impl_->pool_->feed(stream_id, data, n, input_finished);
+}
+
+bool AutoVadStreamPool::poll(VadStreamResult *result, int timeout_ms) {
+    return impl_->pool_->poll(result, timeout_ms);
+}
+
 std::vector<std::string> get_ort_available_providers() {
     return Ort::GetAvailableProviders();
 }
 
+std::vector<std::string> get_embedded_models() { return ListEmbeddedModels(); }
+
 } // namespace VadFilterOnnx
 
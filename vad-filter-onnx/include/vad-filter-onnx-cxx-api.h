@@ -1,12 +1,19 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
 #include "vad-config.h"
+#include "vad-listener.h"
 
 namespace VadFilterOnnx {
 
+class AutoVadBatchEngine;
+class AutoVadStreamPool;
+class VadModel;
+
 /**
  * @brief A high-level C++ API for the VAD model using the Pimpl idiom.
  * The signatures match VadFilterOnnx::VadModel for consistency.
@@ -22,6 +29,33 @@ public:
      */
     static std::unique_ptr<AutoVadModel> create(const std::string &path, int num_threads = 1, int device_id = -1);
 
+    /**
+     * @brief Create a model handle with full session options.
+     * @param path Path to the ONNX model.
+     * @param session_config ONNX Runtime session options.
+     * @return Unique pointer to AutoVadModel handle.
+     */
+    static std::unique_ptr<AutoVadModel> create(const std::string &path, const SessionConfig &session_config);
+
+    /**
+     * @brief Create a model handle from an ONNX or ORT-format model in memory.
+     * @param data Model bytes; only read during the call.
+     * @param size Size of the model in bytes.
+     * @param session_config ONNX Runtime session options.
+     * @return Unique pointer to AutoVadModel handle, or nullptr if the bytes are not a model.
+     */
+    static std::unique_ptr<AutoVadModel> create_from_buffer(const void *data, size_t size,
+                                                            const SessionConfig &session_config = SessionConfig());
+
+    /**
+     * @brief Create a model handle from a model compiled into the library (VAD_EMBED_MODELS).
+     * @param name File name of the model, e.g. "silero_vad.v5.onnx".
+     * @param session_config ONNX Runtime session options.
+     * @return Unique pointer to AutoVadModel handle, or nullptr if the model is not embedded.
+     */
+    static std::unique_ptr<AutoVadModel> create_embedded(const std::string &name,
+                                                         const SessionConfig &session_config = SessionConfig());
+
     /**
      * @brief Initialize a model instance for inference.
      * @param config VAD configuration.
@@ -38,13 +72,247 @@ public:
      */
     std::vector<VadSegment> decode(float *data, int n, bool input_finished);
 
+    /**
+     * @brief Process audio data, writing segments into a caller-supplied buffer.
+     * Segments that do not fit stay queued for the next call. No heap allocation once warmed up.
+     * @param data Pointer to PCM data.
+     * @param n Number of samples.
+     * @param input_finished End of stream flag.
+     * @param segments Output buffer.
+     * @param max_segments Capacity of the output buffer.
+     * @return Number of segments written.
+     */
+    int decode(float *data, int n, bool input_finished, VadSegment *segments, int max_segments);
+
+    /**
+     * @brief Process 16-bit PCM. Converted to float in small blocks with SIMD kernels, so no
+     * full-size float copy is made. Results are identical to decoding data / 32768.
+     * @param data Pointer to PCM data.
+     * @param n Number of samples.
+     * @param input_finished End of stream flag.
+     * @return Detected segments.
+     */
+    std::vector<VadSegment> decode(const int16_t *data, int n, bool input_finished);
+
+    /**
+     * @brief 16-bit PCM variant of the buffer-based decode.
+     */
+    int decode(const int16_t *data, int n, bool input_finished, VadSegment *segments, int max_segments);
+
+    /**
+     * @brief Process interleaved multichannel audio.
+     * Downmix averages the channels into one VAD. PerChannel runs an independent VAD per channel
+     * (sharing this instance's handle) and tags segments with VadSegment::channel.
+     * @param data Interleaved PCM, num_frames * num_channels samples.
+     * @param num_frames Number of frames.
+     * @param num_channels Number of channels.
+     * @param mode Channel mode; keep it fixed for a stream.
+     * @param input_finished End of stream flag.
+     * @return Detected segments, grouped by channel.
+     */
+    std::vector<VadSegment> decode_interleaved(const float *data, int num_frames, int num_channels,
+                                               ChannelMode mode, bool input_finished);
+    std::vector<VadSegment> decode_interleaved(const int16_t *data, int num_frames, int num_channels,
+                                               ChannelMode mode, bool input_finished);
+
+    /**
+     * @brief Process audio data and also output the speech probability of every frame.
+     * The probabilities are the ones the detector consumes, so no extra inference is run.
+     * @param data Pointer to PCM data.
+     * @param n Number of samples.
+     * @param input_finished End of stream flag.
+     * @param probs Output buffer for per-frame speech probabilities.
+     * @param frame_starts Output buffer for the start sample of each frame, may be nullptr.
+     * @param max_frames Capacity of the output buffers; max_frames(n) is always enough.
+     * @param num_frames Number of frames written.
+     * @return Detected segments.
+     */
+    std::vector<VadSegment> decode(float *data, int n, bool input_finished, float *probs,
+                                   int *frame_starts, int max_frames, int *num_frames);
+
+    /**
+     * @brief Filter mode: process mono audio and also output the speech audio of the segments.
+     * Chunks are views into `data` or an internal pre-roll buffer of bounded size, valid until
+     * the next call; concatenated per segment they are exactly input[start, end), with
+     * VadConfig::filter_fade_ms fades at both ends. An open segment is emitted up to the
+     * silence window before the input end, where its end may still fall.
+     * @param chunks Output, replaced on every call.
+     * @return Detected segments, as decode().
+     */
+    std::vector<VadSegment> decode_speech(float *data, int n, bool input_finished,
+                                          std::vector<SpeechChunk> *chunks);
+
+    /**
+     * @brief Upper bound of the frames scored by the next decode() call with n samples; 0 on a
+     * handle that has not been through init().
+     */
+    int max_frames(int n) const;
+
+    /**
+     * @brief Hot-path counters of this instance (all zero unless VadConfig::enable_stats).
+     * Lock free; may be called from any thread while another thread decodes.
+     */
+    VadStats stats() const;
+
+    /**
+     * @brief Counters summed over all instances of the handle with stats enabled.
+     * Can be called on the handle or on any of its instances.
+     */
+    VadStats handle_stats() const;
+
     void reset();
+
+    /**
+     * @brief Close the open segment. After PerChannel decoding this is channel 0 only; use
+     * flush_channels() for the others.
+     */
     VadSegment flush();
 
+    /**
+     * @brief Close the open segments of all channels after decode_interleaved().
+     * @return The closed segments, grouped by channel.
+     */
+    std::vector<VadSegment> flush_channels();
+
+    /**
+     * @brief Receive speech start/end/split notifications synchronously from inside decode(),
+     * on the frame that decides them. Use VadEventQueue to hand them to another thread.
+     * @param listener Not owned; nullptr to stop. Must outlive the decoding.
+     */
+    void set_listener(VadListener *listener);
+
+    /**
+     * @brief Offline decode of a long buffer, split into shards decoded on parallel threads.
+     * Must be called on a handle. Each shard warms up its recurrent state on the preceding
+     * `overlap_ms` of audio; the per-shard segments are stitched and renumbered.
+     * @param config VAD configuration.
+     * @param data Pointer to PCM data.
+     * @param n Number of samples.
+     * @param options Sharding options.
+     * @param report Optional statistics, incl. the deviation from a sequential run.
+     * @return Detected segments.
+     */
+    std::vector<VadSegment> decode_sharded(const VadConfig &config, float *data, int n,
+                                           const ShardedDecodeOptions &options = ShardedDecodeOptions(),
+                                           ShardedDecodeReport *report = nullptr);
+
+    /**
+     * @brief Offline decode of many independent inputs on a pool of native threads.
+     * Must be called on a handle. Each worker decodes whole inputs on one instance, reset
+     * between inputs; results are in input order and hold the closed segments.
+     * @param config VAD configuration of every input.
+     * @param inputs Buffers or WAV paths; buffers are only read during the call.
+     * @param num_workers Number of threads (<= 0 for one per core).
+     * @return One result per input.
+     */
+    std::vector<VadBatchResult> process_batch(const VadConfig &config,
+                                              const std::vector<VadBatchInput> &inputs,
+                                              int num_workers = 0);
+
+    /**
+     * @brief Create a batching engine that runs frames of many streams in one Session::Run.
+     * Must be called on a handle, and the handle must outlive the engine.
+     * @param max_batch_size Maximum number of frames per Run.
+     * @return Unique pointer to the engine, or nullptr if the model cannot be batched.
+     */
+    std::unique_ptr<AutoVadBatchEngine> create_batch_engine(int max_batch_size = 64);
+
+    /**
+     * @brief Create a worker pool that decodes many streams concurrently.
+     * Must be called on a handle, and the handle must outlive the pool. Create the handle
+     * with SessionConfig::num_threads = 1 so the workers do not oversubscribe the cores.
+     * @param num_workers Number of worker threads (<= 0 for one per core).
+     * @return Unique pointer to the pool.
+     */
+    std::unique_ptr<AutoVadStreamPool> create_stream_pool(int num_workers = 0);
+
     ~AutoVadModel();
 
 private:
     AutoVadModel(); // Private constructor used by factory
+    static std::unique_ptr<AutoVadModel> wrap(std::unique_ptr<VadModel> model);
+    class Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+/**
+ * @brief Batched inference over many streams sharing one handle.
+ * Streams may use different VadConfigs. Not thread-safe.
+ */
+class AutoVadBatchEngine {
+public:
+    /**
+     * @brief Register a new stream.
+     * @param config VAD configuration of this stream.
+     * @return Stream id, or -1 on failure.
+     */
+    int add_stream(const VadConfig &config);
+    void remove_stream(int stream_id);
+
+    /**
+     * @brief Queue audio for a stream. Data is copied; inference happens in run().
+     * @return false if the stream id is unknown.
+     */
+    bool accept(int stream_id, const float *data, int n, bool input_finished);
+
+    /**
+     * @brief Run batched inference until no stream has a full frame.
+     * @return Number of frames processed.
+     */
+    int run();
+
+    /**
+     * @brief Take the segments detected for a stream since the last fetch.
+     */
+    std::vector<VadSegment> fetch(int stream_id);
+
+    /**
+     * @brief Counters of a stream added with VadConfig::enable_stats, updated by run().
+     */
+    VadStats stats(int stream_id) const;
+
+    ~AutoVadBatchEngine();
+
+private:
+    friend class AutoVadModel;
+    AutoVadBatchEngine();
+    class Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+/**
+ * @brief Multi-stream decoding on a pool of worker threads with work stealing.
+ * feed() and poll() may be called from any thread.
+ */
+class AutoVadStreamPool {
+public:
+    /**
+     * @brief Register a new stream.
+     * @param config VAD configuration of this stream.
+     * @return Stream id, or -1 on failure.
+     */
+    int add_stream(const VadConfig &config);
+    void remove_stream(int stream_id);
+
+    /**
+     * @brief Queue audio for a stream. Data is copied; a worker decodes it once a frame is ready.
+     * @return false if the stream id is unknown.
+     */
+    bool feed(int stream_id, const float *data, int n, bool input_finished);
+
+    /**
+     * @brief Wait for the next batch of segments of any stream.
+     * @param result Output; `finished` is set once the stream's final input has been decoded.
+     * @param timeout_ms Maximum time to wait.
+     * @return false on timeout.
+     */
+    bool poll(VadStreamResult *result, int timeout_ms);
+
+    ~AutoVadStreamPool();
+
+private:
+    friend class AutoVadModel;
+    AutoVadStreamPool();
     class Impl;
     std::unique_ptr<Impl> impl_;
 };
@@ -55,4 +323,9 @@ private:
  */
 std::vector<std::string> get_ort_available_providers();
 
+/**
+ * @brief Get the names of the models compiled into the library.
+ */
+std::vector<std::string> get_embedded_models();
+
 } // namespace VadFilterOnnx
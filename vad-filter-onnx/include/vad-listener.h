@@ -0,0 +1,103 @@
+#pragma once
+
+#include "vad-config.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace VadFilterOnnx {
+
+/**
+ * @brief Speech boundary notifications, called synchronously on the decoding thread from
+ * inside decode() on the frame that decides them, before decode() returns.
+ *
+ * Positions are in input samples. `position` is the end of the frame that triggered the
+ * decision, so `position - segment.start` is the detection delay. Calls are made with the
+ * segment on the stack and never allocate; keep the handlers short, they run on the hot path.
+ */
+class VadListener {
+  public:
+    virtual ~VadListener() = default;
+    // segment.end is -1
+    virtual void on_speech_start(const VadSegment & /*segment*/, int /*position*/) {}
+    virtual void on_speech_end(const VadSegment & /*segment*/, int /*position*/) {}
+    // max_speech_ms reached: `ended` is closed and `started` opened at the same frame. Replaces
+    // the on_speech_end / on_speech_start pair.
+    virtual void on_forced_split(const VadSegment & /*ended*/, const VadSegment & /*started*/,
+                                 int /*position*/) {}
+};
+
+enum class VadEventType {
+    SpeechStart,
+    SpeechEnd,
+    ForcedSplit,
+};
+
+struct VadEvent {
+    VadEventType type = VadEventType::SpeechStart;
+    VadSegment segment; // started, ended, or the closed part of a split
+    VadSegment started; // ForcedSplit only: the segment opened by the split
+    int position = 0;
+};
+
+/**
+ * @brief Listener that hands the events to another thread through a fixed-size ring.
+ *
+ * Single producer (the decoding thread) and single consumer. Pushing is a copy and a release
+ * store, so the decode thread never blocks on the consumer. Events that do not fit are dropped
+ * and counted.
+ */
+class VadEventQueue : public VadListener {
+  public:
+    explicit VadEventQueue(size_t capacity = 256) : events_(capacity + 1) {}
+
+    void on_speech_start(const VadSegment &segment, int position) override {
+        push(VadEventType::SpeechStart, segment, VadSegment(), position);
+    }
+    void on_speech_end(const VadSegment &segment, int position) override {
+        push(VadEventType::SpeechEnd, segment, VadSegment(), position);
+    }
+    void on_forced_split(const VadSegment &ended, const VadSegment &started,
+                         int position) override {
+        push(VadEventType::ForcedSplit, ended, started, position);
+    }
+
+    // Consumer side: take the oldest event, false if there is none
+    bool pop(VadEvent *event) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == head_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        *event = events_[tail];
+        tail_.store(next(tail), std::memory_order_release);
+        return true;
+    }
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+  private:
+    size_t next(size_t i) const { return i + 1 == events_.size() ? 0 : i + 1; }
+
+    void push(VadEventType type, const VadSegment &segment, const VadSegment &started,
+              int position) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        size_t after = next(head);
+        if (after == tail_.load(std::memory_order_acquire)) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        VadEvent &event = events_[head];
+        event.type = type;
+        event.segment = segment;
+        event.started = started;
+        event.position = position;
+        head_.store(after, std::memory_order_release);
+    }
+
+    std::vector<VadEvent> events_; // one slot stays empty to tell full from empty
+    std::atomic<size_t> head_{ 0 };
+    std::atomic<size_t> tail_{ 0 };
+    std::atomic<uint64_t> dropped_{ 0 };
+};
+
+} // namespace VadFilterOnnx
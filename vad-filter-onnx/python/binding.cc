@@ -5,12 +5,56 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 
+#include <algorithm>
+#include <stdexcept>
+
 #include "vad-config.h"
 #include "vad-filter-onnx-cxx-api.h"
 
 namespace py = pybind11;
 using namespace VadFilterOnnx;
 
+// Segments as a structured array with the fields of VadSegment
+static py::array_t<VadSegment> to_array(const std::vector<VadSegment> &segments) {
+    py::array_t<VadSegment> out(static_cast<py::ssize_t>(segments.size()));
+    std::copy(segments.begin(), segments.end(), out.mutable_data());
+    return out;
+}
+
+// int16 input must match exactly; float input of any other dtype or layout is converted
+using Pcm16Array = py::array_t<int16_t, py::array::c_style>;
+using FloatArray = py::array_t<float, py::array::c_style | py::array::forcecast>;
+
+template <typename T, int Flags> static const T *samples_1d(const py::array_t<T, Flags> &data) {
+    if (data.ndim() != 1) {
+        throw std::runtime_error("Input data must be a 1D array");
+    }
+    return data.data();
+}
+
+template <typename T, int Flags> static const T *samples_2d(const py::array_t<T, Flags> &data) {
+    if (data.ndim() != 2) {
+        throw std::runtime_error("Input data must be a 2D array (frames, channels)");
+    }
+    return data.data();
+}
+
+// Python subclasses of VadListener; the overrides take the GIL that decode() released
+class PyVadListener : public VadListener {
+  public:
+    using VadListener::VadListener;
+    void on_speech_start(const VadSegment &segment, int position) override {
+        PYBIND11_OVERRIDE(void, VadListener, on_speech_start, segment, position);
+    }
+    void on_speech_end(const VadSegment &segment, int position) override {
+        PYBIND11_OVERRIDE(void, VadListener, on_speech_end, segment, position);
+    }
+    void on_forced_split(const VadSegment &ended, const VadSegment &started,
+                         int position) override {
+        PYBIND11_OVERRIDE(void, VadListener, on_forced_split, ended, started, position);
+    }
+};
+
 PYBIND11_MODULE(vad_filter_onnx, m) {
     m.doc() = "Python bindings for vad-filter-onnx";
 
@@ -23,24 +67,39 @@ PYBIND11_MODULE(vad_filter_onnx, m) {
         .value("None", VadType::None)
         .export_values();
 
+    py::enum_<ChannelMode>(m, "ChannelMode", "Multichannel handling of decode_interleaved")
+        .value("Downmix", ChannelMode::Downmix)
+        .value("PerChannel", ChannelMode::PerChannel)
+        .export_values();
+
     py::class_<VadSegment>(m, "VadSegment", "Represents a detected speech segment")
-        .def(py::init<int, int, int, int, int>(), py::arg("idx") = -1, py::arg("start") = -1,
-             py::arg("end") = -1, py::arg("start_ms") = -1, py::arg("end_ms") = -1)
+        .def(py::init<int, int, int, int, int, int>(), py::arg("idx") = -1, py::arg("start") = -1,
+             py::arg("end") = -1, py::arg("start_ms") = -1, py::arg("end_ms") = -1,
+             py::arg("channel") = 0)
         .def_readwrite("idx", &VadSegment::idx, "Segment index")
         .def_readwrite("start", &VadSegment::start, "Start sample index")
         .def_readwrite("end", &VadSegment::end, "End sample index")
         .def_readwrite("start_ms", &VadSegment::start_ms, "Start time in milliseconds")
         .def_readwrite("end_ms", &VadSegment::end_ms, "End time in milliseconds")
+        .def_readwrite("channel", &VadSegment::channel, "Input channel (PerChannel mode)")
         .def("__repr__", [](const VadSegment &s) {
             return "<VadSegment idx=" + std::to_string(s.idx) +
+                   " channel=" + std::to_string(s.channel) +
                    " start_ms=" + std::to_string(s.start_ms) +
                    " end_ms=" + std::to_string(s.end_ms) + ">";
         });
+    // Record type of the segment arrays returned by decode*
+    PYBIND11_NUMPY_DTYPE(VadSegment, idx, start, end, start_ms, end_ms, channel);
+    m.attr("segment_dtype") = py::dtype::of<VadSegment>();
 
     py::class_<VadConfig>(m, "VadConfig", "Configuration for VAD filtering")
         .def(py::init<>())
         .def_readwrite("threshold", &VadConfig::threshold, "Detection threshold (default: 0.4)")
-        .def_readwrite("sample_rate", &VadConfig::sample_rate, "Audio sample rate (default: 16000)")
+        .def_readwrite("sample_rate", &VadConfig::sample_rate,
+                       "Model sample rate, 8000 or 16000 (default: 16000)")
+        .def_readwrite("input_sample_rate", &VadConfig::input_sample_rate,
+                       "Rate of the audio passed to decode, resampled to sample_rate; "
+                       "0 for sample_rate (default: 0)")
         .def_readwrite("speech_window_size_ms", &VadConfig::speech_window_size_ms,
                        "Window size for speech detection in ms (default: 300)")
         .def_readwrite("speech_window_threshold_ms", &VadConfig::speech_window_threshold_ms,
@@ -54,30 +113,309 @@ PYBIND11_MODULE(vad_filter_onnx, m) {
         .def_readwrite("left_padding_ms", &VadConfig::left_padding_ms,
                        "Padding added to start of speech in ms (default: 100)")
         .def_readwrite("right_padding_ms", &VadConfig::right_padding_ms,
-                       "Padding added to end of speech in ms (default: 100)");
+                       "Padding added to end of speech in ms (default: 100)")
+        .def_readwrite("enable_stats", &VadConfig::enable_stats,
+                       "Keep hot-path counters, see AutoVadModel.stats() (default: False)")
+        .def_readwrite("enable_energy_gate", &VadConfig::enable_energy_gate,
+                       "Skip inference on frames below energy_gate_dbfs; Silero/TEN only "
+                       "(default: False)")
+        .def_readwrite("energy_gate_dbfs", &VadConfig::energy_gate_dbfs,
+                       "Energy gate threshold in dBFS (default: -70)")
+        .def_readwrite("enable_adaptive_stride", &VadConfig::enable_adaptive_stride,
+                       "Run the model on fewer frames while confidently idle; Silero/TEN only "
+                       "(default: False)")
+        .def_readwrite("adaptive_stride_prob", &VadConfig::adaptive_stride_prob,
+                       "Probability below which the stream counts as idle (default: 0.1)")
+        .def_readwrite("adaptive_stride_max_latency_ms",
+                       &VadConfig::adaptive_stride_max_latency_ms,
+                       "Bound on the added speech onset delay in ms (default: 96)")
+        .def_readwrite("filter_fade_ms", &VadConfig::filter_fade_ms,
+                       "decode_speech fade-in/out at segment ends in ms (default: 0)");
+
+    py::class_<VadStats>(m, "VadStats", "Hot-path counters of an instance or a handle")
+        .def_readonly("decode_calls", &VadStats::decode_calls)
+        .def_readonly("samples", &VadStats::samples, "Input samples consumed")
+        .def_readonly("frames", &VadStats::frames, "Frames scored")
+        .def_readonly("gated_frames", &VadStats::gated_frames,
+                      "Frames skipped by the energy gate, included in frames")
+        .def_readonly("strided_frames", &VadStats::strided_frames,
+                      "Frames skipped by the adaptive stride, included in frames")
+        .def_readonly("inference_runs", &VadStats::inference_runs, "Session::Run calls")
+        .def_readonly("inference_ns", &VadStats::inference_ns, "Time in Session::Run")
+        .def_readonly("state_ns", &VadStats::state_ns, "Time in the speech/silence state machine")
+        .def_readonly("framing_ns", &VadStats::framing_ns,
+                      "Rest of decode(): framing, conversion, resampling")
+        .def_readonly("segments", &VadStats::segments, "Segments closed")
+        .def_readonly("max_speech_splits", &VadStats::max_speech_splits,
+                      "Segments split by max_speech_ms")
+        .def_readonly("buffered_bytes", &VadStats::buffered_bytes,
+                      "Audio carried to the next decode() call")
+        .def_property_readonly(
+            "inference_latency_us",
+            [](const VadStats &s) {
+                return std::vector<uint64_t>(s.inference_latency_us,
+                                             s.inference_latency_us + VadStats::kNumLatencyBuckets);
+            },
+            "Session::Run latency histogram: bucket 0 is < 1us, bucket i is [2^(i-1), 2^i) us")
+        .def("__repr__", [](const VadStats &s) {
+            return "<VadStats frames=" + std::to_string(s.frames) +
+                   " inference_ns=" + std::to_string(s.inference_ns) +
+                   " framing_ns=" + std::to_string(s.framing_ns) +
+                   " segments=" + std::to_string(s.segments) + ">";
+        });
+
+    py::class_<SessionConfig>(m, "SessionConfig", "ONNX Runtime session options")
+        .def(py::init<>())
+        .def_readwrite("num_threads", &SessionConfig::num_threads,
+                       "Intra/inter op threads of the session (default: 1)")
+        .def_readwrite("device_id", &SessionConfig::device_id,
+                       "Device ID, -1 for CPU (default: -1)")
+        .def_readwrite("enable_cpu_mem_arena", &SessionConfig::enable_cpu_mem_arena,
+                       "Reuse ORT buffers across runs instead of malloc (default: False)")
+        .def_readwrite("use_global_thread_pools", &SessionConfig::use_global_thread_pools,
+                       "Share process-wide ORT thread pools across sessions; must be set on "
+                       "the first model loaded (default: False)")
+        .def_readwrite("global_intra_op_threads", &SessionConfig::global_intra_op_threads,
+                       "Size of the global intra-op pool, 0 for ORT's default (default: 0)")
+        .def_readwrite("global_inter_op_threads", &SessionConfig::global_inter_op_threads,
+                       "Size of the global inter-op pool, 0 for ORT's default (default: 0)")
+        .def_readwrite("allow_spinning", &SessionConfig::allow_spinning,
+                       "Let idle pool threads spin before sleeping (default: True)")
+        .def_readwrite("enable_session_cache", &SessionConfig::enable_session_cache,
+                       "Reuse a loaded session for the same path and options (default: True)")
+        .def_readwrite("optimized_model_cache_dir", &SessionConfig::optimized_model_cache_dir,
+                       "Directory for optimized models in ORT format, empty to disable "
+                       "(default: '')")
+        .def_readwrite("warmup_runs", &SessionConfig::warmup_runs,
+                       "Dummy inferences in init() before the first real frame (default: 0)")
+        .def_readwrite("use_mmap", &SessionConfig::use_mmap,
+                       "Map model files instead of reading them (default: False)")
+        .def_readwrite("native_silero_v5", &SessionConfig::native_silero_v5,
+                       "Run Silero V5 with the built-in engine instead of ONNX Runtime "
+                       "(default: False)");
+
+    py::class_<VadListener, PyVadListener>(
+        m, "VadListener",
+        "Subclass and pass to AutoVadModel.set_listener to be called from inside decode()")
+        .def(py::init<>())
+        .def("on_speech_start", &VadListener::on_speech_start, py::arg("segment"),
+             py::arg("position"), "Speech started; segment.end is -1")
+        .def("on_speech_end", &VadListener::on_speech_end, py::arg("segment"),
+             py::arg("position"), "Speech ended")
+        .def("on_forced_split", &VadListener::on_forced_split, py::arg("ended"),
+             py::arg("started"), py::arg("position"), "Segment split by max_speech_ms");
 
     py::class_<AutoVadModel>(m, "AutoVadModel", "High-level VAD model API")
-        .def_static("create", &AutoVadModel::create, py::arg("path"), py::arg("num_threads") = 1,
-                    py::arg("device_id") = -1,
+        .def_static("create",
+                    py::overload_cast<const std::string &, int, int>(&AutoVadModel::create),
+                    py::arg("path"), py::arg("num_threads") = 1, py::arg("device_id") = -1,
                     "Create a model handle by loading an ONNX model from the given path.")
+        .def_static(
+            "create",
+            py::overload_cast<const std::string &, const SessionConfig &>(&AutoVadModel::create),
+            py::arg("path"), py::arg("session_config"),
+            "Create a model handle with the given session options.")
+        .def_static(
+            "create_from_buffer",
+            [](py::bytes data, const SessionConfig &session_config) {
+                std::string_view view = data;
+                return AutoVadModel::create_from_buffer(view.data(), view.size(), session_config);
+            },
+            py::arg("data"), py::arg("session_config") = SessionConfig(),
+            "Create a model handle from model bytes in memory, None if they are not a model.")
+        .def_static("create_embedded", &AutoVadModel::create_embedded, py::arg("name"),
+                    py::arg("session_config") = SessionConfig(),
+                    "Create a model handle from a model compiled into the library.")
         .def("init", &AutoVadModel::init, py::arg("config"),
              "Initialize a model instance for inference with the given configuration.")
+        // decode* take float32 and int16 C-contiguous arrays without a copy and run without the
+        // GIL, so threads decoding different instances run in parallel. Other float dtypes
+        // (float64 from numpy or soundfile) and layouts are converted to float32. Segments are
+        // returned as a structured array of segment_dtype.
+        // Registered first: pybind11 tries every overload without conversion before converting,
+        // so int16 input picks this one, float32 the next, and anything else is cast to float32.
+        .def(
+            "decode",
+            [](AutoVadModel &self, Pcm16Array data, bool input_finished) {
+                const int16_t *samples = samples_1d(data);
+                int n = static_cast<int>(data.size());
+                std::vector<VadSegment> segments;
+                {
+                    py::gil_scoped_release release;
+                    segments = self.decode(samples, n, input_finished);
+                }
+                return to_array(segments);
+            },
+            py::arg("data"), py::arg("input_finished"),
+            "Process int16 PCM and return detected segments.")
         .def(
             "decode",
-            [](AutoVadModel &self, py::array_t<float> data, bool input_finished) {
-                py::buffer_info buf = data.request();
-                if (buf.ndim != 1) {
-                    throw std::runtime_error("Input data must be a 1D array");
+            [](AutoVadModel &self, FloatArray data, bool input_finished) {
+                // The decoder only reads the samples
+                float *samples = const_cast<float *>(samples_1d(data));
+                int n = static_cast<int>(data.size());
+                std::vector<VadSegment> segments;
+                {
+                    py::gil_scoped_release release;
+                    segments = self.decode(samples, n, input_finished);
                 }
-                return self.decode(static_cast<float *>(buf.ptr), static_cast<int>(buf.size),
-                                   input_finished);
+                return to_array(segments);
             },
             py::arg("data"), py::arg("input_finished"),
             "Process audio data and return detected segments.")
-        .def("reset", &AutoVadModel::reset, "Reset the model internal state.")
+        .def(
+            "decode_interleaved",
+            [](AutoVadModel &self, Pcm16Array data, ChannelMode mode, bool input_finished) {
+                const int16_t *samples = samples_2d(data);
+                int num_frames = static_cast<int>(data.shape(0));
+                int num_channels = static_cast<int>(data.shape(1));
+                std::vector<VadSegment> segments;
+                {
+                    py::gil_scoped_release release;
+                    segments = self.decode_interleaved(samples, num_frames, num_channels, mode,
+                                                       input_finished);
+                }
+                return to_array(segments);
+            },
+            py::arg("data"), py::arg("mode"), py::arg("input_finished"),
+            "Process interleaved int16 audio shaped (frames, channels).")
+        .def(
+            "decode_interleaved",
+            [](AutoVadModel &self, FloatArray data, ChannelMode mode, bool input_finished) {
+                const float *samples = samples_2d(data);
+                int num_frames = static_cast<int>(data.shape(0));
+                int num_channels = static_cast<int>(data.shape(1));
+                std::vector<VadSegment> segments;
+                {
+                    py::gil_scoped_release release;
+                    segments = self.decode_interleaved(samples, num_frames, num_channels, mode,
+                                                       input_finished);
+                }
+                return to_array(segments);
+            },
+            py::arg("data"), py::arg("mode"), py::arg("input_finished"),
+            "Process interleaved audio shaped (frames, channels).")
+        .def(
+            "decode_speech",
+            [](AutoVadModel &self, FloatArray data, bool input_finished) {
+                float *samples = const_cast<float *>(samples_1d(data));
+                int n = static_cast<int>(data.size());
+                std::vector<VadSegment> segments;
+                std::vector<SpeechChunk> chunks;
+                {
+                    py::gil_scoped_release release;
+                    segments = self.decode_speech(samples, n, input_finished, &chunks);
+                }
+                // The views only live until the next call, so Python gets copies
+                py::list speech;
+                for (const auto &chunk : chunks) {
+                    py::array_t<float> audio(chunk.n);
+                    std::copy(chunk.data, chunk.data + chunk.n, audio.mutable_data());
+                    speech.append(py::make_tuple(chunk.idx, chunk.start, chunk.segment_end, audio));
+                }
+                return py::make_tuple(to_array(segments), speech);
+            },
+            py::arg("data"), py::arg("input_finished"),
+            "Process audio data and return (segments, speech) where speech is a list of "
+            "(segment idx, start sample, segment_end, samples) chunks in order.")
+        .def(
+            "decode_with_probs",
+            [](AutoVadModel &self, FloatArray data, bool input_finished) {
+                float *samples = const_cast<float *>(samples_1d(data));
+                int n = static_cast<int>(data.size());
+                int max_frames = self.max_frames(n);
+                // Written in place by the decoder and returned as views, no copy
+                py::array_t<float> probs(max_frames);
+                py::array_t<int> frame_starts(max_frames);
+                float *probs_data = probs.mutable_data();
+                int *frame_starts_data = frame_starts.mutable_data();
+                int num_frames = 0;
+                std::vector<VadSegment> segments;
+                {
+                    py::gil_scoped_release release;
+                    segments = self.decode(samples, n, input_finished, probs_data,
+                                           frame_starts_data, max_frames, &num_frames);
+                }
+                py::slice valid(0, num_frames, 1);
+                return py::make_tuple(to_array(segments), probs[valid], frame_starts[valid]);
+            },
+            py::arg("data"), py::arg("input_finished"),
+            "Process audio data and return (segments, per-frame speech probabilities, "
+            "frame start samples).")
+        .def(
+            "process_batch",
+            [](AutoVadModel &self, py::sequence inputs, const VadConfig &config,
+               int num_workers) {
+                // Converted arrays must outlive the workers, which read them without the GIL
+                std::vector<py::object> arrays;
+                std::vector<VadBatchInput> batch(inputs.size());
+                for (size_t i = 0; i < batch.size(); ++i) {
+                    py::object item = inputs[i];
+                    if (py::isinstance<py::str>(item) || py::hasattr(item, "__fspath__")) {
+                        batch[i].path = py::str(py::module_::import("os").attr("fspath")(item));
+                        continue;
+                    }
+                    py::array array;
+                    if (py::isinstance<py::array_t<int16_t>>(item)) {
+                        auto pcm16 = Pcm16Array::ensure(item);
+                        batch[i].pcm16 = pcm16.data();
+                        array = pcm16;
+                    } else {
+                        auto samples = FloatArray::ensure(item);
+                        if (!samples) {
+                            throw py::type_error("process_batch inputs must be arrays or paths");
+                        }
+                        batch[i].data = samples.data();
+                        array = samples;
+                    }
+                    if (array.ndim() != 1) {
+                        throw std::runtime_error("Input data must be a 1D array");
+                    }
+                    batch[i].n = static_cast<int>(array.size());
+                    arrays.push_back(std::move(array));
+                }
+                std::vector<VadBatchResult> results;
+                {
+                    py::gil_scoped_release release;
+                    results = self.process_batch(config, batch, num_workers);
+                }
+                py::list out;
+                for (const auto &result : results) {
+                    out.append(result.ok ? py::object(to_array(result.segments)) : py::none());
+                }
+                return out;
+            },
+            py::arg("inputs"), py::arg("config"), py::arg("num_workers") = 0,
+            "Decode many 1D arrays (float32/int16) or WAV paths on native threads "
+            "without the GIL. Must be called on a handle. Returns one segment array per input, "
+            "None for inputs that could not be read.")
+        .def("stats", &AutoVadModel::stats,
+             "Hot-path counters of this instance; needs VadConfig.enable_stats.")
+        .def("handle_stats", &AutoVadModel::handle_stats,
+             "Counters summed over all instances of the handle with stats enabled.")
+        .def("reset", &AutoVadModel::reset, "Reset the model internal state.",
+             py::call_guard<py::gil_scoped_release>())
         .def("flush", &AutoVadModel::flush,
-             "Flush remaining audio and return the final segment if any.");
+             "Flush remaining audio and return the final segment if any (channel 0 after "
+             "per-channel decoding).",
+             py::call_guard<py::gil_scoped_release>())
+        .def(
+            "flush_channels",
+            [](AutoVadModel &self) {
+                std::vector<VadSegment> segments;
+                {
+                    py::gil_scoped_release release;
+                    segments = self.flush_channels();
+                }
+                return to_array(segments);
+            },
+            "Close the open segments of all channels after decode_interleaved().")
+        // The model keeps the listener alive
+        .def("set_listener", &AutoVadModel::set_listener, py::arg("listener").none(true),
+             py::keep_alive<1, 2>(), "Set or clear (None) the boundary listener.");
 
     m.def("get_ort_available_providers", &get_ort_available_providers,
           "Get list of available ONNX Runtime execution providers.");
+    m.def("get_embedded_models", &get_embedded_models,
+          "Get the names of the models compiled into the library.");
 }
@@ -0,0 +1,68 @@
+#include "utils/cpu-features.h"
+
+#if defined(VAD_ARCH_X86)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace VadFilterOnnx {
+
+#if defined(VAD_ARCH_X86)
+static void Cpuid(int leaf, int subleaf, unsigned regs[4]) {
+#if defined(_MSC_VER)
+    int r[4];
+    __cpuidex(r, leaf, subleaf);
+    for (int i = 0; i < 4; ++i) {
+        regs[i] = static_cast<unsigned>(r[i]);
+    }
+#else
+    __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+static unsigned long long Xgetbv() {
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    unsigned eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (static_cast<unsigned long long>(edx) << 32) | eax;
+#endif
+}
+#endif
+
+static CpuFeatures DetectCpuFeatures() {
+    CpuFeatures f;
+#if defined(VAD_ARCH_X86)
+    unsigned regs[4];
+    Cpuid(0, 0, regs);
+    unsigned max_leaf = regs[0];
+    Cpuid(1, 0, regs);
+    f.sse41 = (regs[2] >> 19) & 1;
+    bool osxsave = (regs[2] >> 27) & 1;
+    bool fma = (regs[2] >> 12) & 1;
+    // AVX state must be enabled by the OS as well
+    bool ymm_enabled = osxsave && (Xgetbv() & 0x6) == 0x6;
+    if (max_leaf >= 7 && ymm_enabled) {
+        Cpuid(7, 0, regs);
+        f.avx2 = (regs[1] >> 5) & 1;
+        f.fma = f.avx2 && fma;
+        // Opmask and the upper ZMM state as well
+        bool zmm_enabled = (Xgetbv() & 0xE6) == 0xE6;
+        f.avx512f = f.fma && zmm_enabled && ((regs[1] >> 16) & 1);
+    }
+#elif defined(VAD_ARCH_ARM64)
+    f.neon = true; // mandatory on AArch64
+#endif
+    return f;
+}
+
+const CpuFeatures &GetCpuFeatures() {
+    static const CpuFeatures features = DetectCpuFeatures();
+    return features;
+}
+
+} // namespace VadFilterOnnx
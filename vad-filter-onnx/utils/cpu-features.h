@@ -0,0 +1,35 @@
+#pragma once
+
+namespace VadFilterOnnx {
+
+// Instruction sets usable at runtime. Detected once; kernels compiled for a wider ISA than
+// the build target are only called when the CPU reports support.
+struct CpuFeatures {
+    bool sse41 = false;
+    bool avx2 = false;
+    bool fma = false;
+    bool avx512f = false;
+    bool neon = false;
+};
+
+const CpuFeatures &GetCpuFeatures();
+
+} // namespace VadFilterOnnx
+
+// Compile a single function for AVX2 without raising the target of the whole library
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define VAD_ARCH_X86 1
+#if defined(_MSC_VER) && !defined(__clang__)
+#define VAD_TARGET_AVX2
+#define VAD_TARGET_AVX2_FMA
+#define VAD_TARGET_AVX512
+#define VAD_TARGET_SSE41
+#else
+#define VAD_TARGET_AVX2 __attribute__((target("avx2")))
+#define VAD_TARGET_AVX2_FMA __attribute__((target("avx2,fma")))
+#define VAD_TARGET_AVX512 __attribute__((target("avx512f,avx2,fma")))
+#define VAD_TARGET_SSE41 __attribute__((target("sse4.1")))
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define VAD_ARCH_ARM64 1
+#endif
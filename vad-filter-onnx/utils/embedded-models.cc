@@ -0,0 +1,25 @@
+#include "utils/embedded-models.h"
+
+namespace VadFilterOnnx {
+
+// Defined in the generated embedded-models-data.cc, terminated by a null entry
+extern const EmbeddedModel kEmbeddedModels[];
+
+const EmbeddedModel *FindEmbeddedModel(const std::string &name) {
+    for (const EmbeddedModel *m = kEmbeddedModels; m->name; ++m) {
+        if (name == m->name) {
+            return m;
+        }
+    }
+    return nullptr;
+}
+
+std::vector<std::string> ListEmbeddedModels() {
+    std::vector<std::string> names;
+    for (const EmbeddedModel *m = kEmbeddedModels; m->name; ++m) {
+        names.push_back(m->name);
+    }
+    return names;
+}
+
+} // namespace VadFilterOnnx
@@ -0,0 +1,18 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace VadFilterOnnx {
+
+// A model compiled into the library, see VAD_EMBED_MODELS in CMakeLists.txt
+struct EmbeddedModel {
+    const char *name; // file name in public/models, e.g. "silero_vad.v5.onnx"
+    const unsigned char *data;
+    size_t size;
+};
+
+const EmbeddedModel *FindEmbeddedModel(const std::string &name);
+std::vector<std::string> ListEmbeddedModels();
+
+} // namespace VadFilterOnnx
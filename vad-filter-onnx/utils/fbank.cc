@@ -0,0 +1,138 @@
+#include "utils/fbank.h"
+#include "utils/simd-kernels.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace VadFilterOnnx {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr float kPreemphCoeff = 0.97f;
+constexpr float kLowFreq = 20.0f;
+
+// HTK mel scale, in float like the reference
+float HzToMel(float hz) { return 2595.0f * std::log10(1.0f + hz / 700.0f); }
+
+} // namespace
+
+Fbank::Fbank(int sample_rate, int num_mel_bins, int frame_length_ms)
+    : num_mel_bins_(num_mel_bins), frame_length_(sample_rate * frame_length_ms / 1000) {
+    n_fft_ = 1;
+    while (n_fft_ < frame_length_) {
+        n_fft_ <<= 1;
+    }
+    half_ = n_fft_ / 2;
+
+    window_.resize(frame_length_);
+    for (int i = 0; i < frame_length_; ++i) {
+        window_[i] = static_cast<float>(0.54 - 0.46 * std::cos(2.0 * kPi * i / (frame_length_ - 1)));
+    }
+
+    int bits = 0;
+    while ((1 << bits) < half_) {
+        bits++;
+    }
+    bit_reverse_.resize(half_);
+    for (int i = 0; i < half_; ++i) {
+        int r = 0;
+        for (int b = 0; b < bits; ++b) {
+            r |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+        bit_reverse_[i] = r;
+    }
+    // Stage with butterflies of size len = 2h uses e^{-2 pi i j / len}, j < h, at offset h - 1
+    for (int len = 2; len <= half_; len <<= 1) {
+        for (int j = 0; j < len / 2; ++j) {
+            twiddle_re_.push_back(static_cast<float>(std::cos(2.0 * kPi * j / len)));
+            twiddle_im_.push_back(static_cast<float>(-std::sin(2.0 * kPi * j / len)));
+        }
+    }
+    for (int k = 0; k < half_; ++k) {
+        post_re_.push_back(static_cast<float>(std::cos(2.0 * kPi * k / n_fft_)));
+        post_im_.push_back(static_cast<float>(-std::sin(2.0 * kPi * k / n_fft_)));
+    }
+
+    // Triangular filters with Kaldi's strict inequalities
+    float mel_low = HzToMel(kLowFreq);
+    float mel_high = HzToMel(sample_rate / 2.0f);
+    float mel_delta = (mel_high - mel_low) / (num_mel_bins + 1);
+    float bin_width = static_cast<float>(sample_rate) / n_fft_;
+    mel_first_.resize(num_mel_bins);
+    mel_len_.resize(num_mel_bins);
+    mel_weights_.resize(num_mel_bins);
+    for (int b = 0; b < num_mel_bins; ++b) {
+        float left = mel_low + b * mel_delta;
+        float center = mel_low + (b + 1) * mel_delta;
+        float right = mel_low + (b + 2) * mel_delta;
+        int first = -1;
+        for (int i = 0; i < half_; ++i) {
+            float mel = HzToMel(bin_width * i);
+            if (mel > left && mel < right) {
+                if (first < 0) {
+                    first = i;
+                }
+                // Fill gaps so the weights of a bin stay contiguous
+                mel_weights_[b].resize(i - first + 1, 0.0f);
+                mel_weights_[b][i - first] =
+                    mel <= center ? (mel - left) / (center - left) : (right - mel) / (right - center);
+            }
+        }
+        mel_first_[b] = std::max(first, 0);
+        mel_len_[b] = static_cast<int>(mel_weights_[b].size());
+    }
+
+    buf_.resize(n_fft_);
+    re_.resize(half_);
+    im_.resize(half_);
+    power_.resize(half_);
+}
+
+void Fbank::fft() {
+    // In-place radix-2 decimation in time; each group of butterflies is contiguous and so are
+    // its twiddles
+    for (int len = 2; len <= half_; len <<= 1) {
+        int h = len / 2;
+        const float *wr = twiddle_re_.data() + h - 1, *wi = twiddle_im_.data() + h - 1;
+        for (int start = 0; start < half_; start += len) {
+            float *ar = re_.data() + start, *ai = im_.data() + start;
+            Butterflies(ar, ai, ar + h, ai + h, wr, wi, h);
+        }
+    }
+}
+
+void Fbank::compute(const float *frame, float *out) {
+    // DC offset removal, pre-emphasis (Kaldi: x[0] -= coeff * x[0]) and window, zero-padded
+    // to n_fft_
+    float mean = Sum(frame, frame_length_) / frame_length_;
+    float *x = buf_.data();
+    PreemphasisWindow(frame, frame_length_, mean, kPreemphCoeff, window_.data(), x);
+    std::fill(x + frame_length_, x + n_fft_, 0.0f);
+
+    // Real FFT of n_fft_ points as a complex FFT of the even/odd samples
+    for (int i = 0; i < half_; ++i) {
+        int r = bit_reverse_[i];
+        re_[r] = x[2 * i];
+        im_[r] = x[2 * i + 1];
+    }
+    fft();
+    for (int k = 0; k < half_; ++k) {
+        int m = k ? half_ - k : 0;
+        // Even part E = (Z[k] + conj(Z[m])) / 2, odd part O = (Z[k] - conj(Z[m])) / 2i
+        float er = 0.5f * (re_[k] + re_[m]);
+        float ei = 0.5f * (im_[k] - im_[m]);
+        float or_ = 0.5f * (im_[k] + im_[m]);
+        float oi = -0.5f * (re_[k] - re_[m]);
+        float xr = er + post_re_[k] * or_ - post_im_[k] * oi;
+        float xi = ei + post_re_[k] * oi + post_im_[k] * or_;
+        power_[k] = xr * xr + xi * xi;
+    }
+
+    for (int b = 0; b < num_mel_bins_; ++b) {
+        float energy = DotProduct(power_.data() + mel_first_[b], mel_weights_[b].data(), mel_len_[b]);
+        out[b] = std::log(std::max(energy, FLT_EPSILON));
+    }
+}
+
+} // namespace VadFilterOnnx
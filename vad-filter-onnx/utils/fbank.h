@@ -0,0 +1,48 @@
+#pragma once
+#include <vector>
+
+namespace VadFilterOnnx {
+
+// Kaldi-style log mel filterbank of a single frame, matching scripts/filter_fbank.py as the
+// FSMN export configures it: no dither, DC offset removal, pre-emphasis 0.97, symmetric Hamming
+// window, power spectrum of the next power of two without the Nyquist bin, HTK mel bins from
+// 20 Hz to Nyquist, log floored at FLT_EPSILON.
+//
+// The power spectrum comes from a real FFT (a half-size complex radix-2 FFT in split format);
+// the mel bins are sparse dot products. The framing, the butterflies and the mel dot products
+// use the simd-kernels dispatch. The first two FFT stages (1 and 2 butterflies per group), the
+// bit-reversal gather and the even/odd split, which reads the spectrum backwards, stay scalar.
+class Fbank {
+  public:
+    Fbank(int sample_rate, int num_mel_bins = 80, int frame_length_ms = 25);
+
+    int frame_length() const { return frame_length_; }
+    int dim() const { return num_mel_bins_; }
+
+    // frame: frame_length() samples, scaled like the export (int16 range); out: dim() values
+    void compute(const float *frame, float *out);
+
+  private:
+    void fft();
+
+    int num_mel_bins_;
+    int frame_length_;
+    int n_fft_;
+    int half_; // n_fft_ / 2, the size of the complex FFT and the number of output bins
+
+    std::vector<float> window_;
+    std::vector<int> bit_reverse_;
+    std::vector<float> twiddle_re_, twiddle_im_; // per FFT stage, see the constructor
+    std::vector<float> post_re_, post_im_;       // e^{-2 pi i k / n_fft_}, k < half_
+    // Mel bin b covers power bins [mel_first_[b], mel_first_[b] + mel_len_[b])
+    std::vector<int> mel_first_;
+    std::vector<int> mel_len_;
+    std::vector<std::vector<float>> mel_weights_;
+
+    // Scratch
+    std::vector<float> buf_;
+    std::vector<float> re_, im_;
+    std::vector<float> power_;
+};
+
+} // namespace VadFilterOnnx
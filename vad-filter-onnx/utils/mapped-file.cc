@@ -0,0 +1,108 @@
+#include "utils/mapped-file.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace VadFilterOnnx {
+
+#ifdef _WIN32
+
+std::shared_ptr<MappedFile> MappedFile::open(const std::string &path) {
+    std::shared_ptr<MappedFile> file(new MappedFile());
+    std::wstring wide_path(path.begin(), path.end());
+    HANDLE handle = CreateFileW(wide_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        printf("ERROR: Failed to open %s for mapping\n", path.c_str());
+        return nullptr;
+    }
+    file->file_ = handle;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(handle, &size) || size.QuadPart == 0) {
+        printf("ERROR: Failed to get the size of %s\n", path.c_str());
+        return nullptr;
+    }
+    file->size_ = static_cast<size_t>(size.QuadPart);
+    file->mapping_ = CreateFileMappingW(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!file->mapping_) {
+        printf("ERROR: Failed to map %s\n", path.c_str());
+        return nullptr;
+    }
+    file->data_ = MapViewOfFile(file->mapping_, FILE_MAP_READ, 0, 0, 0);
+    if (!file->data_) {
+        printf("ERROR: Failed to map %s\n", path.c_str());
+        return nullptr;
+    }
+    return file;
+}
+
+// The working set manager trims clean mapped pages under memory pressure
+void MappedFile::release(size_t, size_t) const {}
+
+MappedFile::~MappedFile() {
+    if (data_) {
+        UnmapViewOfFile(data_);
+    }
+    if (mapping_) {
+        CloseHandle(mapping_);
+    }
+    if (file_) {
+        CloseHandle(file_);
+    }
+}
+
+#else
+
+std::shared_ptr<MappedFile> MappedFile::open(const std::string &path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        printf("ERROR: Failed to open %s for mapping\n", path.c_str());
+        return nullptr;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        printf("ERROR: Failed to get the size of %s\n", path.c_str());
+        close(fd);
+        return nullptr;
+    }
+    void *data = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    // The mapping stays valid after the descriptor is closed
+    close(fd);
+    if (data == MAP_FAILED) {
+        printf("ERROR: Failed to map %s\n", path.c_str());
+        return nullptr;
+    }
+    std::shared_ptr<MappedFile> file(new MappedFile());
+    file->data_ = data;
+    file->size_ = static_cast<size_t>(st.st_size);
+    return file;
+}
+
+void MappedFile::release(size_t offset, size_t size) const {
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    uintptr_t base = reinterpret_cast<uintptr_t>(data_);
+    uintptr_t begin = (base + std::min(offset, size_) + page - 1) / page * page;
+    uintptr_t end = (base + std::min(offset + size, size_)) / page * page;
+    if (begin < end) {
+        madvise(reinterpret_cast<void *>(begin), end - begin, MADV_DONTNEED);
+    }
+}
+
+MappedFile::~MappedFile() {
+    if (data_) {
+        munmap(const_cast<void *>(data_), size_);
+    }
+}
+
+#endif
+
+} // namespace VadFilterOnnx
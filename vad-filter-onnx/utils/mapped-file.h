@@ -0,0 +1,37 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace VadFilterOnnx {
+
+// Read-only memory mapping of a file. Processes mapping the same file share its page-cache
+// pages instead of each holding a private copy.
+class MappedFile {
+  public:
+    static std::shared_ptr<MappedFile> open(const std::string &path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    const void *data() const { return data_; }
+    size_t size() const { return size_; }
+
+    // Drop the whole pages of [offset, offset + size) from the process; they are read back
+    // from the page cache if accessed again. Keeps sequential readers of large files at
+    // constant memory.
+    void release(size_t offset, size_t size) const;
+
+  private:
+    MappedFile() = default;
+
+    const void *data_ = nullptr;
+    size_t size_ = 0;
+#ifdef _WIN32
+    void *file_ = nullptr;
+    void *mapping_ = nullptr;
+#endif
+};
+
+} // namespace VadFilterOnnx
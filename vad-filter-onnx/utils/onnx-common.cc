@@ -1,19 +1,49 @@
 #include "utils/onnx-common.h"
+#include "utils/cpu-features.h"
+#include "utils/mapped-file.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
 #include <format>
+#include <functional>
+#include <mutex>
+#include <random>
 #include <sstream>
+#include <unordered_map>
 
 namespace VadFilterOnnx {
 
-Ort::Env &GetOrtEnv() {
+static bool g_global_thread_pools = false;
+
+Ort::Env &GetOrtEnv(const SessionConfig &config) {
+    static std::mutex mutex;
     static Ort::Env env{ nullptr };
+    std::lock_guard<std::mutex> lock(mutex);
     if (!env) {
-        env = Ort::Env(ORT_LOGGING_LEVEL_ERROR, "global_env");
+        if (config.use_global_thread_pools) {
+            Ort::ThreadingOptions threading_options;
+            threading_options.SetGlobalIntraOpNumThreads(config.global_intra_op_threads);
+            threading_options.SetGlobalInterOpNumThreads(config.global_inter_op_threads);
+            threading_options.SetGlobalSpinControl(config.allow_spinning ? 1 : 0);
+            env = Ort::Env(threading_options, ORT_LOGGING_LEVEL_ERROR, "global_env");
+            g_global_thread_pools = true;
+            printf("INFO: Created global thread pools, intra_op=%d inter_op=%d spinning=%d\n",
+                   config.global_intra_op_threads, config.global_inter_op_threads,
+                   config.allow_spinning ? 1 : 0);
+        } else {
+            env = Ort::Env(ORT_LOGGING_LEVEL_ERROR, "global_env");
+        }
+    } else if (config.use_global_thread_pools && !g_global_thread_pools) {
+        printf("WARNING: Global thread pools requested after the ORT env was created without "
+               "them, using per-session threads\n");
     }
     return env;
 }
 
+bool HasGlobalThreadPools() { return g_global_thread_pools; }
+
 // Note(lxp): device_id指定运行设备
-Ort::SessionOptions GetSessionOptions(int num_threads, int device_id) {
+Ort::SessionOptions GetSessionOptions(const SessionConfig &config) {
     static std::vector<std::string> available_providers = Ort::GetAvailableProviders();
     static bool is_cuda_available = false;
     for (const auto &provider : available_providers) {
@@ -25,41 +55,257 @@ Ort::SessionOptions GetSessionOptions(int num_threads, int device_id) {
 
     Ort::SessionOptions sess_opts;
     sess_opts.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
-    if (device_id > 0 && is_cuda_available) {
-        OrtCUDAProviderOptions config;
-        config.device_id = device_id;
-        config.cudnn_conv_algo_search = OrtCudnnConvAlgoSearchHeuristic;
-        sess_opts.AppendExecutionProvider_CUDA(config);
-        printf("INFO: Initialize session in cuda:%d\n", device_id);
+    if (config.device_id > 0 && is_cuda_available) {
+        OrtCUDAProviderOptions cuda_config;
+        cuda_config.device_id = config.device_id;
+        cuda_config.cudnn_conv_algo_search = OrtCudnnConvAlgoSearchHeuristic;
+        sess_opts.AppendExecutionProvider_CUDA(cuda_config);
+        printf("INFO: Initialize session in cuda:%d\n", config.device_id);
     } else {
-        sess_opts.SetIntraOpNumThreads(num_threads); // 同一算子内部平行
-        sess_opts.SetInterOpNumThreads(num_threads); // 不同操作之间并行
-        sess_opts.DisableCpuMemArena();              //
+        if (config.use_global_thread_pools && HasGlobalThreadPools()) {
+            // Run on the env's shared pools instead of spawning threads per session
+            sess_opts.DisablePerSessionThreads();
+        } else {
+            sess_opts.SetIntraOpNumThreads(config.num_threads); // 同一算子内部平行
+            sess_opts.SetInterOpNumThreads(config.num_threads); // 不同操作之间并行
+            if (!config.allow_spinning) {
+                sess_opts.AddConfigEntry("session.intra_op.allow_spinning", "0");
+                sess_opts.AddConfigEntry("session.inter_op.allow_spinning", "0");
+            }
+        }
+        if (config.enable_cpu_mem_arena) {
+            // Steady state: intermediate buffers are served from the arena, not malloc
+            sess_opts.EnableCpuMemArena();
+            sess_opts.EnableMemPattern();
+        } else {
+            sess_opts.DisableCpuMemArena();
+        }
         printf("INFO: Initialize session in cpu\n");
     }
 
     return std::move(sess_opts);
 }
 
-std::shared_ptr<Ort::Session> ReadOnnx(const std::string &path, int num_threads, int device_id) {
-    printf("INFO: Reading onnx model: %s\n", path.c_str());
-    auto &env = GetOrtEnv();
-    auto sess_opts = GetSessionOptions(num_threads, device_id);
-    std::shared_ptr<Ort::Session> session{ nullptr };
-    try {
+Ort::SessionOptions GetSessionOptions(int num_threads, int device_id) {
+    SessionConfig config;
+    config.num_threads = num_threads;
+    config.device_id = device_id;
+    return GetSessionOptions(config);
+}
+
+static bool IsOrtFormat(const void *data, size_t size) {
+    // ORT format models are flatbuffers with the file identifier "ORTM"
+    return size >= 8 && std::memcmp(static_cast<const char *>(data) + 4, "ORTM", 4) == 0;
+}
+
+// `owner` keeps `data` alive for the lifetime of the session. ORT copies the weights of ONNX
+// models, but uses ORT-format models in place, so their initializers stay in `data`, e.g. in
+// page-cache pages shared by every process that maps the file.
+static std::shared_ptr<Ort::Session> NewSession(Ort::Env &env, const void *data, size_t size,
+                                                Ort::SessionOptions &sess_opts,
+                                                std::shared_ptr<const void> owner) {
+    if (IsOrtFormat(data, size)) {
+        sess_opts.AddConfigEntry("session.load_model_format", "ORT");
+        if (owner) {
+            sess_opts.AddConfigEntry("session.use_ort_model_bytes_directly", "1");
+            sess_opts.AddConfigEntry("session.use_ort_model_bytes_for_initializers", "1");
+        }
+    } else {
+        owner.reset();
+    }
+    auto *session = new Ort::Session(env, data, size, sess_opts);
+    return std::shared_ptr<Ort::Session>(session, [owner](Ort::Session *s) { delete s; });
+}
+
+static std::shared_ptr<Ort::Session> NewSession(Ort::Env &env, const std::string &path,
+                                                Ort::SessionOptions &sess_opts,
+                                                const SessionConfig &config) {
+    if (config.use_mmap) {
+        auto file = MappedFile::open(path);
+        if (!file) {
+            throw std::runtime_error("failed to map " + path);
+        }
+        return NewSession(env, file->data(), file->size(), sess_opts, file);
+    }
+#ifdef _WIN32
+    // Windows需要宽字符路径
+    std::wstring wide_path(path.begin(), path.end());
+    return std::make_shared<Ort::Session>(env, wide_path.c_str(), sess_opts);
+#else
+    return std::make_shared<Ort::Session>(env, path.c_str(), sess_opts);
+#endif
+}
+
+// Path of the optimized model for `path` in the cache dir. The name hashes everything that
+// invalidates the optimized graph: the source file, its size and mtime, the ORT version, and
+// the instruction sets, since ORT_ENABLE_ALL bakes ISA-specific layouts and fused kernels into
+// the graph and a cache dir may be shared by machines with different CPUs.
+static std::string OptimizedModelPath(const std::string &path, const SessionConfig &config) {
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    fs::path source = fs::weakly_canonical(path, ec);
+    auto size = fs::file_size(path, ec);
+    auto mtime = fs::last_write_time(path, ec).time_since_epoch().count();
+    const CpuFeatures &cpu = GetCpuFeatures();
+    int isa = cpu.sse41 | cpu.avx2 << 1 | cpu.fma << 2 | cpu.avx512f << 3 | cpu.neon << 4;
+    std::string key =
+        std::format("{}|{}|{}|{}|{}", source.string(), size, mtime, ORT_API_VERSION, isa);
+    auto hash = std::hash<std::string>{}(key);
+    return (fs::path(config.optimized_model_cache_dir) /
+            std::format("{}.{:016x}.ort", fs::path(path).stem().string(), hash))
+        .string();
+}
+
+static std::shared_ptr<Ort::Session> LoadSession(const std::string &path,
+                                                 const SessionConfig &config) {
+    namespace fs = std::filesystem;
+    auto &env = GetOrtEnv(config);
+    auto sess_opts = GetSessionOptions(config);
+    if (config.optimized_model_cache_dir.empty() || config.device_id > 0) {
+        return NewSession(env, path, sess_opts, config);
+    }
+
+    std::string cached = OptimizedModelPath(path, config);
+    std::error_code ec;
+    if (fs::exists(cached, ec)) {
+        printf("INFO: Using optimized model cache: %s\n", cached.c_str());
+        sess_opts.AddConfigEntry("session.load_model_format", "ORT");
+        return NewSession(env, cached, sess_opts, config);
+    }
+
+    // Write to a private file first so concurrent processes never read a partial model
+    fs::create_directories(config.optimized_model_cache_dir, ec);
+    std::string tmp = std::format("{}.{:08x}.tmp", cached, std::random_device{}());
 #ifdef _WIN32
-        // Windows需要宽字符路径
-        std::wstring wide_path(path.begin(), path.end());
-        session = std::make_shared<Ort::Session>(env, wide_path.c_str(), sess_opts);
+    std::wstring wide_tmp(tmp.begin(), tmp.end());
+    sess_opts.SetOptimizedModelFilePath(wide_tmp.c_str());
 #else
-        session = std::make_shared<Ort::Session>(env, path.c_str(), sess_opts);
+    sess_opts.SetOptimizedModelFilePath(tmp.c_str());
 #endif
-        printf("INFO: Success to load onnx model: %s\n", path.c_str());
+    sess_opts.AddConfigEntry("session.save_model_format", "ORT");
+    auto session = NewSession(env, path, sess_opts, config);
+    fs::rename(tmp, cached, ec);
+    if (ec) {
+        printf("WARNING: Failed to write optimized model cache %s: %s\n", cached.c_str(),
+               ec.message().c_str());
+        fs::remove(tmp, ec);
+    } else {
+        printf("INFO: Saved optimized model cache: %s\n", cached.c_str());
+    }
+    return session;
+}
+
+// Sessions are safe to Run concurrently, so handles loading the same model with the same
+// options can share one. Entries are weak: the session is released with its last handle.
+// The lock is not held while loading, so loads of other models are not serialized behind a
+// slow one; concurrent first loads of the same key may both load, and the first insert wins.
+static std::shared_ptr<Ort::Session>
+CachedSession(const std::string &name, const SessionConfig &config,
+              const std::function<std::shared_ptr<Ort::Session>()> &load) {
+    static std::mutex cache_mutex;
+    static std::unordered_map<std::string, std::weak_ptr<Ort::Session>> cache;
+    std::string key = std::format("{}|{}|{}|{}|{}|{}|{}|{}|{}", name, config.num_threads,
+                                  config.device_id, config.enable_cpu_mem_arena,
+                                  config.use_global_thread_pools, config.allow_spinning,
+                                  config.optimized_model_cache_dir, config.use_mmap,
+                                  HasGlobalThreadPools());
+    bool use_cache = config.enable_session_cache && !name.empty();
+    if (use_cache) {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        auto it = cache.find(key);
+        if (it != cache.end()) {
+            if (auto session = it->second.lock()) {
+                printf("INFO: Reusing cached session for onnx model: %s\n", name.c_str());
+                return session;
+            }
+        }
+    }
+
+    std::shared_ptr<Ort::Session> session{ nullptr };
+    try {
+        session = load();
     } catch (std::exception const &e) {
         printf("ERROR: Error when load onnx model: %s\n", e.what());
         exit(0);
     }
-    return std::move(session);
+    if (use_cache && session) {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        std::erase_if(cache, [](const auto &entry) { return entry.second.expired(); });
+        auto &entry = cache[key];
+        if (auto existing = entry.lock()) {
+            // Loaded by another thread meanwhile: share that one, drop ours
+            return existing;
+        }
+        entry = session;
+    }
+    return session;
+}
+
+std::shared_ptr<Ort::Session> ReadOnnx(const std::string &path, const SessionConfig &config) {
+    auto session = CachedSession(path, config, [&]() {
+        printf("INFO: Reading onnx model: %s\n", path.c_str());
+        return LoadSession(path, config);
+    });
+    printf("INFO: Success to load onnx model: %s\n", path.c_str());
+    return session;
+}
+
+std::shared_ptr<Ort::Session> ReadOnnx(const void *data, size_t size, const SessionConfig &config,
+                                       std::shared_ptr<const void> owner,
+                                       const std::string &name) {
+    return CachedSession(name, config, [&]() -> std::shared_ptr<Ort::Session> {
+        printf("INFO: Reading onnx model from a %zu byte buffer\n", size);
+        auto &env = GetOrtEnv(config);
+        auto sess_opts = GetSessionOptions(config);
+        // The bytes come from the caller, so a bad buffer is reported, not fatal
+        try {
+            return NewSession(env, data, size, sess_opts, owner);
+        } catch (const Ort::Exception &e) {
+            printf("ERROR: Error when load onnx model from buffer: %s\n", e.what());
+            return nullptr;
+        }
+    });
+}
+
+std::shared_ptr<Ort::Session> ReadOnnx(const std::string &path, int num_threads, int device_id) {
+    SessionConfig config;
+    config.num_threads = num_threads;
+    config.device_id = device_id;
+    return ReadOnnx(path, config);
+}
+
+std::string GetCustomMetadata(const std::shared_ptr<Ort::Session> &session, const char *key) {
+    Ort::AllocatorWithDefaultOptions allocator;
+    auto value = session->GetModelMetadata().LookupCustomMetadataMapAllocated(key, allocator);
+    return value ? std::string(value.get()) : std::string();
+}
+
+std::vector<int64_t> GetOutputShape(const std::shared_ptr<Ort::Session> &session, size_t index) {
+    auto shape = session->GetOutputTypeInfo(index).GetTensorTypeAndShapeInfo().GetShape();
+    for (auto &dim : shape) {
+        if (dim < 0) {
+            dim = 1;
+        }
+    }
+    return shape;
+}
+
+void GatherBatch(const float *const *src, int batch, int outer, int inner, float *dst) {
+    for (int o = 0; o < outer; ++o) {
+        for (int b = 0; b < batch; ++b) {
+            const float *row = src[b] + static_cast<size_t>(o) * inner;
+            std::copy(row, row + inner, dst + (static_cast<size_t>(o) * batch + b) * inner);
+        }
+    }
+}
+
+void ScatterBatch(const float *src, int batch, int outer, int inner, float *const *dst) {
+    for (int o = 0; o < outer; ++o) {
+        for (int b = 0; b < batch; ++b) {
+            const float *row = src + (static_cast<size_t>(o) * batch + b) * inner;
+            std::copy(row, row + inner, dst[b] + static_cast<size_t>(o) * inner);
+        }
+    }
 }
 
 void GetInputOutputInfo(const std::shared_ptr<Ort::Session> &session,
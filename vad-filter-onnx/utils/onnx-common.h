@@ -1,5 +1,6 @@
 #pragma once
 #include "onnxruntime_cxx_api.h" // NOLINT
+#include "vad-config.h"
 
 namespace VadFilterOnnx {
 
@@ -9,10 +10,37 @@ template <typename T = float> void Fill(Ort::Value *tensor, T value) {
     std::fill(p, p + n, value);
 }
 
-Ort::Env &GetOrtEnv();
+// Gather per-stream tensors shaped [outer, 1, inner] into one [outer, batch, inner] buffer,
+// and scatter a batched result back. Used to pack recurrent states for batched inference.
+void GatherBatch(const float *const *src, int batch, int outer, int inner, float *dst);
+void ScatterBatch(const float *src, int batch, int outer, int inner, float *const *dst);
+
+// Wrap a caller-owned CPU buffer, e.g. to preallocate inputs/outputs once per instance
+template <typename T>
+Ort::Value WrapTensor(T *data, size_t n, const int64_t *shape, size_t rank) {
+    static Ort::MemoryInfo memory_info =
+        Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
+    return Ort::Value::CreateTensor<T>(memory_info, data, n, shape, rank);
+}
+
+// The env is created on first use; `config` decides whether it owns global thread pools
+Ort::Env &GetOrtEnv(const SessionConfig &config = SessionConfig());
+bool HasGlobalThreadPools();
+Ort::SessionOptions GetSessionOptions(const SessionConfig &config);
 Ort::SessionOptions GetSessionOptions(int num_threads = 1, int device_id = -1);
+std::shared_ptr<Ort::Session> ReadOnnx(const std::string &path, const SessionConfig &config);
 std::shared_ptr<Ort::Session> ReadOnnx(const std::string &path, int num_threads = 1,
                                        int device_id = -1);
+// Load from memory. The buffer must stay valid while the session is created; pass `owner` to
+// keep it alive with the session, which lets ORT-format models be used in place. A non-empty
+// `name` enables the session cache. Returns nullptr if ORT rejects the bytes.
+std::shared_ptr<Ort::Session> ReadOnnx(const void *data, size_t size, const SessionConfig &config,
+                                       std::shared_ptr<const void> owner = nullptr,
+                                       const std::string &name = "");
+// Custom metadata value of the model, empty if the key is missing
+std::string GetCustomMetadata(const std::shared_ptr<Ort::Session> &session, const char *key);
+// Output shape with dynamic dimensions resolved to 1 (a single stream)
+std::vector<int64_t> GetOutputShape(const std::shared_ptr<Ort::Session> &session, size_t index);
 void GetInputOutputInfo(const std::shared_ptr<Ort::Session> &session,
                         std::vector<const char *> &in_names, std::vector<const char *> &out_names);
 
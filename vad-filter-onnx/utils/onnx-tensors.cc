@@ -0,0 +1,254 @@
+#include "utils/onnx-tensors.h"
+#include <cstring>
+
+namespace VadFilterOnnx {
+
+namespace {
+
+// Protobuf wire format, just enough for ModelProto -> GraphProto -> NodeProto/TensorProto
+class Reader {
+  public:
+    Reader(const uint8_t *p, const uint8_t *end) : p_(p), end_(end) {}
+
+    bool done() const { return p_ >= end_ || failed_; }
+    bool failed() const { return failed_; }
+
+    // Next field; len-delimited payloads are returned as a sub-reader in *payload
+    bool next(int *field, int *wire, uint64_t *value, Reader *payload) {
+        uint64_t key;
+        if (!varint(&key)) {
+            return false;
+        }
+        *field = static_cast<int>(key >> 3);
+        *wire = static_cast<int>(key & 7);
+        switch (*wire) {
+        case 0:
+            return varint(value);
+        case 1:
+            return skip(8);
+        case 5:
+            return skip(4);
+        case 2: {
+            uint64_t len;
+            if (!varint(&len) || len > static_cast<uint64_t>(end_ - p_)) {
+                return fail();
+            }
+            *payload = Reader(p_, p_ + len);
+            p_ += len;
+            return true;
+        }
+        default:
+            return fail();
+        }
+    }
+
+    bool varint(uint64_t *value) {
+        *value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (p_ >= end_) {
+                return fail();
+            }
+            uint8_t byte = *p_++;
+            *value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) {
+                return true;
+            }
+        }
+        return fail();
+    }
+
+    std::string str() const { return std::string(reinterpret_cast<const char *>(p_), end_ - p_); }
+    const uint8_t *begin() const { return p_; }
+    size_t size() const { return end_ - p_; }
+
+  private:
+    bool skip(size_t n) {
+        if (n > static_cast<size_t>(end_ - p_)) {
+            return fail();
+        }
+        p_ += n;
+        return true;
+    }
+    bool fail() {
+        failed_ = true;
+        return false;
+    }
+
+    const uint8_t *p_;
+    const uint8_t *end_;
+    bool failed_ = false;
+};
+
+constexpr int kFloat = 1; // TensorProto.DataType.FLOAT
+
+// TensorProto; false for malformed data, *ok = false for tensors that are not inline floats
+bool ReadTensor(Reader r, OnnxTensor *tensor, bool *ok) {
+    int field, wire;
+    uint64_t value;
+    Reader payload(nullptr, nullptr);
+    int64_t data_type = 0;
+    bool external = false;
+    std::vector<float> float_data;
+    Reader raw(nullptr, nullptr);
+    while (!r.done()) {
+        if (!r.next(&field, &wire, &value, &payload)) {
+            return false;
+        }
+        if (field == 1 && wire == 0) {
+            tensor->dims.push_back(static_cast<int64_t>(value));
+        } else if (field == 1 && wire == 2) {
+            while (!payload.done()) {
+                if (!payload.varint(&value)) {
+                    return false;
+                }
+                tensor->dims.push_back(static_cast<int64_t>(value));
+            }
+        } else if (field == 2 && wire == 0) {
+            data_type = static_cast<int64_t>(value);
+        } else if (field == 4 && wire == 2) {
+            size_t n = payload.size() / sizeof(float);
+            float_data.resize(n);
+            std::memcpy(float_data.data(), payload.begin(), n * sizeof(float));
+        } else if (field == 8 && wire == 2) {
+            tensor->name = payload.str();
+        } else if (field == 9 && wire == 2) {
+            raw = payload;
+        } else if (field == 14 && wire == 0) {
+            external = value == 1;
+        }
+    }
+    *ok = data_type == kFloat && !external;
+    if (!*ok) {
+        return true;
+    }
+    if (raw.size()) {
+        // raw_data is little endian, like every platform this library targets
+        tensor->data.resize(raw.size() / sizeof(float));
+        std::memcpy(tensor->data.data(), raw.begin(), tensor->data.size() * sizeof(float));
+    } else {
+        tensor->data = std::move(float_data);
+    }
+    size_t count = 1;
+    for (int64_t d : tensor->dims) {
+        count *= static_cast<size_t>(d);
+    }
+    *ok = count == tensor->data.size();
+    return true;
+}
+
+bool ReadGraph(Reader r, std::vector<OnnxTensor> *tensors);
+
+// AttributeProto: the value of a Constant node, or subgraphs to descend into
+bool ReadAttribute(Reader r, bool constant, const std::string &output,
+                   std::vector<OnnxTensor> *tensors) {
+    int field, wire;
+    uint64_t value;
+    Reader payload(nullptr, nullptr);
+    std::string name;
+    Reader tensor_payload(nullptr, nullptr);
+    while (!r.done()) {
+        if (!r.next(&field, &wire, &value, &payload)) {
+            return false;
+        }
+        if (field == 1 && wire == 2) {
+            name = payload.str();
+        } else if (field == 5 && wire == 2) {
+            tensor_payload = payload;
+        } else if ((field == 6 || field == 11) && wire == 2) {
+            if (!ReadGraph(payload, tensors)) {
+                return false;
+            }
+        }
+    }
+    if (constant && name == "value" && tensor_payload.size()) {
+        OnnxTensor tensor;
+        bool ok = false;
+        if (!ReadTensor(tensor_payload, &tensor, &ok)) {
+            return false;
+        }
+        if (ok) {
+            tensor.name = output;
+            tensors->push_back(std::move(tensor));
+        }
+    }
+    return true;
+}
+
+// NodeProto: op_type and outputs come before the attributes in practice, but the wire format
+// does not promise it, so attributes are read once the node is complete
+bool ReadNode(Reader r, std::vector<OnnxTensor> *tensors) {
+    int field, wire;
+    uint64_t value;
+    Reader payload(nullptr, nullptr);
+    std::string op_type, output;
+    std::vector<Reader> attributes;
+    while (!r.done()) {
+        if (!r.next(&field, &wire, &value, &payload)) {
+            return false;
+        }
+        if (field == 2 && wire == 2 && output.empty()) {
+            output = payload.str();
+        } else if (field == 4 && wire == 2) {
+            op_type = payload.str();
+        } else if (field == 5 && wire == 2) {
+            attributes.push_back(payload);
+        }
+    }
+    for (const auto &attribute : attributes) {
+        if (!ReadAttribute(attribute, op_type == "Constant", output, tensors)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ReadGraph(Reader r, std::vector<OnnxTensor> *tensors) {
+    int field, wire;
+    uint64_t value;
+    Reader payload(nullptr, nullptr);
+    while (!r.done()) {
+        if (!r.next(&field, &wire, &value, &payload)) {
+            return false;
+        }
+        if (field == 1 && wire == 2) {
+            if (!ReadNode(payload, tensors)) {
+                return false;
+            }
+        } else if (field == 5 && wire == 2) {
+            OnnxTensor tensor;
+            bool ok = false;
+            if (!ReadTensor(payload, &tensor, &ok)) {
+                return false;
+            }
+            if (ok) {
+                tensors->push_back(std::move(tensor));
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+bool ReadOnnxFloatTensors(const void *data, size_t size, std::vector<OnnxTensor> *tensors) {
+    const uint8_t *p = static_cast<const uint8_t *>(data);
+    Reader r(p, p + size);
+    int field, wire;
+    uint64_t value;
+    Reader payload(nullptr, nullptr);
+    bool has_graph = false;
+    while (!r.done()) {
+        if (!r.next(&field, &wire, &value, &payload)) {
+            return false;
+        }
+        if (field == 7 && wire == 2) {
+            if (!ReadGraph(payload, tensors)) {
+                return false;
+            }
+            has_graph = true;
+        }
+    }
+    return has_graph && !r.failed();
+}
+
+} // namespace VadFilterOnnx
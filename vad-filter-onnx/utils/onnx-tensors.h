@@ -0,0 +1,22 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace VadFilterOnnx {
+
+// A float tensor stored in an ONNX model
+struct OnnxTensor {
+    std::string name;
+    std::vector<int64_t> dims;
+    std::vector<float> data;
+};
+
+// Parse the ModelProto in [data, data + size) without ONNX Runtime and return its float
+// initializers and Constant node values, those of subgraphs (If/Loop bodies) included.
+// Constants are named after the node output. External data is not supported. Returns false
+// if the buffer is not a well-formed ONNX model.
+bool ReadOnnxFloatTensors(const void *data, size_t size, std::vector<OnnxTensor> *tensors);
+
+} // namespace VadFilterOnnx
@@ -0,0 +1,160 @@
+#include "utils/resampler.h"
+#include "utils/simd-kernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <numeric>
+
+namespace VadFilterOnnx {
+
+namespace {
+
+// Zero crossings of the filter on each side, in output samples
+constexpr int kHalfTaps = 16;
+// Keeps the phase table small; covers all common rates (44.1k -> 16k needs 160 phases)
+constexpr int kMaxPhases = 1024;
+constexpr double kKaiserBeta = 8.0;
+constexpr double kPi = 3.14159265358979323846;
+
+double BesselI0(double x) {
+    double sum = 1.0, term = 1.0;
+    for (int k = 1; k < 50 && term > 1e-12 * sum; ++k) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+// Low-pass with cutoff fc (fraction of the input Nyquist) at offset d input samples,
+// Kaiser-windowed over |d| < half_width
+double Tap(double d, double fc, int half_width) {
+    double x = d / half_width;
+    if (std::abs(x) >= 1.0) {
+        return 0.0;
+    }
+    double arg = fc * d;
+    double sinc = arg == 0.0 ? 1.0 : std::sin(kPi * arg) / (kPi * arg);
+    return fc * sinc * BesselI0(kKaiserBeta * std::sqrt(1.0 - x * x)) / BesselI0(kKaiserBeta);
+}
+
+} // namespace
+
+std::unique_ptr<StreamingResampler> StreamingResampler::create(int in_rate, int out_rate) {
+    if (in_rate <= 0 || out_rate <= 0) {
+        printf("ERROR: Invalid resampling rates %d -> %d\n", in_rate, out_rate);
+        return nullptr;
+    }
+    int g = std::gcd(in_rate, out_rate);
+    int up = out_rate / g;
+    int down = in_rate / g;
+    if (up > kMaxPhases) {
+        printf("ERROR: Unsupported resampling ratio %d -> %d\n", in_rate, out_rate);
+        return nullptr;
+    }
+    return std::unique_ptr<StreamingResampler>(new StreamingResampler(in_rate, out_rate, up, down));
+}
+
+StreamingResampler::StreamingResampler(int in_rate, int out_rate, int up, int down)
+    : in_rate_(in_rate), out_rate_(out_rate), up_(up), down_(down) {
+    double ratio = static_cast<double>(up) / down;
+    halfband_ = up == 1 && down == 2;
+    // Downsampling: cut below the output Nyquist, leaving a transition band
+    double fc = halfband_ ? 0.5 : std::min(1.0, ratio * 0.9);
+    half_width_ = static_cast<int>(std::ceil(kHalfTaps / std::min(1.0, ratio)));
+
+    if (halfband_) {
+        // Only odd offsets are non-zero; normalize to unit DC gain with the 0.5 center tap
+        double sum = 0.0;
+        for (int j = 1; j < half_width_; j += 2) {
+            halfband_taps_.push_back(static_cast<float>(Tap(j, fc, half_width_)));
+            sum += 2.0 * halfband_taps_.back();
+        }
+        for (auto &t : halfband_taps_) {
+            t = static_cast<float>(t * 0.5 / sum);
+        }
+        pairs_.resize(halfband_taps_.size());
+    } else {
+        int len = 2 * half_width_;
+        taps_.resize(static_cast<size_t>(up) * len);
+        for (int p = 0; p < up; ++p) {
+            float *phase = taps_.data() + static_cast<size_t>(p) * len;
+            double sum = 0.0;
+            for (int i = 0; i < len; ++i) {
+                phase[i] = static_cast<float>(Tap(static_cast<double>(p) / up + half_width_ - 1 - i,
+                                                  fc, half_width_));
+                sum += phase[i];
+            }
+            for (int i = 0; i < len; ++i) {
+                phase[i] = static_cast<float>(phase[i] / sum);
+            }
+        }
+    }
+    reset();
+}
+
+void StreamingResampler::reset() {
+    // Samples before the stream start are zero
+    history_.assign(half_width_, 0.0f);
+    history_begin_ = -half_width_;
+    num_input_ = 0;
+    next_output_ = 0;
+}
+
+int StreamingResampler::max_output(int n) const {
+    int64_t total = (num_input_ + n) * up_ / down_ + 1;
+    return static_cast<int>(std::max<int64_t>(0, total - next_output_));
+}
+
+void StreamingResampler::emit(int64_t end, std::vector<float> *out) {
+    int64_t available = history_begin_ + static_cast<int64_t>(history_.size());
+    while (true) {
+        int64_t pos = next_output_ * down_;
+        int64_t n0 = pos / up_;
+        if (pos >= end * up_ || n0 + half_width_ >= available) {
+            break;
+        }
+        if (halfband_) {
+            const float *c = history_.data() + (n0 - history_begin_);
+            for (size_t m = 0; m < pairs_.size(); ++m) {
+                int j = static_cast<int>(2 * m + 1);
+                pairs_[m] = c[-j] + c[j];
+            }
+            out->push_back(0.5f * c[0] +
+                           DotProduct(pairs_.data(), halfband_taps_.data(),
+                                      static_cast<int>(pairs_.size())));
+        } else {
+            int len = 2 * half_width_;
+            const float *x = history_.data() + (n0 - half_width_ + 1 - history_begin_);
+            const float *phase = taps_.data() + static_cast<size_t>(pos % up_) * len;
+            out->push_back(DotProduct(x, phase, len));
+        }
+        next_output_++;
+    }
+
+    // Keep the inputs the next output still needs
+    int64_t keep_from = next_output_ * down_ / up_ - half_width_ + 1;
+    int64_t drop = std::min<int64_t>(keep_from - history_begin_, history_.size());
+    if (drop > 0) {
+        history_.erase(history_.begin(), history_.begin() + drop);
+        history_begin_ += drop;
+    }
+}
+
+void StreamingResampler::process(const float *data, int n, bool input_finished,
+                                 std::vector<float> *out) {
+    out->clear();
+    if (n > 0) {
+        history_.insert(history_.end(), data, data + n);
+        num_input_ += n;
+    }
+    if (!input_finished) {
+        emit(INT64_MAX / up_, out);
+        return;
+    }
+    // Zero look-ahead for the tail, and no outputs past the last input sample
+    history_.insert(history_.end(), half_width_ + 1, 0.0f);
+    emit(num_input_, out);
+    reset();
+}
+
+} // namespace VadFilterOnnx
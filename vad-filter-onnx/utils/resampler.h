@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace VadFilterOnnx {
+
+// Streaming polyphase resampler for a rational ratio out_rate/in_rate, stateful across
+// process() calls. The windowed-sinc filter is centered on each output sample, so output k
+// corresponds exactly to input position k * in_rate / out_rate: the resampler holds back the
+// last few outputs until their look-ahead arrives (or input ends) instead of adding delay.
+//
+// A 2:1 ratio uses a half-band filter: every other tap is zero and the filter is symmetric,
+// so it costs about a quarter of the generic path.
+class StreamingResampler {
+  public:
+    // Returns nullptr (with an error message) for unsupported rate pairs
+    static std::unique_ptr<StreamingResampler> create(int in_rate, int out_rate);
+
+    // Append n input samples and write all outputs that can be computed to *out (replaced).
+    // With input_finished the stream is padded with zeros, drained and reset.
+    void process(const float *data, int n, bool input_finished, std::vector<float> *out);
+    void reset();
+
+    int in_rate() const { return in_rate_; }
+    int out_rate() const { return out_rate_; }
+    // Upper bound of the outputs produced for n more input samples
+    int max_output(int n) const;
+
+  private:
+    StreamingResampler(int in_rate, int out_rate, int up, int down);
+    void emit(int64_t end, std::vector<float> *out);
+
+    int in_rate_;
+    int out_rate_;
+    int up_;   // out_rate / gcd
+    int down_; // in_rate / gcd
+    int half_width_; // filter half length in input samples
+    bool halfband_ = false;
+
+    // up_ phases of 2 * half_width_ taps, for inputs n0 - half_width_ + 1 .. n0 + half_width_
+    std::vector<float> taps_;
+    // Half-band: taps for the odd offsets 1, 3, ..., applied to x[c - j] + x[c + j]
+    std::vector<float> halfband_taps_;
+    std::vector<float> pairs_;
+
+    std::vector<float> history_; // input samples from absolute index history_begin_
+    int64_t history_begin_ = 0;
+    int64_t num_input_ = 0;      // samples received so far
+    int64_t next_output_ = 0;    // index of the next output sample
+};
+
+} // namespace VadFilterOnnx
@@ -0,0 +1,768 @@
+#include "utils/simd-kernels.h"
+#include "utils/cpu-features.h"
+
+#if defined(VAD_ARCH_X86)
+#include <immintrin.h>
+#elif defined(VAD_ARCH_ARM64)
+#include <arm_neon.h>
+#endif
+
+namespace VadFilterOnnx {
+
+namespace {
+
+constexpr float kInt16Scale = 1.0f / 32768.0f;
+
+void Int16ToFloatScalar(const int16_t *src, int n, float *dst) {
+    for (int i = 0; i < n; ++i) {
+        dst[i] = static_cast<float>(src[i]) * kInt16Scale;
+    }
+}
+
+#if defined(VAD_ARCH_X86)
+VAD_TARGET_SSE41 void Int16ToFloatSse41(const int16_t *src, int n, float *dst) {
+    const __m128 scale = _mm_set1_ps(kInt16Scale);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        __m128i lo = _mm_cvtepi16_epi32(v);
+        __m128i hi = _mm_cvtepi16_epi32(_mm_srli_si128(v, 8));
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+        _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+    }
+    Int16ToFloatScalar(src + i, n - i, dst + i);
+}
+
+VAD_TARGET_AVX2 void Int16ToFloatAvx2(const int16_t *src, int n, float *dst) {
+    const __m256 scale = _mm256_set1_ps(kInt16Scale);
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i + 8));
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(a)), scale));
+        _mm256_storeu_ps(dst + i + 8,
+                         _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(b)), scale));
+    }
+    Int16ToFloatScalar(src + i, n - i, dst + i);
+}
+#elif defined(VAD_ARCH_ARM64)
+void Int16ToFloatNeon(const int16_t *src, int n, float *dst) {
+    const float32x4_t scale = vdupq_n_f32(kInt16Scale);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        int16x8_t v = vld1q_s16(src + i);
+        vst1q_f32(dst + i, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), scale));
+        vst1q_f32(dst + i + 4, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), scale));
+    }
+    Int16ToFloatScalar(src + i, n - i, dst + i);
+}
+#endif
+
+float DotProductScalar(const float *a, const float *b, int n) {
+    float sum = 0.0f;
+    for (int i = 0; i < n; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+#if defined(VAD_ARCH_X86)
+VAD_TARGET_SSE41 float DotProductSse41(const float *a, const float *b, int n) {
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+    __m128 acc = _mm_add_ps(acc0, acc1);
+    acc = _mm_hadd_ps(acc, acc);
+    acc = _mm_hadd_ps(acc, acc);
+    return _mm_cvtss_f32(acc) + DotProductScalar(a + i, b + i, n - i);
+}
+
+VAD_TARGET_AVX2_FMA float DotProductAvx2(const float *a, const float *b, int n) {
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), acc1);
+    }
+    if (i + 8 <= n) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+        i += 8;
+    }
+    __m256 acc = _mm256_add_ps(acc0, acc1);
+    __m128 sum = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+    sum = _mm_hadd_ps(sum, sum);
+    sum = _mm_hadd_ps(sum, sum);
+    return _mm_cvtss_f32(sum) + DotProductScalar(a + i, b + i, n - i);
+}
+#elif defined(VAD_ARCH_ARM64)
+float DotProductNeon(const float *a, const float *b, int n) {
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = vfmaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+        acc1 = vfmaq_f32(acc1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+    }
+    return vaddvq_f32(vaddq_f32(acc0, acc1)) + DotProductScalar(a + i, b + i, n - i);
+}
+#endif
+
+// Stereo is the common case and gets vector paths; other layouts use strided loops
+void DeinterleaveScalar(const float *src, int frames, int channels, float *const *dst) {
+    for (int i = 0; i < frames; ++i) {
+        for (int c = 0; c < channels; ++c) {
+            dst[c][i] = src[static_cast<size_t>(i) * channels + c];
+        }
+    }
+}
+
+void DownmixScalar(const float *src, int frames, int channels, float *dst) {
+    float scale = 1.0f / channels;
+    for (int i = 0; i < frames; ++i) {
+        const float *frame = src + static_cast<size_t>(i) * channels;
+        float sum = 0.0f;
+        for (int c = 0; c < channels; ++c) {
+            sum += frame[c];
+        }
+        dst[i] = sum * scale;
+    }
+}
+
+#if defined(VAD_ARCH_X86)
+VAD_TARGET_SSE41 void DeinterleaveStereoSse41(const float *src, int frames, float *left,
+                                               float *right) {
+    int i = 0;
+    for (; i + 4 <= frames; i += 4) {
+        __m128 a = _mm_loadu_ps(src + 2 * i);
+        __m128 b = _mm_loadu_ps(src + 2 * i + 4);
+        _mm_storeu_ps(left + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+        _mm_storeu_ps(right + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+    }
+    float *dst[2] = { left + i, right + i };
+    DeinterleaveScalar(src + 2 * i, frames - i, 2, dst);
+}
+
+VAD_TARGET_SSE41 void DownmixStereoSse41(const float *src, int frames, float *out) {
+    const __m128 half = _mm_set1_ps(0.5f);
+    int i = 0;
+    for (; i + 4 <= frames; i += 4) {
+        __m128 a = _mm_loadu_ps(src + 2 * i);
+        __m128 b = _mm_loadu_ps(src + 2 * i + 4);
+        __m128 l = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 r = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+        _mm_storeu_ps(out + i, _mm_mul_ps(_mm_add_ps(l, r), half));
+    }
+    DownmixScalar(src + 2 * i, frames - i, 2, out + i);
+}
+
+// [l0 r0 l1 r1 l2 r2 l3 r3] -> [l0 l1 l2 l3 r0 r1 r2 r3]
+VAD_TARGET_AVX2 inline void SplitStereoAvx2(const float *src, __m256 *l, __m256 *r) {
+    const __m256i order = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+    __m256 a = _mm256_permutevar8x32_ps(_mm256_loadu_ps(src), order);
+    __m256 b = _mm256_permutevar8x32_ps(_mm256_loadu_ps(src + 8), order);
+    *l = _mm256_permute2f128_ps(a, b, 0x20);
+    *r = _mm256_permute2f128_ps(a, b, 0x31);
+}
+
+VAD_TARGET_AVX2 void DeinterleaveStereoAvx2(const float *src, int frames, float *left,
+                                             float *right) {
+    int i = 0;
+    for (; i + 8 <= frames; i += 8) {
+        __m256 l, r;
+        SplitStereoAvx2(src + 2 * i, &l, &r);
+        _mm256_storeu_ps(left + i, l);
+        _mm256_storeu_ps(right + i, r);
+    }
+    float *dst[2] = { left + i, right + i };
+    DeinterleaveScalar(src + 2 * i, frames - i, 2, dst);
+}
+
+VAD_TARGET_AVX2 void DownmixStereoAvx2(const float *src, int frames, float *out) {
+    const __m256 half = _mm256_set1_ps(0.5f);
+    int i = 0;
+    for (; i + 8 <= frames; i += 8) {
+        __m256 l, r;
+        SplitStereoAvx2(src + 2 * i, &l, &r);
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_add_ps(l, r), half));
+    }
+    DownmixScalar(src + 2 * i, frames - i, 2, out + i);
+}
+#elif defined(VAD_ARCH_ARM64)
+void DeinterleaveStereoNeon(const float *src, int frames, float *left, float *right) {
+    int i = 0;
+    for (; i + 4 <= frames; i += 4) {
+        float32x4x2_t v = vld2q_f32(src + 2 * i);
+        vst1q_f32(left + i, v.val[0]);
+        vst1q_f32(right + i, v.val[1]);
+    }
+    float *dst[2] = { left + i, right + i };
+    DeinterleaveScalar(src + 2 * i, frames - i, 2, dst);
+}
+
+void DownmixStereoNeon(const float *src, int frames, float *out) {
+    const float32x4_t half = vdupq_n_f32(0.5f);
+    int i = 0;
+    for (; i + 4 <= frames; i += 4) {
+        float32x4x2_t v = vld2q_f32(src + 2 * i);
+        vst1q_f32(out + i, vmulq_f32(vaddq_f32(v.val[0], v.val[1]), half));
+    }
+    DownmixScalar(src + 2 * i, frames - i, 2, out + i);
+}
+#endif
+
+void DeinterleaveStereoScalar(const float *src, int frames, float *left, float *right) {
+    float *dst[2] = { left, right };
+    DeinterleaveScalar(src, frames, 2, dst);
+}
+
+void DownmixStereoScalar(const float *src, int frames, float *out) {
+    DownmixScalar(src, frames, 2, out);
+}
+
+using DeinterleaveStereoFn = void (*)(const float *, int, float *, float *);
+using DownmixStereoFn = void (*)(const float *, int, float *);
+
+DeinterleaveStereoFn SelectDeinterleaveStereo() {
+    const CpuFeatures &cpu = GetCpuFeatures();
+#if defined(VAD_ARCH_X86)
+    if (cpu.avx2) {
+        return DeinterleaveStereoAvx2;
+    }
+    if (cpu.sse41) {
+        return DeinterleaveStereoSse41;
+    }
+#elif defined(VAD_ARCH_ARM64)
+    if (cpu.neon) {
+        return DeinterleaveStereoNeon;
+    }
+#endif
+    (void)cpu;
+    return DeinterleaveStereoScalar;
+}
+
+DownmixStereoFn SelectDownmixStereo() {
+    const CpuFeatures &cpu = GetCpuFeatures();
+#if defined(VAD_ARCH_X86)
+    if (cpu.avx2) {
+        return DownmixStereoAvx2;
+    }
+    if (cpu.sse41) {
+        return DownmixStereoSse41;
+    }
+#elif defined(VAD_ARCH_ARM64)
+    if (cpu.neon) {
+        return DownmixStereoNeon;
+    }
+#endif
+    (void)cpu;
+    return DownmixStereoScalar;
+}
+
+using DotProductFn = float (*)(const float *, const float *, int);
+
+DotProductFn SelectDotProduct() {
+    const CpuFeatures &cpu = GetCpuFeatures();
+#if defined(VAD_ARCH_X86)
+    if (cpu.avx2 && cpu.fma) {
+        return DotProductAvx2;
+    }
+    if (cpu.sse41) {
+        return DotProductSse41;
+    }
+#elif defined(VAD_ARCH_ARM64)
+    if (cpu.neon) {
+        return DotProductNeon;
+    }
+#endif
+    (void)cpu;
+    return DotProductScalar;
+}
+
+// MatVec: R rows against N vectors per pass, R * N independent accumulators to hide the FMA
+// latency; each weight load is shared by the N vectors
+template <int R, int N>
+void MatVecBlockScalar(const float *w, int cols, const float *x, int x_stride, int rows,
+                       float *y) {
+    for (int r = 0; r < R; ++r) {
+        for (int j = 0; j < N; ++j) {
+            y[j * rows + r] = DotProductScalar(w + static_cast<size_t>(r) * cols,
+                                               x + static_cast<size_t>(j) * x_stride, cols);
+        }
+    }
+}
+
+#if defined(VAD_ARCH_X86)
+VAD_TARGET_AVX2_FMA inline float HorizontalSumAvx2(__m256 v) {
+    __m128 sum = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    sum = _mm_hadd_ps(sum, sum);
+    sum = _mm_hadd_ps(sum, sum);
+    return _mm_cvtss_f32(sum);
+}
+
+template <int R, int N>
+VAD_TARGET_AVX2_FMA void MatVecBlockAvx2(const float *w, int cols, const float *x, int x_stride,
+                                         int rows, float *y) {
+    __m256 acc[R][N];
+    for (int r = 0; r < R; ++r) {
+        for (int j = 0; j < N; ++j) {
+            acc[r][j] = _mm256_setzero_ps();
+        }
+    }
+    int c = 0;
+    for (; c + 8 <= cols; c += 8) {
+        __m256 xv[N];
+        for (int j = 0; j < N; ++j) {
+            xv[j] = _mm256_loadu_ps(x + static_cast<size_t>(j) * x_stride + c);
+        }
+        for (int r = 0; r < R; ++r) {
+            __m256 wv = _mm256_loadu_ps(w + static_cast<size_t>(r) * cols + c);
+            for (int j = 0; j < N; ++j) {
+                acc[r][j] = _mm256_fmadd_ps(wv, xv[j], acc[r][j]);
+            }
+        }
+    }
+    for (int r = 0; r < R; ++r) {
+        for (int j = 0; j < N; ++j) {
+            y[j * rows + r] = HorizontalSumAvx2(acc[r][j]) +
+                              DotProductScalar(w + static_cast<size_t>(r) * cols + c,
+                                               x + static_cast<size_t>(j) * x_stride + c,
+                                               cols - c);
+        }
+    }
+}
+
+// _mm512_reduce_add_ps trips -Wuninitialized in GCC 12 headers; fold to 256 bits instead
+VAD_TARGET_AVX512 inline float HorizontalSumAvx512(__m512 v) {
+    __m512d d = _mm512_castps_pd(v);
+    __m256 low = _mm256_castpd_ps(_mm512_maskz_extractf64x4_pd(0xFF, d, 0));
+    __m256 high = _mm256_castpd_ps(_mm512_maskz_extractf64x4_pd(0xFF, d, 1));
+    return HorizontalSumAvx2(_mm256_add_ps(low, high));
+}
+
+template <int R, int N>
+VAD_TARGET_AVX512 void MatVecBlockAvx512(const float *w, int cols, const float *x, int x_stride,
+                                         int rows, float *y) {
+    __m512 acc[R][N];
+    for (int r = 0; r < R; ++r) {
+        for (int j = 0; j < N; ++j) {
+            acc[r][j] = _mm512_setzero_ps();
+        }
+    }
+    for (int c = 0; c < cols; c += 16) {
+        // The tail is a masked load, zeros beyond cols
+        __mmask16 mask = cols - c >= 16 ? 0xFFFF : static_cast<__mmask16>((1u << (cols - c)) - 1);
+        __m512 xv[N];
+        for (int j = 0; j < N; ++j) {
+            xv[j] = _mm512_maskz_loadu_ps(mask, x + static_cast<size_t>(j) * x_stride + c);
+        }
+        for (int r = 0; r < R; ++r) {
+            __m512 wv = _mm512_maskz_loadu_ps(mask, w + static_cast<size_t>(r) * cols + c);
+            for (int j = 0; j < N; ++j) {
+                acc[r][j] = _mm512_fmadd_ps(wv, xv[j], acc[r][j]);
+            }
+        }
+    }
+    for (int r = 0; r < R; ++r) {
+        for (int j = 0; j < N; ++j) {
+            y[j * rows + r] = HorizontalSumAvx512(acc[r][j]);
+        }
+    }
+}
+#elif defined(VAD_ARCH_ARM64)
+template <int R, int N>
+void MatVecBlockNeon(const float *w, int cols, const float *x, int x_stride, int rows, float *y) {
+    float32x4_t acc[R][N];
+    for (int r = 0; r < R; ++r) {
+        for (int j = 0; j < N; ++j) {
+            acc[r][j] = vdupq_n_f32(0.0f);
+        }
+    }
+    int c = 0;
+    for (; c + 4 <= cols; c += 4) {
+        float32x4_t xv[N];
+        for (int j = 0; j < N; ++j) {
+            xv[j] = vld1q_f32(x + static_cast<size_t>(j) * x_stride + c);
+        }
+        for (int r = 0; r < R; ++r) {
+            float32x4_t wv = vld1q_f32(w + static_cast<size_t>(r) * cols + c);
+            for (int j = 0; j < N; ++j) {
+                acc[r][j] = vfmaq_f32(acc[r][j], wv, xv[j]);
+            }
+        }
+    }
+    for (int r = 0; r < R; ++r) {
+        for (int j = 0; j < N; ++j) {
+            y[j * rows + r] = vaddvq_f32(acc[r][j]) +
+                              DotProductScalar(w + static_cast<size_t>(r) * cols + c,
+                                               x + static_cast<size_t>(j) * x_stride + c,
+                                               cols - c);
+        }
+    }
+}
+#endif
+
+using MatVecBlockFn = void (*)(const float *, int, const float *, int, int, float *);
+
+// Blocks of 4 rows for a single vector, 2 rows for more; single rows for the remainder
+struct MatVecKernels {
+    int block_rows[5];
+    MatVecBlockFn block[5];
+    MatVecBlockFn single[5];
+};
+
+#define VAD_MATVEC_KERNELS(Block)                                                              \
+    MatVecKernels{ { 0, 4, 2, 2, 2 },                                                          \
+                   { nullptr, Block<4, 1>, Block<2, 2>, Block<2, 3>, Block<2, 4> },            \
+                   { nullptr, Block<1, 1>, Block<1, 2>, Block<1, 3>, Block<1, 4> } }
+
+MatVecKernels SelectMatVec() {
+    const CpuFeatures &cpu = GetCpuFeatures();
+#if defined(VAD_ARCH_X86)
+    if (cpu.avx512f) {
+        return VAD_MATVEC_KERNELS(MatVecBlockAvx512);
+    }
+    if (cpu.avx2 && cpu.fma) {
+        return VAD_MATVEC_KERNELS(MatVecBlockAvx2);
+    }
+#elif defined(VAD_ARCH_ARM64)
+    if (cpu.neon) {
+        return VAD_MATVEC_KERNELS(MatVecBlockNeon);
+    }
+#endif
+    (void)cpu;
+    return VAD_MATVEC_KERNELS(MatVecBlockScalar);
+}
+
+using Int16ToFloatFn = void (*)(const int16_t *, int, float *);
+
+Int16ToFloatFn SelectInt16ToFloat() {
+    const CpuFeatures &cpu = GetCpuFeatures();
+#if defined(VAD_ARCH_X86)
+    if (cpu.avx2) {
+        return Int16ToFloatAvx2;
+    }
+    if (cpu.sse41) {
+        return Int16ToFloatSse41;
+    }
+#elif defined(VAD_ARCH_ARM64)
+    if (cpu.neon) {
+        return Int16ToFloatNeon;
+    }
+#endif
+    (void)cpu;
+    return Int16ToFloatScalar;
+}
+
+// Fbank and CMVN kernels: the frame loops of the FSMN frontend
+float SumScalar(const float *x, int n) {
+    float sum = 0.0f;
+    for (int i = 0; i < n; ++i) {
+        sum += x[i];
+    }
+    return sum;
+}
+
+// Samples [begin, n), begin >= 1
+void PreemphasisWindowScalar(const float *x, int begin, int n, float offset, float coeff,
+                             const float *window, float *dst) {
+    for (int i = begin; i < n; ++i) {
+        dst[i] = ((x[i] - offset) - coeff * (x[i - 1] - offset)) * window[i];
+    }
+}
+
+void ButterfliesScalar(float *ar, float *ai, float *br, float *bi, const float *wr,
+                       const float *wi, int n) {
+    for (int j = 0; j < n; ++j) {
+        float tr = br[j] * wr[j] - bi[j] * wi[j];
+        float ti = br[j] * wi[j] + bi[j] * wr[j];
+        br[j] = ar[j] - tr;
+        bi[j] = ai[j] - ti;
+        ar[j] += tr;
+        ai[j] += ti;
+    }
+}
+
+void ShiftScaleScalar(const float *x, const float *shift, const float *scale, int n, float *dst) {
+    for (int i = 0; i < n; ++i) {
+        dst[i] = (x[i] + shift[i]) * scale[i];
+    }
+}
+
+#if defined(VAD_ARCH_X86)
+VAD_TARGET_SSE41 float SumSse41(const float *x, int n) {
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm_add_ps(acc0, _mm_loadu_ps(x + i));
+        acc1 = _mm_add_ps(acc1, _mm_loadu_ps(x + i + 4));
+    }
+    __m128 acc = _mm_add_ps(acc0, acc1);
+    acc = _mm_hadd_ps(acc, acc);
+    acc = _mm_hadd_ps(acc, acc);
+    return _mm_cvtss_f32(acc) + SumScalar(x + i, n - i);
+}
+
+VAD_TARGET_SSE41 void PreemphasisWindowSse41(const float *x, int begin, int n, float offset,
+                                             float coeff, const float *window, float *dst) {
+    const __m128 off = _mm_set1_ps(offset);
+    const __m128 c = _mm_set1_ps(coeff);
+    int i = begin;
+    for (; i + 4 <= n; i += 4) {
+        __m128 cur = _mm_sub_ps(_mm_loadu_ps(x + i), off);
+        __m128 prev = _mm_sub_ps(_mm_loadu_ps(x + i - 1), off);
+        __m128 y = _mm_sub_ps(cur, _mm_mul_ps(c, prev));
+        _mm_storeu_ps(dst + i, _mm_mul_ps(y, _mm_loadu_ps(window + i)));
+    }
+    PreemphasisWindowScalar(x, i, n, offset, coeff, window, dst);
+}
+
+VAD_TARGET_SSE41 void ButterfliesSse41(float *ar, float *ai, float *br, float *bi,
+                                       const float *wr, const float *wi, int n) {
+    int j = 0;
+    for (; j + 4 <= n; j += 4) {
+        __m128 vbr = _mm_loadu_ps(br + j), vbi = _mm_loadu_ps(bi + j);
+        __m128 vwr = _mm_loadu_ps(wr + j), vwi = _mm_loadu_ps(wi + j);
+        __m128 tr = _mm_sub_ps(_mm_mul_ps(vbr, vwr), _mm_mul_ps(vbi, vwi));
+        __m128 ti = _mm_add_ps(_mm_mul_ps(vbr, vwi), _mm_mul_ps(vbi, vwr));
+        __m128 var = _mm_loadu_ps(ar + j), vai = _mm_loadu_ps(ai + j);
+        _mm_storeu_ps(br + j, _mm_sub_ps(var, tr));
+        _mm_storeu_ps(bi + j, _mm_sub_ps(vai, ti));
+        _mm_storeu_ps(ar + j, _mm_add_ps(var, tr));
+        _mm_storeu_ps(ai + j, _mm_add_ps(vai, ti));
+    }
+    ButterfliesScalar(ar + j, ai + j, br + j, bi + j, wr + j, wi + j, n - j);
+}
+
+VAD_TARGET_SSE41 void ShiftScaleSse41(const float *x, const float *shift, const float *scale,
+                                      int n, float *dst) {
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 v = _mm_add_ps(_mm_loadu_ps(x + i), _mm_loadu_ps(shift + i));
+        _mm_storeu_ps(dst + i, _mm_mul_ps(v, _mm_loadu_ps(scale + i)));
+    }
+    ShiftScaleScalar(x + i, shift + i, scale + i, n - i, dst + i);
+}
+
+VAD_TARGET_AVX2 float SumAvx2(const float *x, int n) {
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm256_add_ps(acc0, _mm256_loadu_ps(x + i));
+        acc1 = _mm256_add_ps(acc1, _mm256_loadu_ps(x + i + 8));
+    }
+    if (i + 8 <= n) {
+        acc0 = _mm256_add_ps(acc0, _mm256_loadu_ps(x + i));
+        i += 8;
+    }
+    __m256 acc = _mm256_add_ps(acc0, acc1);
+    __m128 sum = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+    sum = _mm_hadd_ps(sum, sum);
+    sum = _mm_hadd_ps(sum, sum);
+    return _mm_cvtss_f32(sum) + SumScalar(x + i, n - i);
+}
+
+VAD_TARGET_AVX2 void PreemphasisWindowAvx2(const float *x, int begin, int n, float offset,
+                                           float coeff, const float *window, float *dst) {
+    const __m256 off = _mm256_set1_ps(offset);
+    const __m256 c = _mm256_set1_ps(coeff);
+    int i = begin;
+    for (; i + 8 <= n; i += 8) {
+        __m256 cur = _mm256_sub_ps(_mm256_loadu_ps(x + i), off);
+        __m256 prev = _mm256_sub_ps(_mm256_loadu_ps(x + i - 1), off);
+        __m256 y = _mm256_sub_ps(cur, _mm256_mul_ps(c, prev));
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(y, _mm256_loadu_ps(window + i)));
+    }
+    PreemphasisWindowScalar(x, i, n, offset, coeff, window, dst);
+}
+
+VAD_TARGET_AVX2 void ButterfliesAvx2(float *ar, float *ai, float *br, float *bi, const float *wr,
+                                     const float *wi, int n) {
+    int j = 0;
+    for (; j + 8 <= n; j += 8) {
+        __m256 vbr = _mm256_loadu_ps(br + j), vbi = _mm256_loadu_ps(bi + j);
+        __m256 vwr = _mm256_loadu_ps(wr + j), vwi = _mm256_loadu_ps(wi + j);
+        __m256 tr = _mm256_sub_ps(_mm256_mul_ps(vbr, vwr), _mm256_mul_ps(vbi, vwi));
+        __m256 ti = _mm256_add_ps(_mm256_mul_ps(vbr, vwi), _mm256_mul_ps(vbi, vwr));
+        __m256 var = _mm256_loadu_ps(ar + j), vai = _mm256_loadu_ps(ai + j);
+        _mm256_storeu_ps(br + j, _mm256_sub_ps(var, tr));
+        _mm256_storeu_ps(bi + j, _mm256_sub_ps(vai, ti));
+        _mm256_storeu_ps(ar + j, _mm256_add_ps(var, tr));
+        _mm256_storeu_ps(ai + j, _mm256_add_ps(vai, ti));
+    }
+    // The 4-wide stage of the FFT
+    ButterfliesSse41(ar + j, ai + j, br + j, bi + j, wr + j, wi + j, n - j);
+}
+
+VAD_TARGET_AVX2 void ShiftScaleAvx2(const float *x, const float *shift, const float *scale, int n,
+                                    float *dst) {
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 v = _mm256_add_ps(_mm256_loadu_ps(x + i), _mm256_loadu_ps(shift + i));
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(v, _mm256_loadu_ps(scale + i)));
+    }
+    ShiftScaleScalar(x + i, shift + i, scale + i, n - i, dst + i);
+}
+#elif defined(VAD_ARCH_ARM64)
+float SumNeon(const float *x, int n) {
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = vaddq_f32(acc0, vld1q_f32(x + i));
+        acc1 = vaddq_f32(acc1, vld1q_f32(x + i + 4));
+    }
+    return vaddvq_f32(vaddq_f32(acc0, acc1)) + SumScalar(x + i, n - i);
+}
+
+void PreemphasisWindowNeon(const float *x, int begin, int n, float offset, float coeff,
+                           const float *window, float *dst) {
+    const float32x4_t off = vdupq_n_f32(offset);
+    int i = begin;
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t cur = vsubq_f32(vld1q_f32(x + i), off);
+        float32x4_t prev = vsubq_f32(vld1q_f32(x + i - 1), off);
+        float32x4_t y = vmlsq_n_f32(cur, prev, coeff);
+        vst1q_f32(dst + i, vmulq_f32(y, vld1q_f32(window + i)));
+    }
+    PreemphasisWindowScalar(x, i, n, offset, coeff, window, dst);
+}
+
+void ButterfliesNeon(float *ar, float *ai, float *br, float *bi, const float *wr, const float *wi,
+                     int n) {
+    int j = 0;
+    for (; j + 4 <= n; j += 4) {
+        float32x4_t vbr = vld1q_f32(br + j), vbi = vld1q_f32(bi + j);
+        float32x4_t vwr = vld1q_f32(wr + j), vwi = vld1q_f32(wi + j);
+        float32x4_t tr = vmlsq_f32(vmulq_f32(vbr, vwr), vbi, vwi);
+        float32x4_t ti = vmlaq_f32(vmulq_f32(vbr, vwi), vbi, vwr);
+        float32x4_t var = vld1q_f32(ar + j), vai = vld1q_f32(ai + j);
+        vst1q_f32(br + j, vsubq_f32(var, tr));
+        vst1q_f32(bi + j, vsubq_f32(vai, ti));
+        vst1q_f32(ar + j, vaddq_f32(var, tr));
+        vst1q_f32(ai + j, vaddq_f32(vai, ti));
+    }
+    ButterfliesScalar(ar + j, ai + j, br + j, bi + j, wr + j, wi + j, n - j);
+}
+
+void ShiftScaleNeon(const float *x, const float *shift, const float *scale, int n, float *dst) {
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t v = vaddq_f32(vld1q_f32(x + i), vld1q_f32(shift + i));
+        vst1q_f32(dst + i, vmulq_f32(v, vld1q_f32(scale + i)));
+    }
+    ShiftScaleScalar(x + i, shift + i, scale + i, n - i, dst + i);
+}
+#endif
+
+using SumFn = float (*)(const float *, int);
+using PreemphasisWindowFn = void (*)(const float *, int, int, float, float, const float *,
+                                     float *);
+using ButterfliesFn = void (*)(float *, float *, float *, float *, const float *, const float *,
+                               int);
+using ShiftScaleFn = void (*)(const float *, const float *, const float *, int, float *);
+
+// The frontend kernels share one ISA choice
+struct FrontendKernels {
+    SumFn sum;
+    PreemphasisWindowFn preemphasis_window;
+    ButterfliesFn butterflies;
+    ShiftScaleFn shift_scale;
+};
+
+#define VAD_FRONTEND_KERNELS(Isa)                                                              \
+    FrontendKernels{ Sum##Isa, PreemphasisWindow##Isa, Butterflies##Isa, ShiftScale##Isa }
+
+FrontendKernels SelectFrontend() {
+    const CpuFeatures &cpu = GetCpuFeatures();
+#if defined(VAD_ARCH_X86)
+    if (cpu.avx2) {
+        return VAD_FRONTEND_KERNELS(Avx2);
+    }
+    if (cpu.sse41) {
+        return VAD_FRONTEND_KERNELS(Sse41);
+    }
+#elif defined(VAD_ARCH_ARM64)
+    if (cpu.neon) {
+        return VAD_FRONTEND_KERNELS(Neon);
+    }
+#endif
+    (void)cpu;
+    return VAD_FRONTEND_KERNELS(Scalar);
+}
+
+const FrontendKernels &Frontend() {
+    static const FrontendKernels kernels = SelectFrontend();
+    return kernels;
+}
+
+} // namespace
+
+void Int16ToFloat(const int16_t *src, int n, float *dst) {
+    static const Int16ToFloatFn fn = SelectInt16ToFloat();
+    fn(src, n, dst);
+}
+
+float DotProduct(const float *a, const float *b, int n) {
+    static const DotProductFn fn = SelectDotProduct();
+    return fn(a, b, n);
+}
+
+void MatVec(const float *w, int rows, int cols, const float *x, int x_stride, int num_x,
+            float *y) {
+    static const MatVecKernels kernels = SelectMatVec();
+    int step = kernels.block_rows[num_x];
+    int r = 0;
+    for (; r + step <= rows; r += step) {
+        kernels.block[num_x](w + static_cast<size_t>(r) * cols, cols, x, x_stride, rows, y + r);
+    }
+    for (; r < rows; ++r) {
+        kernels.single[num_x](w + static_cast<size_t>(r) * cols, cols, x, x_stride, rows, y + r);
+    }
+}
+
+void Deinterleave(const float *src, int frames, int channels, float *const *dst) {
+    static const DeinterleaveStereoFn stereo = SelectDeinterleaveStereo();
+    if (channels == 2) {
+        stereo(src, frames, dst[0], dst[1]);
+    } else {
+        DeinterleaveScalar(src, frames, channels, dst);
+    }
+}
+
+void Downmix(const float *src, int frames, int channels, float *dst) {
+    static const DownmixStereoFn stereo = SelectDownmixStereo();
+    if (channels == 2) {
+        stereo(src, frames, dst);
+    } else {
+        DownmixScalar(src, frames, channels, dst);
+    }
+}
+
+float Sum(const float *x, int n) { return Frontend().sum(x, n); }
+
+void PreemphasisWindow(const float *x, int n, float offset, float coeff, const float *window,
+                       float *dst) {
+    if (n <= 0) {
+        return;
+    }
+    dst[0] = (x[0] - offset) * (1.0f - coeff) * window[0];
+    Frontend().preemphasis_window(x, 1, n, offset, coeff, window, dst);
+}
+
+void Butterflies(float *ar, float *ai, float *br, float *bi, const float *wr, const float *wi,
+                 int n) {
+    Frontend().butterflies(ar, ai, br, bi, wr, wi, n);
+}
+
+void ShiftScale(const float *x, const float *shift, const float *scale, int n, float *dst) {
+    Frontend().shift_scale(x, shift, scale, n, dst);
+}
+
+} // namespace VadFilterOnnx
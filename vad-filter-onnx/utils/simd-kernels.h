@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+
+namespace VadFilterOnnx {
+
+// Vectorized helpers for the decode path. Each kernel picks the widest implementation the CPU
+// supports at first use (AVX2, SSE4.1/NEON, scalar).
+
+// dst[i] = src[i] / 32768, exact on all paths
+void Int16ToFloat(const int16_t *src, int n, float *dst);
+
+// sum(a[i] * b[i]); the summation order, and so the rounding, depends on the path
+float DotProduct(const float *a, const float *b, int n);
+
+// Matrix times up to 4 vectors: y[j * rows + r] = dot(w + r * cols, x + j * x_stride) for
+// j < num_x. w is row-major; the vectors may overlap (x_stride < cols), e.g. sliding windows.
+// AVX-512 and AVX2 paths; the summation order depends on the path.
+void MatVec(const float *w, int rows, int cols, const float *x, int x_stride, int num_x, float *y);
+
+// Split `frames` interleaved frames of `channels` samples into one buffer per channel
+void Deinterleave(const float *src, int frames, int channels, float *const *dst);
+
+// dst[i] = mean of the channels of frame i
+void Downmix(const float *src, int frames, int channels, float *dst);
+
+// sum(x[i]); the summation order, and so the rounding, depends on the path
+float Sum(const float *x, int n);
+
+// Kaldi pre-emphasis and window of a DC-shifted frame: y[i] = x[i] - offset,
+// dst[i] = (y[i] - coeff * y[i - 1]) * window[i], with y[-1] = y[0]
+void PreemphasisWindow(const float *x, int n, float offset, float coeff, const float *window,
+                       float *dst);
+
+// n radix-2 butterflies on split complex data: t = b[i] * w[i], b[i] = a[i] - t, a[i] += t.
+// The twiddles w are contiguous.
+void Butterflies(float *ar, float *ai, float *br, float *bi, const float *wr, const float *wi,
+                 int n);
+
+// dst[i] = (x[i] + shift[i]) * scale[i], exact on all paths
+void ShiftScale(const float *x, const float *shift, const float *scale, int n, float *dst);
+
+} // namespace VadFilterOnnx
@@ -0,0 +1,150 @@
+#include "utils/wave-reader.h"
+#include "utils/simd-kernels.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace VadFilterOnnx {
+
+static constexpr int kFormatPcm = 1;
+static constexpr int kFormatFloat = 3;
+static constexpr int kFormatExtensible = 0xFFFE;
+
+// Pages are released once this much has been read past the last release
+static constexpr size_t kReleaseBytes = 1 << 20;
+
+static uint16_t read_u16(const uint8_t *p) { return static_cast<uint16_t>(p[0] | p[1] << 8); }
+
+static uint32_t read_u32(const uint8_t *p) {
+    return p[0] | p[1] << 8 | p[2] << 16 | static_cast<uint32_t>(p[3]) << 24;
+}
+
+std::unique_ptr<WaveReader> WaveReader::open(const std::string &path) {
+    std::unique_ptr<WaveReader> reader(new WaveReader());
+    reader->file_ = MappedFile::open(path);
+    if (!reader->file_) {
+        return nullptr;
+    }
+    const uint8_t *p = static_cast<const uint8_t *>(reader->file_->data());
+    size_t size = reader->file_->size();
+    if (size < 12 || memcmp(p, "RIFF", 4) != 0 || memcmp(p + 8, "WAVE", 4) != 0) {
+        printf("ERROR: %s is not a WAV file\n", path.c_str());
+        return nullptr;
+    }
+    int format = 0;
+    int bits = 0;
+    bool has_fmt = false;
+    size_t pos = 12;
+    while (pos + 8 <= size) {
+        const uint8_t *body = p + pos + 8;
+        // Writers that could not seek back leave the size of the last chunk at 0 or ~0; ~0 is
+        // clamped here, an empty data chunk is taken to run to the end of the file below
+        size_t body_size = std::min<size_t>(read_u32(p + pos + 4), size - pos - 8);
+        if (memcmp(p + pos, "fmt ", 4) == 0 && body_size >= 16) {
+            format = read_u16(body);
+            reader->num_channels_ = read_u16(body + 2);
+            reader->sample_rate_ = static_cast<int>(read_u32(body + 4));
+            bits = read_u16(body + 14);
+            // WAVE_FORMAT_EXTENSIBLE: the actual format is the first field of the subformat GUID
+            if (format == kFormatExtensible && body_size >= 40) {
+                format = read_u16(body + 24);
+            }
+            has_fmt = true;
+        } else if (memcmp(p + pos, "data", 4) == 0) {
+            if (!has_fmt || reader->num_channels_ == 0 || reader->sample_rate_ <= 0) {
+                printf("ERROR: %s has no valid fmt chunk before the data\n", path.c_str());
+                return nullptr;
+            }
+            if (format == kFormatPcm && bits == 8) {
+                reader->format_ = Format::Pcm8;
+            } else if (format == kFormatPcm && bits == 16) {
+                reader->format_ = Format::Pcm16;
+            } else if (format == kFormatPcm && bits == 24) {
+                reader->format_ = Format::Pcm24;
+            } else if (format == kFormatPcm && bits == 32) {
+                reader->format_ = Format::Pcm32;
+            } else if (format == kFormatFloat && bits == 32) {
+                reader->format_ = Format::Float32;
+            } else if (format == kFormatFloat && bits == 64) {
+                reader->format_ = Format::Float64;
+            } else {
+                printf("ERROR: %s: unsupported WAV format %d with %d bits\n", path.c_str(),
+                       format, bits);
+                return nullptr;
+            }
+            if (body_size == 0) {
+                body_size = size - pos - 8;
+            }
+            reader->bytes_per_sample_ = bits / 8;
+            reader->data_ = body;
+            reader->data_offset_ = pos + 8;
+            reader->num_frames_ = static_cast<int64_t>(
+                body_size / (static_cast<size_t>(reader->bytes_per_sample_) * reader->num_channels_));
+            return reader;
+        }
+        // Chunks are padded to an even size
+        pos += 8 + body_size + (body_size & 1);
+    }
+    printf("ERROR: %s has no data chunk\n", path.c_str());
+    return nullptr;
+}
+
+int WaveReader::read(float *out, int max_frames) {
+    int num_frames = static_cast<int>(std::min<int64_t>(max_frames, num_frames_ - position_));
+    if (num_frames <= 0) {
+        return 0;
+    }
+    size_t frame_bytes = static_cast<size_t>(bytes_per_sample_) * num_channels_;
+    const uint8_t *src = data_ + position_ * frame_bytes;
+    int n = num_frames * num_channels_;
+    // Samples are only 2-byte aligned in the file, so wider ones are assembled bytewise
+    switch (format_) {
+    case Format::Pcm8:
+        for (int i = 0; i < n; ++i) {
+            out[i] = (src[i] - 128) * (1.0f / 128.0f);
+        }
+        break;
+    case Format::Pcm16:
+        Int16ToFloat(reinterpret_cast<const int16_t *>(src), n, out);
+        break;
+    case Format::Pcm24:
+        for (int i = 0; i < n; ++i) {
+            const uint8_t *s = src + 3 * i;
+            int32_t v = static_cast<int32_t>(static_cast<uint32_t>(s[0]) << 8 |
+                                             static_cast<uint32_t>(s[1]) << 16 |
+                                             static_cast<uint32_t>(s[2]) << 24);
+            out[i] = (v >> 8) * (1.0f / 8388608.0f);
+        }
+        break;
+    case Format::Pcm32:
+        for (int i = 0; i < n; ++i) {
+            out[i] = static_cast<int32_t>(read_u32(src + 4 * i)) * (1.0f / 2147483648.0f);
+        }
+        break;
+    case Format::Float32:
+        memcpy(out, src, static_cast<size_t>(n) * sizeof(float));
+        break;
+    case Format::Float64:
+        for (int i = 0; i < n; ++i) {
+            double v;
+            memcpy(&v, src + 8 * i, sizeof(v));
+            out[i] = static_cast<float>(v);
+        }
+        break;
+    }
+    position_ += num_frames;
+
+    if (static_cast<size_t>(position_ - released_) * frame_bytes >= kReleaseBytes) {
+        file_->release(data_offset_ + released_ * frame_bytes,
+                       (position_ - released_) * frame_bytes);
+        released_ = position_;
+    }
+    return num_frames;
+}
+
+void WaveReader::seek(int64_t frame) {
+    position_ = std::clamp<int64_t>(frame, 0, num_frames_);
+    released_ = position_;
+}
+
+} // namespace VadFilterOnnx
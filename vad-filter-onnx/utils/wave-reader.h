@@ -0,0 +1,50 @@
+#pragma once
+#include "utils/mapped-file.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace VadFilterOnnx {
+
+// Streaming WAV reader over a memory mapping of the file. read() converts the next frames
+// straight from the mapping into a caller-supplied block and releases the pages already read,
+// so memory use stays constant regardless of the file length.
+//
+// The RIFF chunks are walked for "fmt " and "data"; others (LIST, fact, cue...) are skipped.
+// Supports PCM with 8 (unsigned), 16, 24 and 32 bits, IEEE float with 32 and 64 bits, and
+// WAVE_FORMAT_EXTENSIBLE with a PCM or float subformat.
+class WaveReader {
+  public:
+    enum class Format { Pcm8, Pcm16, Pcm24, Pcm32, Float32, Float64 };
+
+    // Returns nullptr (with an error message) if the file cannot be mapped or parsed
+    static std::unique_ptr<WaveReader> open(const std::string &path);
+
+    int sample_rate() const { return sample_rate_; }
+    int num_channels() const { return num_channels_; }
+    int64_t num_frames() const { return num_frames_; }
+    Format format() const { return format_; }
+
+    // Convert up to max_frames frames from the read position into `out` (interleaved, full
+    // scale +-1, max_frames * num_channels() floats). Returns the number of frames read, 0 at
+    // the end of the data.
+    int read(float *out, int max_frames);
+    void seek(int64_t frame);
+    int64_t position() const { return position_; }
+
+  private:
+    WaveReader() = default;
+
+    std::shared_ptr<MappedFile> file_;
+    const uint8_t *data_ = nullptr; // first sample in the mapping
+    size_t data_offset_ = 0;        // of data_ in the file
+    int64_t num_frames_ = 0;
+    int64_t position_ = 0;
+    int64_t released_ = 0;          // frames whose pages were released
+    int num_channels_ = 0;
+    int sample_rate_ = 0;
+    int bytes_per_sample_ = 0;
+    Format format_ = Format::Pcm16;
+};
+
+} // namespace VadFilterOnnx
@@ -0,0 +1,84 @@
+#include "vad/audio-framer.h"
+#include <algorithm>
+#include <cstring>
+
+namespace VadFilterOnnx {
+
+AudioFramer::AudioFramer(int frame_length, int frame_shift, int capacity)
+    : frame_length_(frame_length), frame_shift_(frame_shift) {
+    carry_.resize(std::max(capacity, frame_length));
+    stitch_.resize(frame_length);
+}
+
+void AudioFramer::push(const float *data, int n) {
+    chunk_ = data;
+    chunk_n_ = std::max(0, n);
+}
+
+const float *AudioFramer::next() {
+    if (pos_ + frame_length_ > carry_len_ + chunk_n_) {
+        return nullptr;
+    }
+    const float *frame;
+    if (pos_ >= carry_len_) {
+        frame = chunk_ + (pos_ - carry_len_);
+    } else if (pos_ + frame_length_ <= carry_len_) {
+        frame = carry_.data() + pos_;
+    } else {
+        // Only the frame that straddles the carry/chunk boundary is copied
+        int head = carry_len_ - pos_;
+        std::memcpy(stitch_.data(), carry_.data() + pos_, head * sizeof(float));
+        std::memcpy(stitch_.data() + head, chunk_, (frame_length_ - head) * sizeof(float));
+        frame = stitch_.data();
+    }
+    pos_ += frame_shift_;
+    return frame;
+}
+
+const float *AudioFramer::peek(int lookahead, int *len) {
+    if (pos_ >= carry_len_) {
+        *len = carry_len_ + chunk_n_ - pos_;
+        return chunk_ + (pos_ - carry_len_);
+    }
+    int head = carry_len_ - pos_;
+    int take = std::min(chunk_n_, std::max(0, lookahead));
+    if (static_cast<int>(stitch_.size()) < head + take) {
+        stitch_.resize(head + take);
+    }
+    std::memcpy(stitch_.data(), carry_.data() + pos_, head * sizeof(float));
+    if (take > 0) {
+        std::memcpy(stitch_.data() + head, chunk_, take * sizeof(float));
+    }
+    *len = head + take;
+    return stitch_.data();
+}
+
+void AudioFramer::stash() {
+    int rem = std::max(0, available());
+    if (static_cast<int>(carry_.size()) < rem) {
+        // Only reached if the caller consumes less than the configured capacity allows
+        carry_.resize(rem);
+    }
+    if (pos_ < carry_len_) {
+        int head = carry_len_ - pos_;
+        std::memmove(carry_.data(), carry_.data() + pos_, head * sizeof(float));
+        if (chunk_n_ > 0) {
+            std::memcpy(carry_.data() + head, chunk_, chunk_n_ * sizeof(float));
+        }
+    } else if (rem > 0) {
+        std::memcpy(carry_.data(), chunk_ + (pos_ - carry_len_), rem * sizeof(float));
+    }
+    carry_len_ = rem;
+    pos_ = 0;
+    chunk_ = nullptr;
+    chunk_n_ = 0;
+}
+
+void AudioFramer::reset() {
+    carry_len_ = 0;
+    pos_ = 0;
+    chunk_ = nullptr;
+    chunk_n_ = 0;
+}
+
+} // namespace VadFilterOnnx
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <vector>
+
+namespace VadFilterOnnx {
+
+/**
+ * @brief Hands out contiguous frame views over a stream of audio chunks.
+ *
+ * Samples left over from the previous chunk are kept in a fixed-capacity carry buffer. A frame
+ * that straddles the carry/chunk boundary is stitched into a small buffer; every other frame
+ * is a view into the caller's chunk, so a chunk is never copied as a whole.
+ *
+ * Usage per chunk: push(), then next() (or peek()/consume()) until exhausted, then stash().
+ */
+class AudioFramer {
+  public:
+    // capacity: max samples carried between chunks, at least frame_length - 1
+    AudioFramer(int frame_length, int frame_shift, int capacity = 0);
+
+    void push(const float *data, int n);
+
+    // Next frame of frame_length samples, advancing by frame_shift. nullptr if none is complete.
+    const float *next();
+
+    // Contiguous samples from the read position. While carried samples remain, up to
+    // `lookahead` samples of the chunk are stitched behind them; afterwards this is a view of
+    // the rest of the chunk.
+    const float *peek(int lookahead, int *len);
+    void consume(int n) { pos_ += n; }
+
+    // Samples from the read position to the end of the chunk
+    int available() const { return carry_len_ + chunk_n_ - pos_; }
+
+    // Keep the unconsumed tail for the next chunk and release the current one
+    void stash();
+    void reset();
+
+    // Samples carried over between chunks
+    int buffered() const { return carry_len_; }
+
+  private:
+    int frame_length_;
+    int frame_shift_;
+    std::vector<float> carry_;
+    std::vector<float> stitch_;
+    int carry_len_ = 0;
+    const float *chunk_ = nullptr;
+    int chunk_n_ = 0;
+    int pos_ = 0; // read position in carry_ followed by chunk_
+};
+
+} // namespace VadFilterOnnx
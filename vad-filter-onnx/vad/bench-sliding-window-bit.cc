@@ -0,0 +1,48 @@
+#include "sliding-window-bit.h"
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+using namespace VadFilterOnnx;
+using Clock = std::chrono::steady_clock;
+
+// Per-frame cost of the detector queries as VadModel issues them, for growing window lengths.
+// With tracked windows the cost should stay flat; untracked checks scan the window words.
+static double bench(size_t window, bool tracked, int num_frames) {
+    SlidingWindowBit sw(window);
+    size_t speech_window = window / 2 + 1;
+    if (tracked) {
+        sw.track(speech_window);
+        sw.track(window);
+    }
+    std::vector<bool> frames(num_frames);
+    uint32_t state = 1;
+    for (int i = 0; i < num_frames; ++i) {
+        state = state * 1664525u + 1013904223u;
+        frames[i] = (i / 200) % 2 ? (state >> 28) != 0 : (state >> 28) == 0;
+    }
+
+    size_t sink = 0;
+    auto t0 = Clock::now();
+    for (int i = 0; i < num_frames; ++i) {
+        sw.push(frames[i]);
+        sink += sw.check_speech(speech_window, speech_window * 5 / 6);
+        sink += sw.check_silence(window, window * 5 / 6);
+        sink += sw.num_right_ones() + sw.num_right_zeros();
+    }
+    double ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+    if (sink == 42) {
+        printf(" ");
+    }
+    return ns / num_frames;
+}
+
+int main() {
+    const int num_frames = 2000000;
+    printf("%10s %14s %14s\n", "window", "tracked ns", "untracked ns");
+    for (size_t window : { 16, 64, 150, 300, 1000, 3000 }) {
+        printf("%10zu %14.2f %14.2f\n", window, bench(window, true, num_frames),
+               bench(window, false, num_frames));
+    }
+    return 0;
+}
@@ -0,0 +1,49 @@
+#include "vad/fsmn-frontend.h"
+#include "utils/simd-kernels.h"
+#include <algorithm>
+
+namespace VadFilterOnnx {
+
+FsmnFrontend::FsmnFrontend(int sample_rate, std::shared_ptr<const std::vector<float>> cmvn)
+    : fbank_(sample_rate), cmvn_(std::move(cmvn)) {
+    scaled_.resize(fbank_.frame_length());
+    history_.resize(static_cast<size_t>(kLfrM) * fbank_.dim());
+}
+
+void FsmnFrontend::accept(const float *frame, std::vector<float> *feats) {
+    // The export scales the waveform to the int16 range before the fbank
+    for (int i = 0; i < fbank_.frame_length(); ++i) {
+        scaled_[i] = frame[i] * 32768.0f;
+    }
+    int slot = num_frames_ % kLfrM;
+    fbank_.compute(scaled_.data(), history_.data() + static_cast<size_t>(slot) * fbank_.dim());
+    num_frames_++;
+
+    int t = num_frames_ - 1 - kLfrM / 2;
+    if (t >= 0) {
+        emit(t, num_frames_ - 1, feats);
+    }
+}
+
+void FsmnFrontend::finish(std::vector<float> *feats) {
+    for (int t = std::max(0, num_frames_ - kLfrM / 2); t < num_frames_; ++t) {
+        emit(t, num_frames_ - 1, feats);
+    }
+    reset();
+}
+
+void FsmnFrontend::emit(int t, int last, std::vector<float> *feats) {
+    int mel = fbank_.dim();
+    const float *shift = cmvn_->data();
+    const float *scale = cmvn_->data() + dim();
+    size_t offset = feats->size();
+    feats->resize(offset + dim());
+    float *out = feats->data() + offset;
+    for (int j = 0; j < kLfrM; ++j) {
+        int frame = std::clamp(t - kLfrM / 2 + j, 0, last);
+        const float *src = history_.data() + static_cast<size_t>(frame % kLfrM) * mel;
+        ShiftScale(src, shift + j * mel, scale + j * mel, mel, out + j * mel);
+    }
+}
+
+} // namespace VadFilterOnnx
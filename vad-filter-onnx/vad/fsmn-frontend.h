@@ -0,0 +1,46 @@
+#pragma once
+
+#include "utils/fbank.h"
+#include <memory>
+#include <vector>
+
+namespace VadFilterOnnx {
+
+/**
+ * @brief Streaming FSMN-VAD feature frontend: fbank -> LFR -> CMVN.
+ *
+ * Computes what the StreamingFbankLFR module of scripts/export_onnx_fsmn_vad.py computes in
+ * the graph, for models exported with --backbone-only. Every fbank frame is computed exactly
+ * once; the last lfr_m frames are kept, so no context is recomputed across chunks.
+ *
+ * LFR output t stacks fbank frames t - 2 .. t + 2, replicating the first and the last frame at
+ * the stream edges (the graph's first_padding = last_padding = 2). Output t is therefore ready
+ * once fbank frame t + 2 arrives, or when the input ends.
+ */
+class FsmnFrontend {
+  public:
+    static constexpr int kLfrM = 5;
+
+    // cmvn: 2 * dim() values, the shift followed by the scale, applied as (x + shift) * scale
+    FsmnFrontend(int sample_rate, std::shared_ptr<const std::vector<float>> cmvn);
+
+    int frame_length() const { return fbank_.frame_length(); }
+    int dim() const { return kLfrM * fbank_.dim(); }
+
+    // One frame of frame_length() samples in [-1, 1]; appends the outputs it completes to *feats
+    void accept(const float *frame, std::vector<float> *feats);
+    // End of input: appends the remaining outputs and resets
+    void finish(std::vector<float> *feats);
+    void reset() { num_frames_ = 0; }
+
+  private:
+    void emit(int t, int last, std::vector<float> *feats);
+
+    Fbank fbank_;
+    std::shared_ptr<const std::vector<float>> cmvn_;
+    std::vector<float> scaled_;
+    std::vector<float> history_; // fbank frame i at slot i % kLfrM
+    int num_frames_ = 0;         // fbank frames since reset
+};
+
+} // namespace VadFilterOnnx
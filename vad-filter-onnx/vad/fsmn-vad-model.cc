@@ -1,6 +1,8 @@
 #include "vad/fsmn-vad-model.h"
 #include "utils/onnx-common.h"
 #include <algorithm>
+#include <climits>
+#include <cstdlib>
 #include <string_view>
 
 namespace VadFilterOnnx {
@@ -21,70 +23,176 @@ bool is_fsmn_vad(const std::vector<const char *> &input_names,
     return false;
 }
 
+bool is_fsmn_vad_backbone(const std::vector<const char *> &input_names,
+                          const std::vector<const char *> &output_names) {
+    return input_names.size() == 5 && output_names.size() == 5 &&
+           std::string_view(input_names[0]) == "feats" &&
+           std::string_view(input_names[1]) == "in_cache0" &&
+           std::string_view(input_names[2]) == "in_cache1" &&
+           std::string_view(input_names[3]) == "in_cache2" &&
+           std::string_view(input_names[4]) == "in_cache3" &&
+           std::string_view(output_names[0]) == "logits";
+}
+
+FsmnVadModel::FsmnVadModel(const VadModel &other, const VadConfig &config, int fs, int fl)
+    : VadModel(other, config, fs, fl) {
+    const auto &handle = static_cast<const FsmnVadModel &>(other);
+    cmvn_ = handle.cmvn_;
+    frontend_sample_rate_ = handle.frontend_sample_rate_;
+    if (cmvn_) {
+        // Features are cached by the frontend, the framer only carries a partial frame
+        frontend_ = std::make_unique<FsmnFrontend>(config.sample_rate, cmvn_);
+        feats_.reserve(static_cast<size_t>(frontend_->dim()) * 16);
+    } else {
+        // Carries up to 100ms while waiting for the first inference, 55ms context afterwards
+        int capacity = 100 * samples_per_ms_ + 3 * frame_shift_ + frame_length_;
+        framer_ = std::make_unique<AudioFramer>(frame_length_, frame_shift_, capacity);
+    }
+}
+
+bool FsmnVadModel::load_frontend(const std::shared_ptr<Ort::Session> &session) {
+    frontend_sample_rate_ = std::atoi(GetCustomMetadata(session, "sample_rate").c_str());
+    std::vector<float> cmvn;
+    for (const char *key : { "cmvn_shift", "cmvn_scale" }) {
+        std::string value = GetCustomMetadata(session, key);
+        const char *p = value.c_str();
+        char *end = nullptr;
+        for (float v = std::strtof(p, &end); end != p; v = std::strtof(p, &end)) {
+            cmvn.push_back(v);
+            p = *end == ',' ? end + 1 : end;
+        }
+    }
+    int dim = FsmnFrontend::kLfrM * 80;
+    if (cmvn.size() != static_cast<size_t>(2 * dim) ||
+        (frontend_sample_rate_ != 8000 && frontend_sample_rate_ != 16000)) {
+        printf("ERROR: FSMN backbone model needs sample_rate and %d-dim cmvn_shift/cmvn_scale "
+               "metadata, got %d and %zu values\n",
+               dim, frontend_sample_rate_, cmvn.size());
+        return false;
+    }
+    cmvn_ = std::make_shared<const std::vector<float>>(std::move(cmvn));
+    return true;
+}
+
 std::unique_ptr<VadModel> FsmnVadModel::init(const VadConfig &config) {
+    if (!check_config(config)) {
+        return nullptr;
+    }
+    if (cmvn_ && config.sample_rate != frontend_sample_rate_) {
+        printf("ERROR: FSMN backbone model was exported for %d Hz, sample_rate is %d\n",
+               frontend_sample_rate_, config.sample_rate);
+        return nullptr;
+    }
+    if (config.enable_energy_gate) {
+        printf("WARNING: energy gate is not supported by FSMN VAD, ignored\n");
+    }
+    if (config.enable_adaptive_stride) {
+        printf("WARNING: adaptive stride is not supported by FSMN VAD, ignored\n");
+    }
     int samples_per_ms = config.sample_rate / 1000;
     int frame_shift = 10 * samples_per_ms;
     int frame_length = 25 * samples_per_ms;
     auto instance = std::make_unique<FsmnVadModel>(*this, config, frame_shift, frame_length);
     instance->reset();
+    instance->warmup();
     return instance;
 }
 
 void FsmnVadModel::init_state() {
     is_first_inference_ = true;
-    caches_.clear();
-    reminder_.clear(); // Ensure reminder buffer is cleared on state reset
-    for (int i = 0; i < 4; ++i) {
-        caches_.emplace_back(
-            Ort::Value::CreateTensor<float>(allocator_, cache_shape_.data(), cache_shape_.size()));
-        Fill<float>(&caches_.back(), 0.0f);
+    if (frontend_) {
+        frontend_->reset();
     }
+    if (inputs_[0].empty()) {
+        std::array<int64_t, 1> p_shape = { 1 };
+        for (int k = 0; k < 2; ++k) {
+            cache_data_[k].resize(4 * cache_size_);
+        }
+        for (int k = 0; k < 2; ++k) {
+            // Inputs: speech, in_cache0..3, first_padding, last_padding
+            inputs_[k].emplace_back(nullptr);
+            for (int i = 0; i < 4; ++i) {
+                inputs_[k].push_back(WrapTensor(cache_data_[k].data() + i * cache_size_,
+                                                cache_size_, cache_shape_.data(),
+                                                cache_shape_.size()));
+            }
+            // Padding parameters are passed as 0-dimensional tensors (scalars); the backbone
+            // model gets padded features instead
+            if (!cmvn_) {
+                inputs_[k].push_back(WrapTensor(&first_padding_, 1, p_shape.data(), 0));
+                inputs_[k].push_back(WrapTensor(&last_padding_, 1, p_shape.data(), 0));
+            }
+
+            // Outputs: logits (allocated by ORT), out_cache0..3 written into the other buffer
+            outputs_[k].emplace_back(nullptr);
+            for (int i = 0; i < 4; ++i) {
+                outputs_[k].push_back(WrapTensor(cache_data_[1 - k].data() + i * cache_size_,
+                                                 cache_size_, cache_shape_.data(),
+                                                 cache_shape_.size()));
+            }
+        }
+    }
+    cur_ = 0;
+    std::fill(cache_data_[cur_].begin(), cache_data_[cur_].end(), 0.0f);
 }
 
-std::vector<float> FsmnVadModel::forward_frames(float *data, int n, int64_t first_p,
-                                                int64_t last_p) {
-    auto memory_info = Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
+const std::vector<float> &FsmnVadModel::forward_frames(const float *data, int n,
+                                                       int64_t first_p, int64_t last_p) {
     std::array<int64_t, 2> speech_shape = { 1, n };
-    Ort::Value speech =
-        Ort::Value::CreateTensor(memory_info, data, n, speech_shape.data(), speech_shape.size());
-
-    std::array<int64_t, 1> p_shape = { 1 };
-    // Padding parameters are passed as 0-dimensional tensors (scalars)
-    Ort::Value first_padding =
-        Ort::Value::CreateTensor<int64_t>(memory_info, &first_p, 1, p_shape.data(), 0);
-    Ort::Value last_padding =
-        Ort::Value::CreateTensor<int64_t>(memory_info, &last_p, 1, p_shape.data(), 0);
+    auto &inputs = inputs_[cur_];
+    auto &outputs = outputs_[cur_];
+    // ORT does not write to inputs
+    inputs[0] = WrapTensor(const_cast<float *>(data), n, speech_shape.data(), speech_shape.size());
+    first_padding_ = first_p;
+    last_padding_ = last_p;
 
-    std::vector<Ort::Value> inputs;
-    inputs.push_back(std::move(speech));
-    for (int i = 0; i < 4; ++i) {
-        inputs.push_back(std::move(caches_[i]));
+    uint64_t begin_ns = stats_ ? StatsClockNs() : 0;
+    session_->Run(Ort::RunOptions{ nullptr }, input_names_.data(), inputs.data(), inputs.size(),
+                  output_names_.data(), outputs.data(), outputs.size());
+    if (stats_) {
+        stats_delta_.add_inference(StatsClockNs() - begin_ns);
     }
-    inputs.push_back(std::move(first_padding));
-    inputs.push_back(std::move(last_padding));
 
-    auto out = session_->Run(Ort::RunOptions{ nullptr }, input_names_.data(), inputs.data(),
-                             inputs.size(), output_names_.data(), output_names_.size());
+    // Caches for the next streaming chunk were written into the other buffer
+    cur_ = 1 - cur_;
+    return read_logits(outputs[0]);
+}
+
+const std::vector<float> &FsmnVadModel::forward_features(const float *feats, int num_frames) {
+    std::array<int64_t, 3> feats_shape = { 1, num_frames, frontend_->dim() };
+    auto &inputs = inputs_[cur_];
+    auto &outputs = outputs_[cur_];
+    inputs[0] = WrapTensor(const_cast<float *>(feats),
+                           static_cast<size_t>(num_frames) * frontend_->dim(), feats_shape.data(),
+                           feats_shape.size());
 
-    // Update internal caches for the next streaming chunk
-    for (int i = 0; i < 4; ++i) {
-        caches_[i] = std::move(out[i + 1]);
+    uint64_t begin_ns = stats_ ? StatsClockNs() : 0;
+    session_->Run(Ort::RunOptions{ nullptr }, input_names_.data(), inputs.data(), inputs.size(),
+                  output_names_.data(), outputs.data(), outputs.size());
+    if (stats_) {
+        stats_delta_.add_inference(StatsClockNs() - begin_ns);
     }
 
+    cur_ = 1 - cur_;
+    return read_logits(outputs[0]);
+}
+
+const std::vector<float> &FsmnVadModel::read_logits(Ort::Value &output) {
     // Extract logits from output tensor [1, T]
-    float *logits_ptr = out[0].GetTensorMutableData<float>();
-    auto shape = out[0].GetTensorTypeAndShapeInfo().GetShape();
+    const float *logits_ptr = output.GetTensorData<float>();
+    auto shape = output.GetTensorTypeAndShapeInfo().GetShape();
     int T = static_cast<int>(shape[1]);
 
     // logits is noise probability
     // FunASR:  -1 < 1 - 2 * p_noise < 1
     // Ours: 0 < 2 * p_noise - 1 < 1 for speech probability, where p_speech = 1 - p_noise
-    std::vector<float> speech_probs(T);
+    speech_probs_.resize(T);
     for (int i = 0; i < T; ++i) {
-        speech_probs[i] = 1 - logits_ptr[i];
+        speech_probs_[i] = 1 - logits_ptr[i];
     }
+    output = Ort::Value{ nullptr };
 
-    return speech_probs;
+    return speech_probs_;
 }
 
 void FsmnVadModel::process_logits(const std::vector<float> &logits) {
@@ -95,22 +203,50 @@ void FsmnVadModel::process_logits(const std::vector<float> &logits) {
 
         if (start_ != -1) {
             if (current_ - start_ > max_speech_samples_) {
-                on_voice_end();
-                on_voice_start();
+                split_segment();
             }
         }
     }
 }
 
-std::vector<VadSegment> FsmnVadModel::decode(float *data, int n, bool input_finished) {
-    // 1. Accumulate all new data into reminder buffer to ensure no data loss
-    if (n > 0) {
-        reminder_.insert(reminder_.end(), data, data + n);
+void FsmnVadModel::process_features(float *data, int n, bool input_finished) {
+    if (n == 0 && !input_finished) {
+        return;
+    }
+    // Each fbank frame is computed once; all LFR frames completed by this chunk go into a
+    // single Run
+    feats_.clear();
+    framer_->push(data, n);
+    while (const float *frame = framer_->next()) {
+        frontend_->accept(frame, &feats_);
+    }
+    if (input_finished) {
+        frontend_->finish(&feats_);
+    }
+    int num_frames = static_cast<int>(feats_.size()) / frontend_->dim();
+    if (num_frames > 0) {
+        process_logits(forward_features(feats_.data(), num_frames));
     }
 
+    if (input_finished) {
+        flush();
+        framer_->reset();
+    } else {
+        framer_->stash();
+    }
+}
+
+void FsmnVadModel::process(float *data, int n, bool input_finished) {
+    if (frontend_) {
+        process_features(data, n, input_finished);
+        return;
+    }
+    framer_->push(data, n);
+
     // If no data is available and we're not finishing, wait for more data
-    if (reminder_.empty() && !input_finished) {
-        return {};
+    if (framer_->available() == 0 && !input_finished) {
+        framer_->stash();
+        return;
     }
 
     /*
@@ -133,62 +269,73 @@ std::vector<VadSegment> FsmnVadModel::decode(float *data, int n, bool input_fini
      * 3. Alignment:
      *    Each score produced by the model represents 10ms of audio.
      *    'current_' is advanced by logits.size() * 10ms.
+     *
+     * 4. Framing:
+     *    The 55ms context carried from the previous call is stitched with at most `lookahead`
+     *    samples of the new chunk. Once it is consumed, the rest of the chunk is fed as a view
+     *    without copying.
      */
 
     int reminder_limit = 3 * frame_shift_ + frame_length_; // 55ms = 880 samples
     int first_chunk_limit = 100 * samples_per_ms_;         // 100ms = 1600 samples
+    int lookahead = first_chunk_limit + reminder_limit;
+    int len = 0;
 
-    // 2. Process First Chunk or Normal Steady State
+    // 1. First chunk
     if (is_first_inference_) {
         // Explicitly wait for enough data before first calculation to satisfy context requirements
-        if (reminder_.size() < static_cast<size_t>(first_chunk_limit) && !input_finished) {
-            return {};
+        if (framer_->available() < first_chunk_limit && !input_finished) {
+            framer_->stash();
+            return;
         }
 
-        int64_t first_p = 2;
-        int64_t last_p = input_finished ? 2 : 0;
-        auto logits =
-            forward_frames(reminder_.data(), static_cast<int>(reminder_.size()), first_p, last_p);
-        is_first_inference_ = false;
-
         if (input_finished) {
             // Process all results if audio ends here
-            process_logits(logits);
+            if (framer_->available() > 0) {
+                const float *ptr = framer_->peek(INT_MAX, &len);
+                const auto &logits = forward_frames(ptr, len, 2, 2);
+                is_first_inference_ = false;
+                process_logits(logits);
+            }
             flush();
-            reminder_.clear();
-        } else {
-            // Consume N_real - 4 frames to leave 55ms context.
-            // logits.size() = N_real + 2 - 4 = N_real - 2.
-            // num_to_consume = logits.size() - 2.
-            int num_to_consume = std::max(0, static_cast<int>(logits.size()) - 2);
-            process_logits(logits);
-            // Erase only consumed samples; all others remain in reminder_
-            reminder_.erase(reminder_.begin(), reminder_.begin() + (num_to_consume * frame_shift_));
+            framer_->reset();
+            return;
         }
-    } else if (!input_finished) {
-        // Normal state: process any new data beyond the 55ms reminder context
-        if (reminder_.size() > static_cast<size_t>(reminder_limit)) {
-            auto logits =
-                forward_frames(reminder_.data(), static_cast<int>(reminder_.size()), 0, 0);
 
-            // Consume all produced scores (N_real - 4), leaving the required 55ms context
-            process_logits(logits);
-            // Precise erasure: keeps exactly the last 4 frames + any sub-frame remainder
-            reminder_.erase(reminder_.begin(), reminder_.begin() + (logits.size() * frame_shift_));
+        const float *ptr = framer_->peek(lookahead, &len);
+        const auto &logits = forward_frames(ptr, len, 2, 0);
+        is_first_inference_ = false;
+        // Consume N_real - 4 frames to leave 55ms context.
+        // logits.size() = N_real + 2 - 4 = N_real - 2.
+        // num_to_consume = logits.size() - 2.
+        int num_to_consume = std::max(0, static_cast<int>(logits.size()) - 2);
+        process_logits(logits);
+        framer_->consume(num_to_consume * frame_shift_);
+    }
+
+    // 2. Normal state: process any new frames beyond the 55ms reminder context
+    while (framer_->available() >= reminder_limit + frame_shift_) {
+        const float *ptr = framer_->peek(lookahead, &len);
+        const auto &logits = forward_frames(ptr, len, 0, 0);
+        if (logits.empty()) {
+            break;
         }
-    } else {
-        // Final flush when input_finished = true
-        if (!reminder_.empty()) {
-            auto logits =
-                forward_frames(reminder_.data(), static_cast<int>(reminder_.size()), 0, 2);
+        // Consume all produced scores (N_real - 4), leaving the required 55ms context
+        process_logits(logits);
+        framer_->consume(static_cast<int>(logits.size()) * frame_shift_);
+    }
+
+    // 3. Final flush when input_finished = true
+    if (input_finished) {
+        if (framer_->available() > 0) {
+            const float *ptr = framer_->peek(INT_MAX, &len);
+            const auto &logits = forward_frames(ptr, len, 0, 2);
             process_logits(logits);
         }
         flush();
-        reminder_.clear();
+        framer_->reset();
+    } else {
+        framer_->stash();
     }
-
-    std::vector<VadSegment> result = std::move(segs_);
-    segs_.clear();
-    return result;
 }
 } // namespace VadFilterOnnx
@@ -1,32 +1,59 @@
 #pragma once
 
+#include "vad/fsmn-frontend.h"
 #include "vad/vad-model.h"
+#include <memory>
 #include <vector>
 
 namespace VadFilterOnnx {
 
 bool is_fsmn_vad(const std::vector<const char *> &input_names,
                  const std::vector<const char *> &output_names);
+// Backbone-only export (--backbone-only): takes LFR+CMVN features, see FsmnFrontend
+bool is_fsmn_vad_backbone(const std::vector<const char *> &input_names,
+                          const std::vector<const char *> &output_names);
 
 class FsmnVadModel : public VadModel {
   public:
     FsmnVadModel() = default;
-    FsmnVadModel(const VadModel &other, const VadConfig &config, int fs, int fl)
-        : VadModel(other, config, fs, fl) {}
+    FsmnVadModel(const VadModel &other, const VadConfig &config, int fs, int fl);
 
     std::unique_ptr<VadModel> init(const VadConfig &config) override;
     void init_state() override;
     // empty forward implementation for FSMN VAD
-    float forward(float *data, int n) override { return 0.0f; };
-    std::vector<VadSegment> decode(float *data, int n, bool input_finished) override;
+    float forward(const float * /*data*/, int /*n*/) override { return 0.0f; };
+    void process(float *data, int n, bool input_finished) override;
+
+    // Backbone-only model: read the CMVN and sample rate from the model metadata so instances
+    // run the native frontend
+    bool load_frontend(const std::shared_ptr<Ort::Session> &session);
 
   private:
     VadType type_ = VadType::FsmnVad;
     void process_logits(const std::vector<float> &logits);
-    std::vector<float> forward_frames(float *data, int n, int64_t first_p, int64_t last_p);
-    std::vector<Ort::Value> caches_;
+    const std::vector<float> &forward_frames(const float *data, int n, int64_t first_p,
+                                           int64_t last_p);
+    const std::vector<float> &forward_features(const float *feats, int num_frames);
+    const std::vector<float> &read_logits(Ort::Value &output);
+    void process_features(float *data, int n, bool input_finished);
     static constexpr std::array<int64_t, 4> cache_shape_{ 1, 128, 19, 1 };
+    static constexpr size_t cache_size_ = 128 * 19;
+    // Caches are preallocated and double-buffered: Run reads one set and writes the other.
+    // The logits length depends on the chunk size, so ORT still allocates that output.
+    std::vector<float> cache_data_[2];
+    std::vector<Ort::Value> inputs_[2];
+    std::vector<Ort::Value> outputs_[2];
+    int64_t first_padding_ = 0;
+    int64_t last_padding_ = 0;
+    int cur_ = 0;
+    std::vector<float> speech_probs_;
     bool is_first_inference_ = true;
+
+    // Native frontend for the backbone-only model; the CMVN is shared by the handle
+    std::shared_ptr<const std::vector<float>> cmvn_;
+    int frontend_sample_rate_ = 0;
+    std::unique_ptr<FsmnFrontend> frontend_;
+    std::vector<float> feats_;
 };
 
 } // namespace VadFilterOnnx
\ No newline at end of file
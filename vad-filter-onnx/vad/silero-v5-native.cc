@@ -0,0 +1,265 @@
+#include "vad/silero-v5-native.h"
+#include "utils/onnx-tensors.h"
+#include "utils/simd-kernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+
+namespace VadFilterOnnx {
+
+namespace {
+
+constexpr int kHidden = 128;
+constexpr int kStrides[4] = { 1, 2, 2, 1 };
+constexpr char kBasisName[] = "stft.forward_basis_buffer";
+
+using TensorMap = std::unordered_map<std::string, const OnnxTensor *>;
+
+const OnnxTensor *Find(const TensorMap &tensors, const std::string &name,
+                       std::vector<int64_t> dims) {
+    auto it = tensors.find(name);
+    if (it == tensors.end()) {
+        printf("ERROR: Silero V5 weight %s not found\n", name.c_str());
+        return nullptr;
+    }
+    if (it->second->dims != dims) {
+        printf("ERROR: Silero V5 weight %s has an unexpected shape\n", name.c_str());
+        return nullptr;
+    }
+    return it->second;
+}
+
+// MatVec over any number of vectors
+void MatVecAll(const float *w, int rows, int cols, const float *x, int x_stride, int num_x,
+               float *y) {
+    for (int j = 0; j < num_x; j += 4) {
+        MatVec(w, rows, cols, x + static_cast<size_t>(j) * x_stride, x_stride,
+               std::min(4, num_x - j), y + static_cast<size_t>(j) * rows);
+    }
+}
+
+inline float Sigmoid(float x) { return 1.0f / (1.0f + std::exp(-x)); }
+
+// Frames of the STFT conv and the encoder layers for frames of n samples
+int StftFrames(int filter_length, int n) {
+    int padded = n + filter_length / 4;
+    return padded < filter_length ? 0 : (padded - filter_length) / (filter_length / 2) + 1;
+}
+
+int ConvFrames(int frames, int stride) { return (frames - 1) / stride + 1; }
+
+} // namespace
+
+std::shared_ptr<const SileroV5Native> SileroV5Native::load(const void *data, size_t size) {
+    std::vector<OnnxTensor> tensors;
+    if (!ReadOnnxFloatTensors(data, size, &tensors)) {
+        printf("ERROR: Failed to parse the ONNX model for the native Silero V5 engine\n");
+        return nullptr;
+    }
+    TensorMap by_name;
+    for (const auto &t : tensors) {
+        by_name.emplace(t.name, &t);
+    }
+
+    auto native = std::make_shared<SileroV5Native>();
+    // One branch per sample rate, told apart by the prefix of the weight names
+    for (const auto &t : tensors) {
+        size_t len = t.name.size();
+        size_t suffix = sizeof(kBasisName) - 1;
+        if (len < suffix || t.name.compare(len - suffix, suffix, kBasisName) != 0 ||
+            t.dims.size() != 3) {
+            continue;
+        }
+        std::string prefix = t.name.substr(0, len - suffix);
+        Rate rate;
+        rate.filter_length = static_cast<int>(t.dims[2]);
+        rate.bins = rate.filter_length / 2 + 1;
+        rate.sample_rate = rate.filter_length == 256 ? 16000 : 8000;
+        if ((rate.filter_length != 256 && rate.filter_length != 128) ||
+            t.dims != std::vector<int64_t>{ 2 * rate.bins, 1, rate.filter_length }) {
+            printf("ERROR: Unexpected Silero V5 STFT basis in %s\n", t.name.c_str());
+            return nullptr;
+        }
+        rate.basis = t.data;
+
+        int in = rate.bins;
+        for (int l = 0; l < 4; ++l) {
+            std::string name = prefix + "encoder." + std::to_string(l) + ".reparam_conv.";
+            auto it = by_name.find(name + "weight");
+            if (it == by_name.end() || it->second->dims.size() != 3) {
+                printf("ERROR: Silero V5 weight %sweight not found\n", name.c_str());
+                return nullptr;
+            }
+            int out = static_cast<int>(it->second->dims[0]);
+            const OnnxTensor *w = Find(by_name, name + "weight", { out, in, 3 });
+            const OnnxTensor *b = Find(by_name, name + "bias", { out });
+            if (!w || !b) {
+                return nullptr;
+            }
+            Conv &conv = rate.encoder[l];
+            conv.in = in;
+            conv.out = out;
+            conv.stride = kStrides[l];
+            conv.bias = b->data;
+            // [out][in][3] -> [out][3][in]
+            conv.weight.resize(w->data.size());
+            for (int o = 0; o < out; ++o) {
+                for (int c = 0; c < in; ++c) {
+                    for (int k = 0; k < 3; ++k) {
+                        conv.weight[(static_cast<size_t>(o) * 3 + k) * in + c] =
+                            w->data[(static_cast<size_t>(o) * in + c) * 3 + k];
+                    }
+                }
+            }
+            in = out;
+        }
+        if (in != kHidden) {
+            printf("ERROR: Silero V5 encoder output has %d channels, expected %d\n", in, kHidden);
+            return nullptr;
+        }
+
+        std::string rnn = prefix + "decoder.rnn.";
+        const OnnxTensor *w_ih = Find(by_name, rnn + "weight_ih", { 4 * kHidden, kHidden });
+        const OnnxTensor *w_hh = Find(by_name, rnn + "weight_hh", { 4 * kHidden, kHidden });
+        const OnnxTensor *b_ih = Find(by_name, rnn + "bias_ih", { 4 * kHidden });
+        const OnnxTensor *b_hh = Find(by_name, rnn + "bias_hh", { 4 * kHidden });
+        const OnnxTensor *w_out =
+            Find(by_name, prefix + "decoder.decoder.2.weight", { 1, kHidden, 1 });
+        const OnnxTensor *b_out = Find(by_name, prefix + "decoder.decoder.2.bias", { 1 });
+        if (!w_ih || !w_hh || !b_ih || !b_hh || !w_out || !b_out) {
+            return nullptr;
+        }
+        rate.lstm_weight.resize(static_cast<size_t>(4 * kHidden) * 2 * kHidden);
+        rate.lstm_bias.resize(4 * kHidden);
+        for (int r = 0; r < 4 * kHidden; ++r) {
+            float *row = rate.lstm_weight.data() + static_cast<size_t>(r) * 2 * kHidden;
+            std::copy_n(w_ih->data.data() + static_cast<size_t>(r) * kHidden, kHidden, row);
+            std::copy_n(w_hh->data.data() + static_cast<size_t>(r) * kHidden, kHidden,
+                        row + kHidden);
+            rate.lstm_bias[r] = b_ih->data[r] + b_hh->data[r];
+        }
+        rate.out_weight = w_out->data;
+        rate.out_bias = b_out->data[0];
+
+        if (native->find(rate.sample_rate)) {
+            printf("ERROR: Silero V5 model has two weight sets for %d Hz\n", rate.sample_rate);
+            return nullptr;
+        }
+        native->rates_.push_back(std::move(rate));
+    }
+    if (native->rates_.empty()) {
+        printf("ERROR: No Silero V5 weights found in the ONNX model\n");
+        return nullptr;
+    }
+    return native;
+}
+
+const SileroV5Native::Rate *SileroV5Native::find(int sample_rate) const {
+    for (const auto &rate : rates_) {
+        if (rate.sample_rate == sample_rate) {
+            return &rate;
+        }
+    }
+    return nullptr;
+}
+
+size_t SileroV5Native::scratch_size(int sample_rate, int n) const {
+    const Rate *rate = find(sample_rate);
+    if (!rate || n <= rate->filter_length / 4) {
+        return 0;
+    }
+    int frames = StftFrames(rate->filter_length, n);
+    if (frames <= 0) {
+        return 0;
+    }
+    // Padded input, STFT output, then every layer's activations with a zero frame on each side
+    size_t size = n + rate->filter_length / 4;
+    size += static_cast<size_t>(frames) * 2 * rate->bins;
+    size += static_cast<size_t>(frames + 2) * rate->bins;
+    for (const auto &conv : rate->encoder) {
+        frames = ConvFrames(frames, conv.stride);
+        size += static_cast<size_t>(frames + 2) * conv.out;
+    }
+    if (frames != 1) {
+        return 0;
+    }
+    return size + 2 * kHidden + 4 * kHidden;
+}
+
+float SileroV5Native::forward(int sample_rate, const float *x, int n, const float *state,
+                              float *next_state, float *scratch) const {
+    const Rate &rate = *find(sample_rate);
+    int k = rate.filter_length;
+    int bins = rate.bins;
+
+    // Reflect padding on the right
+    float *padded = scratch;
+    int pad = k / 4;
+    std::copy_n(x, n, padded);
+    for (int j = 0; j < pad; ++j) {
+        padded[n + j] = x[n - 2 - j];
+    }
+    scratch += n + pad;
+
+    int frames = StftFrames(k, n);
+    float *stft = scratch;
+    MatVecAll(rate.basis.data(), 2 * bins, k, padded, k / 2, frames, stft);
+    scratch += static_cast<size_t>(frames) * 2 * bins;
+
+    float *act = scratch;
+    std::fill_n(act, bins, 0.0f);
+    for (int t = 0; t < frames; ++t) {
+        const float *re = stft + static_cast<size_t>(t) * 2 * bins;
+        const float *im = re + bins;
+        float *mag = act + static_cast<size_t>(t + 1) * bins;
+        for (int f = 0; f < bins; ++f) {
+            mag[f] = std::sqrt(re[f] * re[f] + im[f] * im[f]);
+        }
+    }
+    std::fill_n(act + static_cast<size_t>(frames + 1) * bins, bins, 0.0f);
+    scratch += static_cast<size_t>(frames + 2) * bins;
+
+    for (const auto &conv : rate.encoder) {
+        // Output frame t reads padded input frames t * stride .. t * stride + 2
+        int out_frames = ConvFrames(frames, conv.stride);
+        float *out = scratch;
+        std::fill_n(out, conv.out, 0.0f);
+        MatVecAll(conv.weight.data(), conv.out, 3 * conv.in, act, conv.stride * conv.in,
+                  out_frames, out + conv.out);
+        for (int t = 0; t < out_frames; ++t) {
+            float *y = out + static_cast<size_t>(t + 1) * conv.out;
+            for (int o = 0; o < conv.out; ++o) {
+                y[o] = std::max(y[o] + conv.bias[o], 0.0f);
+            }
+        }
+        std::fill_n(out + static_cast<size_t>(out_frames + 1) * conv.out, conv.out, 0.0f);
+        scratch += static_cast<size_t>(out_frames + 2) * conv.out;
+        act = out;
+        frames = out_frames;
+    }
+
+    // LSTM cell on [x, h], gates in PyTorch order i, f, g, o
+    float *xh = scratch;
+    std::copy_n(act + kHidden, kHidden, xh);
+    std::copy_n(state, kHidden, xh + kHidden);
+    float *gates = xh + 2 * kHidden;
+    MatVec(rate.lstm_weight.data(), 4 * kHidden, 2 * kHidden, xh, 0, 1, gates);
+    const float *c = state + kHidden;
+    float *h_next = next_state;
+    float *c_next = next_state + kHidden;
+    float logit = rate.out_bias;
+    for (int j = 0; j < kHidden; ++j) {
+        float i = Sigmoid(gates[j] + rate.lstm_bias[j]);
+        float f = Sigmoid(gates[kHidden + j] + rate.lstm_bias[kHidden + j]);
+        float g = std::tanh(gates[2 * kHidden + j] + rate.lstm_bias[2 * kHidden + j]);
+        float o = Sigmoid(gates[3 * kHidden + j] + rate.lstm_bias[3 * kHidden + j]);
+        c_next[j] = f * c[j] + i * g;
+        h_next[j] = o * std::tanh(c_next[j]);
+        logit += std::max(h_next[j], 0.0f) * rate.out_weight[j];
+    }
+    return Sigmoid(logit);
+}
+
+} // namespace VadFilterOnnx
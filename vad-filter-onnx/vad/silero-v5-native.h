@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace VadFilterOnnx {
+
+/**
+ * @brief Silero VAD V5 forward pass without ONNX Runtime.
+ *
+ * Holds the weights of every sample rate found in the model (16k and 8k for the released
+ * files), read once from the ONNX file and shared read-only by all instances of a handle:
+ * about 1.2 MB per rate, so a multi-stream host keeps one cache-resident copy. Every layer is
+ * a matrix times up to 4 vectors (MatVec, AVX-512/AVX2/NEON/scalar chosen at runtime):
+ *
+ *   STFT conv (kernel K, hop K/2, right reflect padding K/4) -> magnitude
+ *   -> 4 x (conv k=3 pad 1, strides 1 2 2 1, ReLU) -> LSTM cell (128) -> ReLU -> linear -> sigmoid
+ *
+ * Convolution weights are reordered to [out][k][in] so that the receptive field of an output
+ * frame is a contiguous slice of the time-major activations, with no im2col copy.
+ */
+class SileroV5Native {
+  public:
+    static constexpr int kStateSize = 2 * 128; // h followed by c, as the model's state
+
+    // nullptr with an error message if the buffer is not a Silero V5 ONNX model
+    static std::shared_ptr<const SileroV5Native> load(const void *data, size_t size);
+
+    // Floats of per-instance scratch for forward() on frames of n samples; 0 if the model has
+    // no weights for sample_rate or the frames do not reduce to one LSTM step
+    size_t scratch_size(int sample_rate, int n) const;
+
+    // One frame of n samples (context followed by the window, 576 at 16k). Reads the state
+    // from `state` and writes the next one to `next_state`; they must not overlap.
+    float forward(int sample_rate, const float *x, int n, const float *state, float *next_state,
+                  float *scratch) const;
+
+  private:
+    struct Conv {
+        int in = 0;
+        int out = 0;
+        int stride = 1;
+        std::vector<float> weight; // [out][3][in]
+        std::vector<float> bias;
+    };
+    struct Rate {
+        int sample_rate = 0;
+        int filter_length = 0;     // K
+        int bins = 0;              // K / 2 + 1
+        std::vector<float> basis;  // [2 * bins][K]: real rows then imaginary rows
+        Conv encoder[4];
+        std::vector<float> lstm_weight; // [512][256]: weight_ih | weight_hh per row
+        std::vector<float> lstm_bias;   // bias_ih + bias_hh
+        std::vector<float> out_weight;  // [128]
+        float out_bias = 0.0f;
+    };
+
+    const Rate *find(int sample_rate) const;
+
+    std::vector<Rate> rates_;
+};
+
+} // namespace VadFilterOnnx
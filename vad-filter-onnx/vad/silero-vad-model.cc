@@ -29,88 +29,247 @@ bool is_silero_vad_v5(const std::vector<const char *> &input_names,
 }
 
 void SileroVadModelV4::init_state() {
-    if (h_state_ == nullptr) {
-        h_state_ = Ort::Value::CreateTensor<float>(allocator_, shape_.data(), shape_.size());
-        c_state_ = Ort::Value::CreateTensor<float>(allocator_, shape_.data(), shape_.size());
+    if (inputs_[0].empty()) {
+        std::array<int64_t, 2> x_shape = { 1, frame_length_ };
+        int64_t sr_shape = 1;
+        auto prob_shape = GetOutputShape(session_, 0);
+        x_data_.resize(frame_length_);
+        prob_data_.resize(1);
+        sample_rate_ = static_cast<int64_t>(config_.sample_rate);
+        for (int k = 0; k < 2; ++k) {
+            state_data_[k].resize(2 * state_size_);
+        }
+        for (int k = 0; k < 2; ++k) {
+            // Inputs: input, sr, h, c
+            inputs_[k].push_back(
+                WrapTensor(x_data_.data(), x_data_.size(), x_shape.data(), x_shape.size()));
+            inputs_[k].push_back(WrapTensor(&sample_rate_, 1, &sr_shape, 1));
+            inputs_[k].push_back(
+                WrapTensor(state_data_[k].data(), state_size_, shape_.data(), shape_.size()));
+            inputs_[k].push_back(WrapTensor(state_data_[k].data() + state_size_, state_size_,
+                                            shape_.data(), shape_.size()));
+            // Outputs: output, hn, cn
+            outputs_[k].push_back(WrapTensor(prob_data_.data(), prob_data_.size(),
+                                             prob_shape.data(), prob_shape.size()));
+            outputs_[k].push_back(
+                WrapTensor(state_data_[1 - k].data(), state_size_, shape_.data(), shape_.size()));
+            outputs_[k].push_back(WrapTensor(state_data_[1 - k].data() + state_size_,
+                                             state_size_, shape_.data(), shape_.size()));
+        }
     }
-    Fill<float>(&h_state_, 0.0f);
-    Fill<float>(&c_state_, 0.0f);
+    cur_ = 0;
+    std::fill(state_data_[cur_].begin(), state_data_[cur_].end(), 0.0f);
 }
 
 std::unique_ptr<VadModel> SileroVadModelV4::init(const VadConfig &config) {
+    if (!check_config(config)) {
+        return nullptr;
+    }
     // Silero V4 uses fixed 512 samples
     auto instance = std::make_unique<SileroVadModelV4>(*this, config, 512, 512);
     instance->reset();
+    instance->warmup();
     return instance;
 }
 
-float SileroVadModelV4::forward(float *data, int n) {
-    auto memory_info = Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
-    std::array<int64_t, 2> x_shape = { 1, n };
-    Ort::Value x = Ort::Value::CreateTensor(memory_info, data, n, x_shape.data(), x_shape.size());
+float SileroVadModelV4::forward(const float *data, int n) {
+    std::copy(data, data + n, x_data_.begin());
+    session_->Run(Ort::RunOptions{ nullptr }, input_names_.data(), inputs_[cur_].data(),
+                  inputs_[cur_].size(), output_names_.data(), outputs_[cur_].data(),
+                  outputs_[cur_].size());
+    cur_ = 1 - cur_;
+    return prob_data_[0];
+}
 
+bool SileroVadModelV4::forward_batch(VadModel *const *models, const float *const *frames,
+                                     int batch, float *probs) {
+    int n = frame_length_;
+    batch_.x.resize(static_cast<size_t>(batch) * n);
+    for (int b = 0; b < batch; ++b) {
+        std::copy(frames[b], frames[b] + n, batch_.x.data() + static_cast<size_t>(b) * n);
+    }
+    std::array<int64_t, 2> x_shape = { batch, n };
     int64_t sr_shape = 1;
-    int64_t sample_rate = static_cast<int64_t>(config_.sample_rate);
-    Ort::Value sr = Ort::Value::CreateTensor(memory_info, &sample_rate, 1, &sr_shape, 1);
 
-    std::array<Ort::Value, 4> inputs = { std::move(x), std::move(sr), std::move(h_state_),
-                                         std::move(c_state_) };
+    // Pack [2, 1, 64] per-stream states into [2, B, 64]
+    int inner = static_cast<int>(shape_[2]);
+    std::array<int64_t, 3> state_shape = { shape_[0], batch, shape_[2] };
+    size_t state_size = static_cast<size_t>(shape_[0]) * batch * inner;
+    std::vector<float> &h_data = batch_.states[0];
+    std::vector<float> &c_data = batch_.states[1];
+    h_data.resize(state_size);
+    c_data.resize(state_size);
+    batch_.src.resize(batch);
+    for (int b = 0; b < batch; ++b) {
+        auto *m = static_cast<SileroVadModelV4 *>(models[b]);
+        batch_.src[b] = m->state_data_[m->cur_].data();
+    }
+    GatherBatch(batch_.src.data(), batch, static_cast<int>(shape_[0]), inner, h_data.data());
+    for (int b = 0; b < batch; ++b) {
+        batch_.src[b] += state_size_;
+    }
+    GatherBatch(batch_.src.data(), batch, static_cast<int>(shape_[0]), inner, c_data.data());
 
+    // Inputs: input, sr, h, c
+    auto &inputs = batch_.inputs;
+    inputs.clear();
+    inputs.push_back(WrapTensor(batch_.x.data(), batch_.x.size(), x_shape.data(), x_shape.size()));
+    inputs.push_back(WrapTensor(&sample_rate_, 1, &sr_shape, 1));
+    inputs.push_back(
+        WrapTensor(h_data.data(), state_size, state_shape.data(), state_shape.size()));
+    inputs.push_back(
+        WrapTensor(c_data.data(), state_size, state_shape.data(), state_shape.size()));
     auto out = session_->Run(Ort::RunOptions{ nullptr }, input_names_.data(), inputs.data(),
                              inputs.size(), output_names_.data(), output_names_.size());
 
-    h_state_ = std::move(out[1]);
-    c_state_ = std::move(out[2]);
-    float prob = out[0].GetTensorData<float>()[0];
-    return prob;
+    batch_.dst.resize(batch);
+    for (int b = 0; b < batch; ++b) {
+        auto *m = static_cast<SileroVadModelV4 *>(models[b]);
+        batch_.dst[b] = m->state_data_[m->cur_].data();
+    }
+    ScatterBatch(out[1].GetTensorData<float>(), batch, static_cast<int>(shape_[0]), inner,
+                 batch_.dst.data());
+    for (int b = 0; b < batch; ++b) {
+        batch_.dst[b] += state_size_;
+    }
+    ScatterBatch(out[2].GetTensorData<float>(), batch, static_cast<int>(shape_[0]), inner,
+                 batch_.dst.data());
+    const float *out_probs = out[0].GetTensorData<float>();
+    std::copy(out_probs, out_probs + batch, probs);
+    return true;
 }
 
 /* SileroVadModelV5 Implementation */
 
+void SileroVadModelV5::load_native(const void *data, size_t size) {
+    native_ = data ? SileroV5Native::load(data, size) : nullptr;
+    if (!native_) {
+        printf("WARNING: Native Silero V5 engine unavailable, using ONNX Runtime\n");
+    }
+}
+
 void SileroVadModelV5::init_state() {
-    if (state_ == nullptr) {
-        state_ = Ort::Value::CreateTensor<float>(allocator_, shape_.data(), shape_.size());
+    if (native_) {
+        for (int k = 0; k < 2; ++k) {
+            state_data_[k].resize(state_size_);
+        }
+    } else if (inputs_[0].empty()) {
+        std::array<int64_t, 2> x_shape = { 1, frame_length_ };
+        int64_t sr_shape = 1;
+        auto prob_shape = GetOutputShape(session_, 0);
+        x_data_.resize(frame_length_);
+        prob_data_.resize(1);
+        sample_rate_ = static_cast<int64_t>(config_.sample_rate);
+        for (int k = 0; k < 2; ++k) {
+            state_data_[k].resize(state_size_);
+        }
+        for (int k = 0; k < 2; ++k) {
+            // Inputs: input, state and sr if the model requires it (size 3)
+            inputs_[k].push_back(
+                WrapTensor(x_data_.data(), x_data_.size(), x_shape.data(), x_shape.size()));
+            inputs_[k].push_back(
+                WrapTensor(state_data_[k].data(), state_size_, shape_.data(), shape_.size()));
+            if (input_names_.size() > 2) {
+                inputs_[k].push_back(WrapTensor(&sample_rate_, 1, &sr_shape, 1));
+            }
+            // Outputs: output, stateN
+            outputs_[k].push_back(WrapTensor(prob_data_.data(), prob_data_.size(),
+                                             prob_shape.data(), prob_shape.size()));
+            outputs_[k].push_back(
+                WrapTensor(state_data_[1 - k].data(), state_size_, shape_.data(), shape_.size()));
+        }
     }
-    Fill<float>(&state_, 0.0f);
+    cur_ = 0;
+    std::fill(state_data_[cur_].begin(), state_data_[cur_].end(), 0.0f);
 }
 
 std::unique_ptr<VadModel> SileroVadModelV5::init(const VadConfig &config) {
+    if (!check_config(config)) {
+        return nullptr;
+    }
     // Silero V5: shift is 256/512, length adds context (32/64)
     int frame_shift = (config.sample_rate == 8000 ? 256 : 512);
     int context_size = (config.sample_rate == 8000 ? 32 : 64);
     int frame_length = frame_shift + context_size;
     auto instance = std::make_unique<SileroVadModelV5>(*this, config, frame_shift, frame_length);
+    size_t scratch_size = native_ ? native_->scratch_size(config.sample_rate, frame_length) : 0;
+    if (scratch_size) {
+        instance->native_ = native_;
+        instance->native_scratch_.resize(scratch_size);
+    } else if (native_) {
+        printf("WARNING: Native Silero V5 engine has no %d Hz weights, using ONNX Runtime\n",
+               config.sample_rate);
+    }
     instance->reset();
+    instance->warmup();
     return instance;
 }
 
-float SileroVadModelV5::forward(float *data, int n) {
-    auto memory_info = Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
-    std::array<int64_t, 2> x_shape = { 1, n };
-    Ort::Value x = Ort::Value::CreateTensor(memory_info, data, n, x_shape.data(), x_shape.size());
+float SileroVadModelV5::forward(const float *data, int n) {
+    if (native_) {
+        float prob = native_->forward(config_.sample_rate, data, n, state_data_[cur_].data(),
+                                      state_data_[1 - cur_].data(), native_scratch_.data());
+        cur_ = 1 - cur_;
+        return prob;
+    }
+    std::copy(data, data + n, x_data_.begin());
+    session_->Run(Ort::RunOptions{ nullptr }, input_names_.data(), inputs_[cur_].data(),
+                  inputs_[cur_].size(), output_names_.data(), outputs_[cur_].data(),
+                  outputs_[cur_].size());
+    cur_ = 1 - cur_;
+    return prob_data_[0];
+}
 
-    // 使用 vector 替代 array，解决 Ort::Value 无法默认构造的问题
-    std::vector<Ort::Value> inputs;
-    inputs.reserve(input_names_.size());
+bool SileroVadModelV5::forward_batch(VadModel *const *models, const float *const *frames,
+                                     int batch, float *probs) {
+    if (native_) {
+        // Per-stream native frames over the shared weights beat one batched Session::Run
+        return false;
+    }
+    int n = frame_length_;
+    batch_.x.resize(static_cast<size_t>(batch) * n);
+    for (int b = 0; b < batch; ++b) {
+        std::copy(frames[b], frames[b] + n, batch_.x.data() + static_cast<size_t>(b) * n);
+    }
+    std::array<int64_t, 2> x_shape = { batch, n };
 
-    // 基础输入：input 和 state
-    inputs.push_back(std::move(x));
-    inputs.push_back(std::move(state_));
+    // Pack [2, 1, 128] per-stream states into [2, B, 128]
+    int inner = static_cast<int>(shape_[2]);
+    std::array<int64_t, 3> state_shape = { shape_[0], batch, shape_[2] };
+    size_t state_size = static_cast<size_t>(shape_[0]) * batch * inner;
+    std::vector<float> &state_data = batch_.states[0];
+    state_data.resize(state_size);
+    batch_.src.resize(batch);
+    for (int b = 0; b < batch; ++b) {
+        auto *m = static_cast<SileroVadModelV5 *>(models[b]);
+        batch_.src[b] = m->state_data_[m->cur_].data();
+    }
+    GatherBatch(batch_.src.data(), batch, static_cast<int>(shape_[0]), inner, state_data.data());
 
-    // 如果模型需要采样率输入 (size 为 3)
+    // Inputs: input, state and sr if the model requires it
+    auto &inputs = batch_.inputs;
+    inputs.clear();
+    inputs.push_back(WrapTensor(batch_.x.data(), batch_.x.size(), x_shape.data(), x_shape.size()));
+    inputs.push_back(
+        WrapTensor(state_data.data(), state_size, state_shape.data(), state_shape.size()));
+    int64_t sr_shape = 1;
     if (input_names_.size() > 2) {
-        int64_t sr_shape = 1;
-        int64_t sample_rate = static_cast<int64_t>(config_.sample_rate);
-        Ort::Value sr = Ort::Value::CreateTensor(memory_info, &sample_rate, 1, &sr_shape, 1);
-        inputs.push_back(std::move(sr));
+        inputs.push_back(WrapTensor(&sample_rate_, 1, &sr_shape, 1));
     }
 
     auto out = session_->Run(Ort::RunOptions{ nullptr }, input_names_.data(), inputs.data(),
                              inputs.size(), output_names_.data(), output_names_.size());
 
-    state_ = std::move(out[1]);
-    float prob = out[0].GetTensorData<float>()[0];
-    return prob;
+    batch_.dst.resize(batch);
+    for (int b = 0; b < batch; ++b) {
+        auto *m = static_cast<SileroVadModelV5 *>(models[b]);
+        batch_.dst[b] = m->state_data_[m->cur_].data();
+    }
+    ScatterBatch(out[1].GetTensorData<float>(), batch, static_cast<int>(shape_[0]), inner,
+                 batch_.dst.data());
+    const float *out_probs = out[0].GetTensorData<float>();
+    std::copy(out_probs, out_probs + batch, probs);
+    return true;
 }
 
 } // namespace VadFilterOnnx
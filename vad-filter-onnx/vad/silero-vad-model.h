@@ -1,6 +1,8 @@
 #pragma once
 
+#include "vad/silero-v5-native.h"
 #include "vad/vad-model.h"
+#include <memory>
 #include <vector>
 
 namespace VadFilterOnnx {
@@ -18,13 +20,23 @@ class SileroVadModelV4 : public VadModel {
 
     std::unique_ptr<VadModel> init(const VadConfig &config) override;
     void init_state() override;
-    float forward(float *data, int n) override;
+    float forward(const float *data, int n) override;
+    bool forward_batch(VadModel *const *models, const float *const *frames, int batch,
+                       float *probs) override;
+    std::vector<float> *recurrent_state() override { return &state_data_[cur_]; }
 
   private:
     VadType type_ = VadType::SileroVadV4;
     static constexpr std::array<int64_t, 3> shape_{ 2, 1, 64 };
-    Ort::Value h_state_{ nullptr };
-    Ort::Value c_state_{ nullptr };
+    static constexpr size_t state_size_ = 2 * 64;
+    // Preallocated tensors. h/c are double-buffered: Run reads one set and writes the other.
+    std::vector<float> x_data_;
+    std::vector<float> prob_data_;
+    int64_t sample_rate_ = 0;
+    std::vector<float> state_data_[2]; // h followed by c
+    std::vector<Ort::Value> inputs_[2];
+    std::vector<Ort::Value> outputs_[2];
+    int cur_ = 0;
 };
 
 class SileroVadModelV5 : public VadModel {
@@ -35,12 +47,29 @@ class SileroVadModelV5 : public VadModel {
 
     std::unique_ptr<VadModel> init(const VadConfig &config) override;
     void init_state() override;
-    float forward(float *data, int n) override;
+    float forward(const float *data, int n) override;
+    bool forward_batch(VadModel *const *models, const float *const *frames, int batch,
+                       float *probs) override;
+    std::vector<float> *recurrent_state() override { return &state_data_[cur_]; }
+
+    // Read the weights for the native engine from the ONNX bytes; instances created afterwards
+    // skip Session::Run. Keeps ONNX Runtime, with a warning, if that fails.
+    void load_native(const void *data, size_t size);
 
   private:
     VadType type_ = VadType::SileroVadV5;
+    std::shared_ptr<const SileroV5Native> native_; // shared by the handle and its instances
+    std::vector<float> native_scratch_;
     static constexpr std::array<int64_t, 3> shape_{ 2, 1, 128 };
-    Ort::Value state_{ nullptr };
+    static constexpr size_t state_size_ = 2 * 128;
+    // Preallocated tensors. The state is double-buffered: Run reads one and writes the other.
+    std::vector<float> x_data_;
+    std::vector<float> prob_data_;
+    int64_t sample_rate_ = 0;
+    std::vector<float> state_data_[2];
+    std::vector<Ort::Value> inputs_[2];
+    std::vector<Ort::Value> outputs_[2];
+    int cur_ = 0;
 };
 
 } // namespace VadFilterOnnx
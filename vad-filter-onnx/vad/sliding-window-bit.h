@@ -3,30 +3,55 @@
 #include <algorithm>
 #include <bit>
 #include <cstdint>
-#include <iostream>
 #include <string>
+#include <vector>
 
 namespace VadFilterOnnx {
 
+/**
+ * @brief FIFO of the last max_size speech/silence decisions, stored as bits in a ring of
+ * 64-bit words, so windows of any length are supported (e.g. 3s of 10ms frames).
+ *
+ * Every query used per frame is O(1) regardless of the window length: the number of ones is
+ * kept incrementally for the full window and for every window passed to track(), and the
+ * lengths of the newest runs of ones/zeros are kept as running counters. check_speech() and
+ * check_silence() on an untracked window fall back to a popcount over its words.
+ */
 class SlidingWindowBit {
   public:
-    SlidingWindowBit(size_t max_size) : window(0), current_size(0) {
-        if (max_size > 64) {
-            std::cerr << "Warning: SlidingWindowBit max_size (" << max_size
-                      << ") exceeds 64. Capping to 64." << std::endl;
+    SlidingWindowBit(size_t max_size) : max_size(std::max<size_t>(max_size, 1)) {
+        words.assign((this->max_size + 63) / 64, 0);
+        ring_bits = words.size() * 64;
+        track(this->max_size);
+    }
+
+    // Keep a running count for windows of win_size, making checks on them O(1)
+    void track(size_t win_size) {
+        win_size = std::min(win_size, max_size);
+        if (win_size == 0 || find_tracked(win_size)) {
+            return;
         }
-        this->max_size = std::min(max_size, (size_t)64);
-        // 构造掩码，用于清理移出窗口的高位数据
-        mask = (this->max_size >= 64) ? ~0ULL : (1ULL << this->max_size) - 1;
+        tracked.push_back({ win_size, count_ones(win_size) });
     }
 
     void push(bool value) {
-        // FIFO: 左移腾出最低位，填入新值
-        window = ((window << 1) | (value ? 1ULL : 0ULL)) & mask;
+        size_t slot = pos % ring_bits;
+        // Drop the bit leaving each full window before its slot may be overwritten
+        for (auto &w : tracked) {
+            if (current_size >= w.size) {
+                w.ones -= bit_at(pos - w.size);
+            }
+            w.ones += value;
+        }
+        uint64_t bit = 1ULL << (slot % 64);
+        words[slot / 64] = value ? words[slot / 64] | bit : words[slot / 64] & ~bit;
+        pos++;
 
         if (current_size < max_size) {
             current_size++;
         }
+        run = (value == run_value) ? std::min(run + 1, current_size) : 1;
+        run_value = value;
     }
 
     /**
@@ -37,9 +62,7 @@ class SlidingWindowBit {
     bool check_speech(size_t win_size, size_t threshold) const {
         if (current_size < win_size)
             return false;
-        uint64_t sub_mask = (win_size >= 64) ? ~0ULL : (1ULL << win_size) - 1;
-        uint64_t sub_window = window & sub_mask;
-        return std::popcount(sub_window) >= threshold;
+        return num_ones(win_size) >= threshold;
     }
 
     /**
@@ -50,78 +73,138 @@ class SlidingWindowBit {
     bool check_silence(size_t win_size, size_t threshold) const {
         if (current_size < win_size)
             return false;
-        uint64_t sub_mask = (win_size >= 64) ? ~0ULL : (1ULL << win_size) - 1;
-        uint64_t sub_window = window & sub_mask;
-        size_t num_zeros = win_size - std::popcount(sub_window);
-        return num_zeros >= threshold;
+        return win_size - num_ones(win_size) >= threshold;
     }
 
-    // 统计 1 的数量 (O(1))
-    size_t get_num_ones() const { return std::popcount(window); }
+    // Number of ones in the newest win_size frames; O(1) for tracked windows
+    size_t num_ones(size_t win_size) const {
+        win_size = std::min(win_size, current_size);
+        if (const Tracked *w = find_tracked(win_size)) {
+            return w->ones;
+        }
+        return count_ones(win_size);
+    }
+
+    size_t get_num_ones() const { return tracked[0].ones; }
 
     size_t get_num_zeros() const { return current_size - get_num_ones(); }
 
-    // --- 连续性统计函数 ---
-
-    // 从右侧（最新进入的一侧，低位）数连续 of 0
-    size_t num_right_zeros() const {
-        if (current_size == 0)
-            return 0;
-        // 如果最低位是 1，则返回 0；否则返回低位连续 0 的个数
-        if (window & 1ULL)
-            return 0;
-        return std::min((size_t)std::countr_zero(window | ~mask | (1ULL << current_size)),
-                        current_size);
-    }
+    // --- Runs ---
 
-    // 从右侧（最新）数连续的 1
-    size_t num_right_ones() const {
-        if (current_size == 0)
-            return 0;
-        if (!(window & 1ULL))
-            return 0;
-        return std::countr_zero(~window);
-    }
+    // Consecutive zeros at the right (newest) end
+    size_t num_right_zeros() const { return current_size && !run_value ? run : 0; }
 
-    // 从左侧（最旧进入的一侧）数连续 of 0
-    size_t num_left_zeros() const {
-        if (current_size == 0)
-            return 0;
-        // 需要对齐到窗口的“左端”
-        // 窗口有效位在 [0, current_size-1]，最旧的位在 index = current_size-1
-        uint64_t reversed_window = window << (64 - current_size);
-        return std::countl_zero(reversed_window);
-    }
+    // Consecutive ones at the right (newest) end
+    size_t num_right_ones() const { return current_size && run_value ? run : 0; }
 
-    // 从左侧（最旧）数连续的 1
-    size_t num_left_ones() const {
-        if (current_size == 0)
-            return 0;
-        uint64_t reversed_window = window << (64 - current_size);
-        return std::countl_one(reversed_window);
-    }
+    // Consecutive zeros at the left (oldest) end; O(window / 64)
+    size_t num_left_zeros() const { return num_left(false); }
+
+    // Consecutive ones at the left (oldest) end; O(window / 64)
+    size_t num_left_ones() const { return num_left(true); }
 
     void reset() {
-        window = 0;
+        std::fill(words.begin(), words.end(), 0);
+        for (auto &w : tracked) {
+            w.ones = 0;
+        }
+        pos = 0;
         current_size = 0;
+        run = 0;
+        run_value = false;
     }
 
-    void reverse() { window = (~window) & mask; }
+    // Invert the frames in the window
+    void reverse() {
+        for (auto &word : words) {
+            word = ~word;
+        }
+        for (auto &w : tracked) {
+            w.ones = std::min(w.size, current_size) - w.ones;
+        }
+        run_value = !run_value;
+    }
 
+    // Oldest frame first
     std::string to_string() const {
         std::string s;
         s.reserve(current_size);
-        for (int i = static_cast<int>(current_size) - 1; i >= 0; --i) {
-            s += ((window >> i) & 1ULL) ? '1' : '0';
+        for (size_t age = current_size; age > 0; --age) {
+            s += bit_at(pos - age) ? '1' : '0';
         }
         return s;
     }
 
   private:
-    uint64_t window;
-    uint64_t mask;
+    struct Tracked {
+        size_t size;
+        size_t ones;
+    };
+
+    const Tracked *find_tracked(size_t win_size) const {
+        for (const auto &w : tracked) {
+            if (w.size == win_size) {
+                return &w;
+            }
+        }
+        return nullptr;
+    }
+
+    // Bit pushed as the index-th frame since reset (index >= pos - ring_bits)
+    bool bit_at(uint64_t index) const {
+        size_t slot = index % ring_bits;
+        return (words[slot / 64] >> (slot % 64)) & 1ULL;
+    }
+
+    // Popcount of the newest n frames (n <= current_size), a word at a time
+    size_t count_ones(size_t n) const {
+        n = std::min(n, current_size);
+        size_t ones = 0;
+        uint64_t begin = pos - n;
+        while (n > 0) {
+            size_t slot = begin % ring_bits;
+            size_t offset = slot % 64;
+            size_t len = std::min<size_t>(n, 64 - offset);
+            uint64_t word = words[slot / 64] >> offset;
+            if (len < 64) {
+                word &= (1ULL << len) - 1;
+            }
+            ones += std::popcount(word);
+            begin += len;
+            n -= len;
+        }
+        return ones;
+    }
+
+    size_t num_left(bool value) const {
+        size_t count = 0;
+        uint64_t index = pos - current_size;
+        while (count < current_size) {
+            size_t slot = index % ring_bits;
+            size_t offset = slot % 64;
+            size_t len = std::min<size_t>(current_size - count, 64 - offset);
+            uint64_t word = words[slot / 64] >> offset;
+            if (value) {
+                word = ~word;
+            }
+            size_t same = std::min<size_t>(std::countr_zero(word), len);
+            count += same;
+            if (same < len) {
+                break;
+            }
+            index += len;
+        }
+        return count;
+    }
+
+    std::vector<uint64_t> words;  // ring of frames, frame i at bit i % ring_bits
+    std::vector<Tracked> tracked; // tracked[0] is the full window
     size_t max_size;
-    size_t current_size;
+    size_t ring_bits = 0;
+    uint64_t pos = 0;             // frames pushed since reset
+    size_t current_size = 0;
+    size_t run = 0;               // length of the newest run, at most current_size
+    bool run_value = false;
 };
 
 } // namespace VadFilterOnnx
@@ -0,0 +1,135 @@
+#include "vad/speech-filter.h"
+#include <algorithm>
+
+namespace VadFilterOnnx {
+
+SpeechFilter::SpeechFilter(int capacity, int fade) : capacity_(std::max(capacity, 1)), fade_(fade) {}
+
+void SpeechFilter::reset() {
+    pos_ = 0;
+    open_idx_ = -1;
+    open_start_ = 0;
+    emit_pos_ = 0;
+}
+
+float SpeechFilter::gain(int pos, int seg_start, int seg_end) const {
+    if (fade_ <= 0) {
+        return 1.0f;
+    }
+    float g = std::min(1.0f, (pos - seg_start + 0.5f) / fade_);
+    if (seg_end >= 0) {
+        g = std::min(g, (seg_end - pos - 0.5f) / fade_);
+    }
+    return g;
+}
+
+void SpeechFilter::emit(const float *data, int n, int idx, int seg_start, int begin, int end,
+                        int seg_end, std::vector<SpeechChunk> *chunks) {
+    size_t first = chunks->size();
+    // Ring samples below `overwritten` are replaced by this call's input, so they are copied
+    int64_t overwritten = pos_ + n - capacity_;
+    int64_t fade_in_end = fade_ > 0 ? static_cast<int64_t>(seg_start) + fade_ : INT64_MIN;
+    int64_t fade_out_begin = fade_ > 0 && seg_end >= 0 ? seg_end - fade_ : INT64_MAX;
+
+    // Older samples have left the ring; only reachable with an undersized capacity
+    int64_t p = std::max<int64_t>(begin, pos_ - capacity_);
+    while (p < end) {
+        int64_t q = end;
+        bool copy = false;
+        if (p < fade_in_end) {
+            q = std::min(q, fade_in_end);
+            copy = true;
+        } else if (p < fade_out_begin) {
+            q = std::min(q, fade_out_begin);
+        } else {
+            copy = true;
+        }
+        const float *src;
+        if (p < pos_) {
+            // Up to the end of the ring history or the wrap-around, whichever comes first
+            q = std::min(q, pos_);
+            q = std::min(q, (p / capacity_ + 1) * capacity_);
+            if (p < overwritten) {
+                q = std::min(q, overwritten);
+                copy = true;
+            }
+            src = ring_.data() + p % capacity_;
+        } else {
+            src = data + (p - pos_);
+        }
+
+        SpeechChunk chunk;
+        chunk.n = static_cast<int>(q - p);
+        chunk.idx = idx;
+        chunk.start = static_cast<int>(p);
+        if (copy) {
+            // Pointer fixed up once scratch_ stops growing
+            scratch_chunks_.emplace_back(chunks->size(), scratch_.size());
+            for (int i = 0; i < chunk.n; ++i) {
+                scratch_.push_back(src[i] * gain(chunk.start + i, seg_start, seg_end));
+            }
+        } else {
+            chunk.data = src;
+        }
+        chunks->push_back(chunk);
+        p = q;
+    }
+
+    if (seg_end >= 0) {
+        if (chunks->size() == first) {
+            // Nothing left of the segment: an empty chunk still marks its end
+            SpeechChunk chunk;
+            chunk.idx = idx;
+            chunk.start = end;
+            chunks->push_back(chunk);
+        }
+        chunks->back().segment_end = true;
+    }
+}
+
+void SpeechFilter::process(const float *data, int n, const std::vector<VadSegment> &events,
+                           int safe_end, std::vector<SpeechChunk> *chunks) {
+    chunks->clear();
+    scratch_.clear();
+    scratch_chunks_.clear();
+    if (ring_.empty()) {
+        ring_.resize(capacity_);
+    }
+
+    for (const auto &seg : events) {
+        if (seg.end == -1) {
+            open_idx_ = seg.idx;
+            open_start_ = seg.start;
+            emit_pos_ = seg.start;
+        } else if (seg.idx == open_idx_) {
+            emit(data, n, seg.idx, open_start_, emit_pos_, seg.end, seg.end, chunks);
+            open_idx_ = -1;
+        } else {
+            emit(data, n, seg.idx, seg.start, seg.start, seg.end, seg.end, chunks);
+        }
+    }
+    // The open segment's samples are final up to safe_end; the fade-out region waits for the end
+    if (open_idx_ != -1 && safe_end - fade_ > emit_pos_) {
+        emit(data, n, open_idx_, open_start_, emit_pos_, safe_end - fade_, -1, chunks);
+        emit_pos_ = safe_end - fade_;
+    }
+    for (const auto &[chunk, offset] : scratch_chunks_) {
+        (*chunks)[chunk].data = scratch_.data() + offset;
+    }
+
+    // Keep the newest input for segments that reach back into it later
+    int keep = std::min(n, capacity_);
+    int64_t p = pos_ + n - keep;
+    const float *src = data + (n - keep);
+    while (keep > 0) {
+        int offset = static_cast<int>(p % capacity_);
+        int count = std::min(keep, capacity_ - offset);
+        std::copy(src, src + count, ring_.data() + offset);
+        src += count;
+        p += count;
+        keep -= count;
+    }
+    pos_ += n;
+}
+
+} // namespace VadFilterOnnx
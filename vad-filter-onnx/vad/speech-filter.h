@@ -0,0 +1,49 @@
+#pragma once
+
+#include "vad-config.h"
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace VadFilterOnnx {
+
+/**
+ * @brief Turns the segment events of a decode() call into speech audio chunks.
+ *
+ * Keeps the last `capacity` input samples in a ring, enough to reach back to a segment start
+ * (speech window plus left padding) from the input of the call that opens it. Chunks are views
+ * into the caller's buffer or the ring; only faded samples, and ring samples that the current
+ * call overwrites, are copied to a scratch buffer. All views stay valid until the next call.
+ *
+ * Audio of an open segment is emitted up to `safe_end`, the earliest position its end can
+ * still take, less the fade; the rest follows when the segment closes.
+ */
+class SpeechFilter {
+  public:
+    SpeechFilter(int capacity, int fade);
+
+    // data: the n input samples just decoded; events: segments returned by that call, start
+    // only entries included. chunks is replaced.
+    void process(const float *data, int n, const std::vector<VadSegment> &events, int safe_end,
+                 std::vector<SpeechChunk> *chunks);
+    void reset();
+
+  private:
+    // Append chunks for input [begin, end) of the segment starting at seg_start; seg_end is the
+    // segment end once known, -1 while it is open
+    void emit(const float *data, int n, int idx, int seg_start, int begin, int end, int seg_end,
+              std::vector<SpeechChunk> *chunks);
+    float gain(int pos, int seg_start, int seg_end) const;
+
+    int capacity_;
+    int fade_;
+    std::vector<float> ring_;  // input sample p at ring_[p % capacity_], allocated on first use
+    int64_t pos_ = 0;          // input position of data[0] in the current call
+    int open_idx_ = -1;        // segment still open after the last call, -1 if none
+    int open_start_ = 0;
+    int emit_pos_ = 0;         // first sample of the open segment not emitted yet
+    std::vector<float> scratch_;
+    std::vector<std::pair<size_t, size_t>> scratch_chunks_; // (chunk, offset into scratch_)
+};
+
+} // namespace VadFilterOnnx
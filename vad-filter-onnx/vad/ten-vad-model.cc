@@ -15,55 +15,106 @@ bool is_ten_vad(const std::vector<const char *> &input_names,
 }
 
 void TenVadModel::init_state() {
-    if (h1_ == nullptr) {
-        h1_ = Ort::Value::CreateTensor<float>(allocator_, state_shape_.data(), state_shape_.size());
-        c1_ = Ort::Value::CreateTensor<float>(allocator_, state_shape_.data(), state_shape_.size());
-        h2_ = Ort::Value::CreateTensor<float>(allocator_, state_shape_.data(), state_shape_.size());
-        c2_ = Ort::Value::CreateTensor<float>(allocator_, state_shape_.data(), state_shape_.size());
-        conv_cache_ = Ort::Value::CreateTensor<float>(allocator_, cache_shape_.data(), cache_shape_.size());
+    if (inputs_[0].empty()) {
+        std::array<int64_t, 2> x_shape = { 1, frame_length_ };
+        auto prob_shape = GetOutputShape(session_, 0);
+        x_data_.resize(frame_length_);
+        prob_data_.resize(1);
+        for (int k = 0; k < 2; ++k) {
+            state_data_[k].resize(states_size_);
+        }
+        for (int k = 0; k < 2; ++k) {
+            // Inputs: input, h1, c1, h2, c2, cache
+            // Outputs: prob, h1, c1, h2, c2, cache
+            inputs_[k].push_back(
+                WrapTensor(x_data_.data(), x_data_.size(), x_shape.data(), x_shape.size()));
+            outputs_[k].push_back(WrapTensor(prob_data_.data(), prob_data_.size(),
+                                             prob_shape.data(), prob_shape.size()));
+            for (int i = 0; i < 4; ++i) {
+                inputs_[k].push_back(WrapTensor(state_data_[k].data() + i * state_size_,
+                                                state_size_, state_shape_.data(),
+                                                state_shape_.size()));
+                outputs_[k].push_back(WrapTensor(state_data_[1 - k].data() + i * state_size_,
+                                                 state_size_, state_shape_.data(),
+                                                 state_shape_.size()));
+            }
+            inputs_[k].push_back(WrapTensor(state_data_[k].data() + 4 * state_size_, cache_size_,
+                                            cache_shape_.data(), cache_shape_.size()));
+            outputs_[k].push_back(WrapTensor(state_data_[1 - k].data() + 4 * state_size_,
+                                             cache_size_, cache_shape_.data(),
+                                             cache_shape_.size()));
+        }
     }
-    Fill<float>(&h1_, 0.0f);
-    Fill<float>(&c1_, 0.0f);
-    Fill<float>(&h2_, 0.0f);
-    Fill<float>(&c2_, 0.0f);
-    Fill<float>(&conv_cache_, 0.0f);
+    cur_ = 0;
+    std::fill(state_data_[cur_].begin(), state_data_[cur_].end(), 0.0f);
 }
 
 std::unique_ptr<VadModel> TenVadModel::init(const VadConfig &config) {
+    if (!check_config(config)) {
+        return nullptr;
+    }
     // Stride 256, Window 768
     auto instance = std::make_unique<TenVadModel>(*this, config, 256, 768);
     instance->reset();
+    instance->warmup();
     return instance;
 }
 
-float TenVadModel::forward(float *data, int n) {
-    auto memory_info = Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
-    std::array<int64_t, 2> x_shape = { 1, n };
-    Ort::Value x = Ort::Value::CreateTensor(memory_info, data, n, x_shape.data(), x_shape.size());
+float TenVadModel::forward(const float *data, int n) {
+    std::copy(data, data + n, x_data_.begin());
+    session_->Run(Ort::RunOptions{ nullptr }, input_names_.data(), inputs_[cur_].data(),
+                  inputs_[cur_].size(), output_names_.data(), outputs_[cur_].data(),
+                  outputs_[cur_].size());
+    cur_ = 1 - cur_;
+    return prob_data_[0];
+}
+
+bool TenVadModel::forward_batch(VadModel *const *models, const float *const *frames, int batch,
+                                float *probs) {
+    int n = frame_length_;
+    batch_.x.resize(static_cast<size_t>(batch) * n);
+    for (int b = 0; b < batch; ++b) {
+        std::copy(frames[b], frames[b] + n, batch_.x.data() + static_cast<size_t>(b) * n);
+    }
+    std::array<int64_t, 2> x_shape = { batch, n };
+
+    // States are [1, 64] and the conv cache is [1, 2, 41]; stack them along the batch axis.
+    size_t offsets[5] = { 0, state_size_, 2 * state_size_, 3 * state_size_, 4 * state_size_ };
+    int inner[5] = { 64, 64, 64, 64, 2 * 41 };
+    std::array<int64_t, 2> state_shape = { batch, state_shape_[1] };
+    std::array<int64_t, 3> cache_shape = { batch, cache_shape_[1], cache_shape_[2] };
 
-    std::vector<Ort::Value> inputs;
-    inputs.reserve(6);
-    
-    // Inputs: input, h1, c1, h2, c2, cache
-    inputs.push_back(std::move(x));
-    inputs.push_back(std::move(h1_));
-    inputs.push_back(std::move(c1_));
-    inputs.push_back(std::move(h2_));
-    inputs.push_back(std::move(c2_));
-    inputs.push_back(std::move(conv_cache_));
+    auto &inputs = batch_.inputs;
+    inputs.clear();
+    inputs.push_back(WrapTensor(batch_.x.data(), batch_.x.size(), x_shape.data(), x_shape.size()));
+    batch_.src.resize(batch);
+    for (int k = 0; k < 5; ++k) {
+        std::vector<float> &state_data = batch_.states[k];
+        state_data.resize(static_cast<size_t>(batch) * inner[k]);
+        for (int b = 0; b < batch; ++b) {
+            auto *m = static_cast<TenVadModel *>(models[b]);
+            batch_.src[b] = m->state_data_[m->cur_].data() + offsets[k];
+        }
+        GatherBatch(batch_.src.data(), batch, 1, inner[k], state_data.data());
+        const int64_t *shape = (k < 4) ? state_shape.data() : cache_shape.data();
+        size_t rank = (k < 4) ? state_shape.size() : cache_shape.size();
+        inputs.push_back(WrapTensor(state_data.data(), state_data.size(), shape, rank));
+    }
 
     auto out = session_->Run(Ort::RunOptions{ nullptr }, input_names_.data(), inputs.data(),
                              inputs.size(), output_names_.data(), output_names_.size());
 
-    // Outputs: prob, h1, c1, h2, c2, cache
-    h1_ = std::move(out[1]);
-    c1_ = std::move(out[2]);
-    h2_ = std::move(out[3]);
-    c2_ = std::move(out[4]);
-    conv_cache_ = std::move(out[5]);
-
-    float prob = out[0].GetTensorData<float>()[0];
-    return prob;
+    batch_.dst.resize(batch);
+    for (int k = 0; k < 5; ++k) {
+        for (int b = 0; b < batch; ++b) {
+            auto *m = static_cast<TenVadModel *>(models[b]);
+            batch_.dst[b] = m->state_data_[m->cur_].data() + offsets[k];
+        }
+        ScatterBatch(out[k + 1].GetTensorData<float>(), batch, 1, inner[k], batch_.dst.data());
+    }
+    const float *out_probs = out[0].GetTensorData<float>();
+    std::copy(out_probs, out_probs + batch, probs);
+    return true;
 }
 
 } // namespace VadFilterOnnx
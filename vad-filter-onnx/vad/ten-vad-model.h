@@ -16,18 +16,27 @@ class TenVadModel : public VadModel {
 
     std::unique_ptr<VadModel> init(const VadConfig &config) override;
     void init_state() override;
-    float forward(float *data, int n) override;
+    float forward(const float *data, int n) override;
+    bool forward_batch(VadModel *const *models, const float *const *frames, int batch,
+                       float *probs) override;
+    std::vector<float> *recurrent_state() override { return &state_data_[cur_]; }
 
   private:
     VadType type_ = VadType::TenVad;
     static constexpr std::array<int64_t, 2> state_shape_{ 1, 64 };
     static constexpr std::array<int64_t, 3> cache_shape_{ 1, 2, 41 };
-    
-    Ort::Value h1_{ nullptr };
-    Ort::Value c1_{ nullptr };
-    Ort::Value h2_{ nullptr };
-    Ort::Value c2_{ nullptr };
-    Ort::Value conv_cache_{ nullptr };
+    static constexpr size_t state_size_ = 64;
+    static constexpr size_t cache_size_ = 2 * 41;
+    static constexpr size_t states_size_ = 4 * state_size_ + cache_size_;
+
+    // Preallocated tensors. h1, c1, h2, c2 and the conv cache are packed into one buffer,
+    // double-buffered: Run reads one set and writes the other.
+    std::vector<float> x_data_;
+    std::vector<float> prob_data_;
+    std::vector<float> state_data_[2];
+    std::vector<Ort::Value> inputs_[2];
+    std::vector<Ort::Value> outputs_[2];
+    int cur_ = 0;
 };
 
 } // namespace VadFilterOnnx
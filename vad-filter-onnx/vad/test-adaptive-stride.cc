@@ -0,0 +1,99 @@
+#include "vad-filter-onnx-cxx-api.h"
+#include "vad/test-fake-vad-model.h"
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using namespace VadFilterOnnx;
+
+// 1s tone followed by 3s of low noise, repeated; the onsets are not frame aligned
+static std::vector<float> make_audio(int sample_rate, int seconds) {
+    std::vector<float> audio(static_cast<size_t>(sample_rate) * seconds, 0.0f);
+    uint32_t seed = 1;
+    for (size_t i = 0; i < audio.size(); ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        audio[i] = 1e-3f * (static_cast<float>(seed >> 8) / (1 << 24) - 0.5f);
+        size_t t = (i + sample_rate / 7) % (4 * sample_rate);
+        if (t < static_cast<size_t>(sample_rate)) {
+            audio[i] += tone(i, sample_rate);
+        }
+    }
+    return audio;
+}
+
+int main(int argc, char *argv[]) {
+    std::cout << "Testing adaptive stride..." << std::endl;
+
+    VadConfig config;
+    config.enable_stats = true;
+    auto audio = make_audio(config.sample_rate, 40);
+
+    VadConfig strided_config = config;
+    strided_config.enable_adaptive_stride = true;
+
+    // A low but non-zero probability on background noise, like a real model on an idle stream
+    FakeVadModel handle(FakeVadParams{ .silence_prob = 0.02f, .warmup = true });
+    auto model = handle.init(config);
+    auto strided = handle.init(strided_config);
+    auto reference = closed(decode_all(*model, audio));
+    auto segments = closed(decode_all(*strided, audio));
+    VadStats stats = strided->stats();
+    std::cout << "FakeVadModel: " << segments.size() << " segments, "
+              << stats.inference_runs << " runs for " << stats.frames << " frames" << std::endl;
+    assert(!reference.empty() && reference.size() == segments.size());
+    assert(stats.frames == model->stats().frames);
+    assert(stats.inference_runs + stats.strided_frames == stats.frames);
+    assert(stats.inference_runs < model->stats().inference_runs);
+
+    // Onsets may be seen up to the latency bound late; ends are decided at full rate
+    int max_start_delay = 0;
+    for (size_t i = 0; i < segments.size(); ++i) {
+        int delay = segments[i].start_ms - reference[i].start_ms;
+        std::cout << "  segment " << i << ": start " << reference[i].start_ms << " -> "
+                  << segments[i].start_ms << " ms, end " << reference[i].end_ms << " -> "
+                  << segments[i].end_ms << " ms" << std::endl;
+        assert(delay >= 0 && delay <= strided_config.adaptive_stride_max_latency_ms);
+        assert(segments[i].end_ms == reference[i].end_ms);
+        max_start_delay = std::max(max_start_delay, delay);
+    }
+    std::cout << "max start delay " << max_start_delay << " ms" << std::endl;
+
+    // An idle stream settles on one evaluation per max stride (4 frames of 32ms)
+    std::vector<float> idle(audio.size());
+    for (size_t i = 0; i < idle.size(); ++i) {
+        idle[i] = audio[(i % config.sample_rate) + 2 * config.sample_rate];
+    }
+    auto idle_model = handle.init(strided_config);
+    auto idle_segments = closed(decode_all(*idle_model, idle));
+    assert(idle_segments.empty());
+    VadStats idle_stats = idle_model->stats();
+    std::cout << "idle: " << idle_stats.inference_runs << " runs for " << idle_stats.frames
+              << " frames" << std::endl;
+    assert(idle_stats.inference_runs * 3 < idle_stats.frames);
+
+    // Optional: cost and accuracy of a real model, e.g. public/models/silero_vad.v5.onnx
+    if (argc > 1) {
+        auto api_handle = AutoVadModel::create(argv[1]);
+        if (!api_handle) {
+            return 1;
+        }
+        auto instance = api_handle->init(config);
+        auto strided_instance = api_handle->init(strided_config);
+        std::vector<float> copy = audio;
+        auto ref = instance->decode(copy.data(), static_cast<int>(copy.size()), true);
+        copy = audio;
+        auto segs = strided_instance->decode(copy.data(), static_cast<int>(copy.size()), true);
+        VadStats s = strided_instance->stats();
+        std::cout << argv[1] << ": " << ref.size() << " vs " << segs.size() << " segments, "
+                  << s.inference_runs << " runs for " << s.frames << " frames" << std::endl;
+        for (size_t i = 0; i < std::min(ref.size(), segs.size()); ++i) {
+            std::cout << "  segment " << i << ": start " << ref[i].start_ms << " -> "
+                      << segs[i].start_ms << " ms" << std::endl;
+        }
+    }
+
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,200 @@
+#include "vad/audio-framer.h"
+#include <algorithm>
+#include <cassert>
+#include <climits>
+#include <iostream>
+#include <vector>
+
+using namespace VadFilterOnnx;
+
+// Sample i of the stream has the value i, so a view shows where it was taken from
+static std::vector<float> ramp(int n) {
+    std::vector<float> x(n);
+    for (int i = 0; i < n; ++i) {
+        x[i] = static_cast<float>(i);
+    }
+    return x;
+}
+
+static void check_samples(const float *p, int first, int len) {
+    for (int i = 0; i < len; ++i) {
+        assert(p[i] == static_cast<float>(first + i));
+    }
+}
+
+static bool inside(const float *p, const float *chunk, int n) {
+    return p >= chunk && p < chunk + n;
+}
+
+// Frame a ramp of `total` samples fed in chunks cycling through `chunks`. Returns the number
+// of frames; every frame is checked, and frames that do not touch carried samples must be
+// views into the caller's chunk.
+static int run_chunks(int frame_length, int frame_shift, int total, const std::vector<int> &chunks,
+                      int *stitched) {
+    AudioFramer framer(frame_length, frame_shift);
+    auto x = ramp(total);
+    int frames = 0;
+    int offset = 0; // stream position of the current chunk
+    *stitched = 0;
+    for (size_t c = 0; offset < total; ++c) {
+        int n = std::min(chunks[c % chunks.size()], total - offset);
+        const float *chunk = x.data() + offset;
+        framer.push(chunk, n);
+        while (const float *frame = framer.next()) {
+            int start = frames * frame_shift;
+            check_samples(frame, start, frame_length);
+            if (start >= offset) {
+                assert(inside(frame, chunk, n));
+            } else {
+                // Starts in the carried samples
+                assert(!inside(frame, chunk, n));
+                *stitched += start + frame_length > offset;
+            }
+            frames++;
+        }
+        framer.stash();
+        offset += n;
+        // Everything not yet framed is carried, never more than a frame
+        assert(framer.buffered() == offset - frames * frame_shift);
+        assert(framer.buffered() < frame_length);
+    }
+    return frames;
+}
+
+int main() {
+    std::cout << "Testing AudioFramer..." << std::endl;
+
+    // Chunks shorter than a frame: frames are assembled from several chunks
+    {
+        int stitched;
+        int frames = run_chunks(400, 160, 16000, { 37, 1, 150, 399 }, &stitched);
+        assert(frames == (16000 - 400) / 160 + 1);
+        assert(stitched > 0);
+        std::cout << "short chunks: " << frames << " frames, " << stitched << " stitched"
+                  << std::endl;
+    }
+
+    // Frames spanning the carry boundary, with and without overlap, and chunks of exactly
+    // one frame
+    {
+        int stitched;
+        int frames = run_chunks(512, 512, 16000, { 1000, 700, 512, 3000 }, &stitched);
+        assert(frames == 16000 / 512);
+        assert(stitched > 0);
+        frames = run_chunks(400, 160, 16000, { 1000, 700, 512, 3000 }, &stitched);
+        assert(frames == (16000 - 400) / 160 + 1);
+        assert(stitched > 0);
+        // A chunk that is a multiple of the shift never leaves a straddling frame
+        frames = run_chunks(512, 512, 16384, { 1024 }, &stitched);
+        assert(frames == 32 && stitched == 0);
+        std::cout << "carry boundary: ok" << std::endl;
+    }
+
+    // peek() past the buffered data: the lookahead is clamped to the chunk
+    {
+        auto x = ramp(2000);
+        AudioFramer framer(400, 160);
+        framer.push(x.data(), 300);
+        const float *none = framer.next();
+        assert(none == nullptr);
+        framer.stash();
+        assert(framer.buffered() == 300);
+
+        framer.push(x.data() + 300, 200);
+        assert(framer.available() == 500);
+        int len = 0;
+        const float *p = framer.peek(1000, &len);
+        assert(len == 500);
+        check_samples(p, 0, len);
+        p = framer.peek(50, &len);
+        assert(len == 350);
+        check_samples(p, 0, len);
+        p = framer.peek(0, &len);
+        assert(len == 300);
+        check_samples(p, 0, len);
+
+        // Once the carried samples are consumed, peek() is a view of the rest of the chunk
+        framer.consume(320);
+        p = framer.peek(1000, &len);
+        assert(len == 180 && inside(p, x.data() + 300, 200));
+        check_samples(p, 320, len);
+        std::cout << "peek: ok" << std::endl;
+    }
+
+    // stash() after a partial consume, inside the carried samples and inside the chunk. The
+    // carry grows past its capacity when more than a frame is left.
+    {
+        auto x = ramp(6000);
+        AudioFramer framer(400, 160);
+        framer.push(x.data(), 1000);
+        framer.consume(160);
+        framer.stash();
+        assert(framer.buffered() == 840);
+
+        framer.push(x.data() + 1000, 500);
+        framer.consume(320); // still inside the carry
+        framer.stash();
+        assert(framer.buffered() == 1020);
+        int len = 0;
+        const float *p = framer.peek(0, &len);
+        assert(len == 1020);
+        check_samples(p, 480, len);
+
+        framer.push(x.data() + 1500, 700);
+        framer.consume(1100); // past the carry, into the chunk
+        framer.stash();
+        assert(framer.buffered() == 620);
+
+        // Frames pick up exactly where the consumes left off
+        framer.push(x.data() + 2200, 1000);
+        int start = 1580;
+        while (const float *frame = framer.next()) {
+            check_samples(frame, start, 400);
+            start += 160;
+        }
+        assert(start + 400 > 3200 && start + 400 - 160 <= 3200);
+        framer.stash();
+        assert(framer.buffered() == 3200 - start);
+        std::cout << "partial consume: ok" << std::endl;
+    }
+
+    // input_finished with a remainder: the tail shorter than a frame stays readable through
+    // peek() (FSMN decodes it), and reset() drops it
+    {
+        auto x = ramp(1000);
+        AudioFramer framer(400, 160);
+        framer.push(x.data(), 700);
+        int frames = 0;
+        while (framer.next()) {
+            frames++;
+        }
+        framer.stash();
+        assert(frames == 2 && framer.buffered() == 380);
+
+        framer.push(x.data() + 700, 300);
+        while (const float *frame = framer.next()) {
+            check_samples(frame, frames * 160, 400);
+            frames++;
+        }
+        assert(frames == 4);
+        int remainder = framer.available();
+        assert(remainder == 1000 - 4 * 160);
+        int len = 0;
+        const float *p = framer.peek(INT_MAX, &len);
+        assert(len == remainder);
+        check_samples(p, 640, len);
+
+        framer.reset();
+        assert(framer.buffered() == 0 && framer.available() == 0);
+        const float *none = framer.next();
+        assert(none == nullptr);
+        // A fresh stream starts from its own first sample
+        framer.push(x.data() + 100, 400);
+        const float *frame = framer.next();
+        assert(frame == x.data() + 100);
+        std::cout << "input finished: remainder of " << remainder << " samples" << std::endl;
+    }
+
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,177 @@
+#include "vad/test-fake-vad-model.h"
+#include "vad/vad-batch-engine.h"
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <vector>
+
+using namespace VadFilterOnnx;
+
+// Decision depends on the sample rate it is told, like Silero's `sr` input: forward_batch()
+// scores every frame with the rate of the instance it runs on
+class RateFakeVadModel : public FakeVadModel {
+  public:
+    RateFakeVadModel() : FakeVadModel(FakeVadParams{ .silence_prob = 0.05f, .warmup = true }) {}
+    using FakeVadModel::FakeVadModel;
+
+    float forward(const float *data, int n) override { return rate_score(data, n); }
+    bool forward_batch(VadModel *const * /*models*/, const float *const *frames, int batch,
+                       float *probs) override {
+        for (int b = 0; b < batch; ++b) {
+            probs[b] = rate_score(frames[b], frame_length_);
+        }
+        batched_frames += batch;
+        return true;
+    }
+
+    static inline int batched_frames = 0;
+
+  protected:
+    std::unique_ptr<FakeVadModel> instantiate(const VadConfig &config) override {
+        return std::make_unique<RateFakeVadModel>(*this, config);
+    }
+
+  private:
+    float rate_score(const float *data, int n) const {
+        float threshold = config_.sample_rate == 16000 ? 1e-3f : 2e-2f;
+        return mean_square(data, n) > threshold ? params.speech_prob : params.silence_prob;
+    }
+};
+
+// Loud and quiet tone bursts with digital silence in between. The quiet ones (mean square
+// 0.005) are speech at 16 kHz and silence at 8 kHz.
+static std::vector<float> make_audio(int sample_rate, int seconds, int phase) {
+    std::vector<float> audio(static_cast<size_t>(sample_rate) * seconds, 0.0f);
+    for (size_t i = 0; i < audio.size(); ++i) {
+        int t = static_cast<int>((i + static_cast<size_t>(phase) * sample_rate / 3) / sample_rate);
+        audio[i] = tone(i, sample_rate, t % 4 == 0 ? 0.5f : (t % 4 == 2 ? 0.1f : 0.0f));
+    }
+    return audio;
+}
+
+static void check_same(const std::vector<VadSegment> &a, const std::vector<VadSegment> &b) {
+    assert(a.size() == b.size());
+    for (size_t i = 0; i < a.size(); ++i) {
+        assert(a[i].idx == b[i].idx && a[i].start == b[i].start && a[i].end == b[i].end);
+    }
+}
+
+struct Expected {
+    std::vector<VadSegment> segments;
+    VadStats stats;
+};
+
+static Expected decode_alone(VadModel &handle, const VadConfig &config,
+                             const std::vector<float> &audio, int chunk) {
+    auto model = handle.init(config);
+    Expected expected;
+    expected.segments = closed(decode_all(*model, audio, chunk));
+    expected.stats = model->stats();
+    return expected;
+}
+
+// Feed every stream in chunks of its own size, one run() per round
+static std::vector<std::vector<VadSegment>> run_engine(
+    VadBatchEngine &engine, const std::vector<int> &ids,
+    const std::vector<std::vector<float>> &audio, const std::vector<int> &chunks) {
+    std::vector<std::vector<VadSegment>> result(ids.size());
+    std::vector<size_t> pos(ids.size(), 0);
+    bool pending = true;
+    while (pending) {
+        pending = false;
+        for (size_t k = 0; k < ids.size(); ++k) {
+            if (pos[k] >= audio[k].size()) {
+                continue;
+            }
+            size_t n = std::min(static_cast<size_t>(chunks[k]), audio[k].size() - pos[k]);
+            engine.accept(ids[k], audio[k].data() + pos[k], static_cast<int>(n),
+                          pos[k] + n == audio[k].size());
+            pos[k] += n;
+            pending = true;
+        }
+        engine.run();
+        for (size_t k = 0; k < ids.size(); ++k) {
+            auto segs = engine.fetch(ids[k]);
+            result[k].insert(result[k].end(), segs.begin(), segs.end());
+        }
+    }
+    for (auto &segs : result) {
+        segs = closed(segs);
+    }
+    return result;
+}
+
+int main() {
+    std::cout << "Testing VadBatchEngine..." << std::endl;
+    RateFakeVadModel handle;
+
+    // 8 kHz and 16 kHz streams share the frame length, but not a batch
+    {
+        auto engine = VadBatchEngine::create(&handle, 8);
+        std::vector<VadConfig> configs;
+        std::vector<int> ids;
+        std::vector<std::vector<float>> audio;
+        std::vector<int> chunks;
+        for (int k = 0; k < 6; ++k) {
+            VadConfig config;
+            config.sample_rate = k % 2 ? 8000 : 16000;
+            configs.push_back(config);
+            ids.push_back(engine->add_stream(config));
+            audio.push_back(make_audio(config.sample_rate, 20, k));
+            chunks.push_back(config.sample_rate / 10 + 37 * k);
+        }
+        auto result = run_engine(*engine, ids, audio, chunks);
+        for (size_t k = 0; k < ids.size(); ++k) {
+            auto expected = decode_alone(handle, configs[k], audio[k], chunks[k]);
+            assert(!expected.segments.empty());
+            check_same(result[k], expected.segments);
+        }
+        // The quiet bursts tell the rates apart
+        assert(result[0].size() > result[1].size());
+        assert(RateFakeVadModel::batched_frames > 0);
+        std::cout << "mixed rates: " << result[0].size() << " segments at 16 kHz, "
+                  << result[1].size() << " at 8 kHz, " << RateFakeVadModel::batched_frames
+                  << " batched frames" << std::endl;
+    }
+
+    // Energy gate, adaptive stride and stats behave as in decode()
+    {
+        auto engine = VadBatchEngine::create(&handle, 8);
+        std::vector<VadConfig> configs;
+        std::vector<int> ids;
+        std::vector<std::vector<float>> audio;
+        std::vector<int> chunks;
+        for (int k = 0; k < 4; ++k) {
+            VadConfig config;
+            config.enable_stats = true;
+            config.enable_energy_gate = k % 2 == 0;
+            config.enable_adaptive_stride = k >= 2;
+            configs.push_back(config);
+            ids.push_back(engine->add_stream(config));
+            audio.push_back(make_audio(config.sample_rate, 20, k));
+            chunks.push_back(1600);
+        }
+        auto result = run_engine(*engine, ids, audio, chunks);
+        uint64_t total_frames = 0;
+        for (size_t k = 0; k < ids.size(); ++k) {
+            auto expected = decode_alone(handle, configs[k], audio[k], chunks[k]);
+            check_same(result[k], expected.segments);
+            VadStats stats = engine->stats(ids[k]);
+            assert(stats.samples == expected.stats.samples);
+            assert(stats.frames == expected.stats.frames && stats.frames > 0);
+            assert(stats.gated_frames == expected.stats.gated_frames);
+            assert(stats.strided_frames == expected.stats.strided_frames);
+            assert(stats.inference_runs == expected.stats.inference_runs);
+            assert(stats.segments == expected.stats.segments);
+            assert((stats.gated_frames > 0) == configs[k].enable_energy_gate);
+            assert((stats.strided_frames > 0) == configs[k].enable_adaptive_stride);
+            total_frames += stats.frames;
+        }
+        // Includes the per-stream decodes above
+        assert(handle.handle_stats().frames >= 2 * total_frames);
+        std::cout << "gate and stride: " << total_frames << " frames with stats" << std::endl;
+    }
+
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
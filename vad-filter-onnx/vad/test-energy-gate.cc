@@ -0,0 +1,112 @@
+#include "vad-filter-onnx-cxx-api.h"
+#include "vad/test-fake-vad-model.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using namespace VadFilterOnnx;
+
+// Recurrent stand-in for a real model: the probability is a leaky average of an energy
+// indicator, so the state left by silence matters for the next frames.
+class GateFakeVadModel : public FakeVadModel {
+  public:
+    GateFakeVadModel() : FakeVadModel(FakeVadParams{ .warmup = true }) {}
+    using FakeVadModel::FakeVadModel;
+
+    void init_state() override { state_.assign(2, 0.3f); }
+    float forward(const float *data, int n) override {
+        float speech = mean_square(data, n) > params.threshold ? 1.0f : 0.0f;
+        state_[0] = 0.5f * state_[0] + 0.5f * speech;
+        state_[1] = 0.5f * state_[1] + 0.5f * state_[0];
+        return state_[1];
+    }
+    std::vector<float> *recurrent_state() override { return &state_; }
+
+  protected:
+    std::unique_ptr<FakeVadModel> instantiate(const VadConfig &config) override {
+        return std::make_unique<GateFakeVadModel>(*this, config);
+    }
+
+  private:
+    std::vector<float> state_;
+};
+
+// Largest boundary difference in ms, or -1 if the segment counts differ
+static int max_deviation_ms(const std::vector<VadSegment> &a, const std::vector<VadSegment> &b) {
+    if (a.size() != b.size()) {
+        return -1;
+    }
+    int deviation = 0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        deviation = std::max(deviation, std::abs(a[i].start_ms - b[i].start_ms));
+        deviation = std::max(deviation, std::abs(a[i].end_ms - b[i].end_ms));
+    }
+    return deviation;
+}
+
+int main(int argc, char *argv[]) {
+    std::cout << "Testing energy gate..." << std::endl;
+
+    VadConfig config;
+    config.enable_stats = true;
+    auto audio = alternating_tone(config.sample_rate, 20);
+
+    VadConfig gated_config = config;
+    gated_config.enable_energy_gate = true;
+
+    GateFakeVadModel handle;
+    auto model = handle.init(config);
+    auto gated = handle.init(gated_config);
+    auto reference = decode_all(*model, audio);
+    auto segments = decode_all(*gated, audio);
+    VadStats stats = gated->stats();
+    int deviation = max_deviation_ms(reference, segments);
+    std::cout << "FakeVadModel: " << reference.size() << " segments, gated "
+              << stats.gated_frames << "/" << stats.frames << " frames, max deviation "
+              << deviation << " ms" << std::endl;
+    assert(!reference.empty());
+    assert(stats.frames == model->stats().frames);
+    assert(stats.inference_runs + stats.gated_frames == stats.frames);
+    // Every silent frame but the ones straddling a tone boundary is skipped
+    assert(stats.gated_frames * 100 > stats.frames * 45);
+    assert(model->stats().gated_frames == 0);
+    // Skipping the decay tail moves a boundary by at most two frames
+    assert(deviation >= 0 && deviation <= 64);
+
+    // The gate is transparent to audio above the threshold
+    std::vector<float> loud(audio.size());
+    for (size_t i = 0; i < loud.size(); ++i) {
+        loud[i] = audio[i] + 0.01f * ((i * 7919) % 13 - 6.0f) / 6.0f;
+    }
+    auto loud_model = handle.init(config);
+    auto gated_loud = handle.init(gated_config);
+    int loud_deviation =
+        max_deviation_ms(decode_all(*loud_model, loud), decode_all(*gated_loud, loud));
+    assert(gated_loud->stats().gated_frames == 0);
+    assert(loud_deviation == 0);
+
+    // Optional: deviation and skip ratio of a real model, e.g. public/models/silero_vad.v5.onnx
+    if (argc > 1) {
+        auto api_handle = AutoVadModel::create(argv[1]);
+        if (!api_handle) {
+            return 1;
+        }
+        auto instance = api_handle->init(config);
+        auto gated_instance = api_handle->init(gated_config);
+        std::vector<float> copy = audio;
+        auto ref = instance->decode(copy.data(), static_cast<int>(copy.size()), true);
+        copy = audio;
+        auto segs = gated_instance->decode(copy.data(), static_cast<int>(copy.size()), true);
+        VadStats s = gated_instance->stats();
+        std::cout << argv[1] << ": " << ref.size() << " vs " << segs.size()
+                  << " segments, max deviation " << max_deviation_ms(ref, segs) << " ms, skipped "
+                  << 100.0 * s.gated_frames / std::max<uint64_t>(s.frames, 1) << "% of frames"
+                  << std::endl;
+    }
+
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,130 @@
+#pragma once
+#include "vad/vad-model.h"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+// Shared by the vad/test-*.cc programs: a model that needs no ONNX session, and the helpers
+// most tests use to feed it.
+
+namespace VadFilterOnnx {
+
+// Frame geometry and scores of the fake models
+struct FakeVadParams {
+    int frame_shift = 512;
+    int frame_length = 512;
+    float threshold = 1e-3f; // mean square above which a frame is speech
+    float speech_prob = 0.9f;
+    float silence_prob = 0.1f;
+    bool warmup = false;  // init() runs the session warm-up like the real models
+    int init_budget = -1; // init() fails once this runs out; -1: unlimited
+};
+
+// Stateless energy detector, so any instance scores a frame the same way regardless of what
+// it decoded before. Variants override instantiate() to create their own type.
+class FakeVadModel : public VadModel {
+  public:
+    FakeVadModel() = default;
+    explicit FakeVadModel(const FakeVadParams &params) : params(params) {}
+    FakeVadModel(const FakeVadModel &other, const VadConfig &config)
+        : VadModel(other, config, other.params.frame_shift, other.params.frame_length),
+          params(other.params) {}
+
+    std::unique_ptr<VadModel> init(const VadConfig &config) override {
+        if (params.init_budget == 0) {
+            return nullptr;
+        }
+        if (params.init_budget > 0) {
+            params.init_budget--;
+        }
+        auto instance = instantiate(config);
+        instance->reset();
+        if (params.warmup) {
+            instance->warmup();
+        }
+        return instance;
+    }
+    void init_state() override {}
+    float forward(const float *data, int n) override { return score(mean_square(data, n)); }
+
+    FakeVadParams params;
+
+  protected:
+    virtual std::unique_ptr<FakeVadModel> instantiate(const VadConfig &config) {
+        return std::make_unique<FakeVadModel>(*this, config);
+    }
+    float score(float energy) const {
+        return energy > params.threshold ? params.speech_prob : params.silence_prob;
+    }
+    static float mean_square(const float *data, int n) {
+        float energy = 0.0f;
+        for (int i = 0; i < n; ++i) {
+            energy += data[i] * data[i];
+        }
+        return energy / n;
+    }
+};
+
+// Smoothed energy as recurrent state, so a stream decoded with another stream's state, or with
+// its frames out of order, gives different segments
+class RecurrentFakeVadModel : public FakeVadModel {
+  public:
+    using FakeVadModel::FakeVadModel;
+
+    void init_state() override { smoothed_ = 0.0f; }
+    float forward(const float *data, int n) override {
+        smoothed_ = 0.7f * smoothed_ + 0.3f * mean_square(data, n);
+        return score(smoothed_);
+    }
+
+  protected:
+    std::unique_ptr<FakeVadModel> instantiate(const VadConfig &config) override {
+        return std::make_unique<RecurrentFakeVadModel>(*this, config);
+    }
+
+  private:
+    float smoothed_ = 0.0f;
+};
+
+// Sample i of a 440 Hz tone
+inline float tone(size_t i, int sample_rate, float amplitude = 0.5f) {
+    return amplitude * std::sin(2.0f * 3.14159265f * 440.0f * i / sample_rate);
+}
+
+// 1 s of tone followed by 1 s of silence, repeated
+inline std::vector<float> alternating_tone(int sample_rate, int seconds) {
+    std::vector<float> audio(static_cast<size_t>(sample_rate) * seconds, 0.0f);
+    for (size_t i = 0; i < audio.size(); ++i) {
+        if ((i / sample_rate) % 2 == 0) {
+            audio[i] = tone(i, sample_rate);
+        }
+    }
+    return audio;
+}
+
+inline std::vector<VadSegment> closed(const std::vector<VadSegment> &segs) {
+    std::vector<VadSegment> result;
+    for (const auto &seg : segs) {
+        if (seg.end != -1) {
+            result.push_back(seg);
+        }
+    }
+    return result;
+}
+
+// Every segment event of `audio` fed in chunks, the last one with input_finished. decode()
+// may write to its input, so the audio is taken by value.
+inline std::vector<VadSegment> decode_all(VadModel &model, std::vector<float> audio,
+                                          int chunk = 1600) {
+    std::vector<VadSegment> segments;
+    int total = static_cast<int>(audio.size());
+    for (int i = 0; i < total; i += chunk) {
+        int n = std::min(chunk, total - i);
+        auto segs = model.decode(audio.data() + i, n, i + n == total);
+        segments.insert(segments.end(), segs.begin(), segs.end());
+    }
+    return segments;
+}
+
+} // namespace VadFilterOnnx
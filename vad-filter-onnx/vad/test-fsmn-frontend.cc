@@ -0,0 +1,124 @@
+#include "utils/fbank.h"
+#include "vad/fsmn-frontend.h"
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+using namespace VadFilterOnnx;
+
+static const double kPi = 3.14159265358979323846;
+
+static double hz_to_mel(double hz) { return 2595.0 * std::log10(1.0 + hz / 700.0); }
+
+// Direct port of scripts/filter_fbank.py (DFT path) in double precision
+static std::vector<double> reference_fbank(const std::vector<float> &frame, int sample_rate) {
+    int len = static_cast<int>(frame.size());
+    int n_fft = 1;
+    while (n_fft < len) {
+        n_fft <<= 1;
+    }
+    double mean = 0.0;
+    for (float v : frame) {
+        mean += v;
+    }
+    mean /= len;
+    std::vector<double> x(n_fft, 0.0);
+    for (int i = 0; i < len; ++i) {
+        double cur = frame[i] - mean;
+        double prev = i ? frame[i - 1] - mean : cur;
+        x[i] = (cur - 0.97 * prev) * (0.54 - 0.46 * std::cos(2.0 * kPi * i / (len - 1)));
+    }
+    std::vector<double> power(n_fft / 2);
+    for (int k = 0; k < n_fft / 2; ++k) {
+        double re = 0.0, im = 0.0;
+        for (int n = 0; n < n_fft; ++n) {
+            re += x[n] * std::cos(2.0 * kPi * k * n / n_fft);
+            im -= x[n] * std::sin(2.0 * kPi * k * n / n_fft);
+        }
+        power[k] = re * re + im * im;
+    }
+    double mel_low = hz_to_mel(20.0), mel_high = hz_to_mel(sample_rate / 2.0);
+    double delta = (mel_high - mel_low) / 81;
+    std::vector<double> out(80);
+    for (int b = 0; b < 80; ++b) {
+        double left = mel_low + b * delta, center = left + delta, right = center + delta;
+        double energy = 0.0;
+        for (int i = 0; i < n_fft / 2; ++i) {
+            double mel = hz_to_mel(static_cast<double>(sample_rate) / n_fft * i);
+            if (mel > left && mel < right) {
+                energy += power[i] * (mel <= center ? (mel - left) / (center - left)
+                                                    : (right - mel) / (right - center));
+            }
+        }
+        out[b] = std::log(std::max(energy, static_cast<double>(FLT_EPSILON)));
+    }
+    return out;
+}
+
+int main() {
+    std::cout << "Testing FSMN frontend..." << std::endl;
+
+    for (int sample_rate : { 8000, 16000 }) {
+        Fbank fbank(sample_rate);
+        std::vector<float> frame(fbank.frame_length());
+        srand(sample_rate);
+        for (auto &v : frame) {
+            v = static_cast<float>(rand() % 20001 - 10000);
+        }
+        std::vector<float> out(fbank.dim());
+        fbank.compute(frame.data(), out.data());
+        auto ref = reference_fbank(frame, sample_rate);
+        double max_err = 0.0;
+        for (int b = 0; b < fbank.dim(); ++b) {
+            max_err = std::max(max_err, std::abs(ref[b] - out[b]));
+        }
+        std::cout << sample_rate << " Hz fbank: max abs error " << max_err << std::endl;
+        assert(max_err < 1e-3);
+    }
+
+    // LFR stacking with replicated edges and CMVN
+    const int sample_rate = 16000;
+    auto cmvn = std::make_shared<std::vector<float>>(2 * FsmnFrontend::kLfrM * 80);
+    for (size_t i = 0; i < cmvn->size(); ++i) {
+        (*cmvn)[i] = i < cmvn->size() / 2 ? -0.01f * (i % 80) : 1.0f + 0.001f * (i % 7);
+    }
+    for (int num_frames : { 1, 2, 3, 7 }) {
+        FsmnFrontend frontend(sample_rate, cmvn);
+        Fbank fbank(sample_rate);
+        int len = frontend.frame_length();
+        std::vector<std::vector<float>> frames(num_frames, std::vector<float>(len));
+        std::vector<std::vector<float>> fb(num_frames, std::vector<float>(80));
+        std::vector<float> scaled(len);
+        std::vector<float> feats;
+        for (int f = 0; f < num_frames; ++f) {
+            for (int i = 0; i < len; ++i) {
+                frames[f][i] = 0.3f * std::sin(0.01f * (f * 160 + i) * (f + 1));
+                scaled[i] = frames[f][i] * 32768.0f;
+            }
+            fbank.compute(scaled.data(), fb[f].data());
+            frontend.accept(frames[f].data(), &feats);
+            // Output t needs fbank frame t + 2
+            assert(static_cast<int>(feats.size()) == std::max(0, f - 1) * frontend.dim());
+        }
+        frontend.finish(&feats);
+        assert(static_cast<int>(feats.size()) == num_frames * frontend.dim());
+        for (int t = 0; t < num_frames; ++t) {
+            for (int j = 0; j < FsmnFrontend::kLfrM; ++j) {
+                int src = std::clamp(t - 2 + j, 0, num_frames - 1);
+                for (int d = 0; d < 80; ++d) {
+                    int k = j * 80 + d;
+                    float expected = (fb[src][d] + (*cmvn)[k]) * (*cmvn)[frontend.dim() + k];
+                    assert(std::abs(feats[t * frontend.dim() + k] - expected) < 1e-5f);
+                }
+            }
+        }
+    }
+
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
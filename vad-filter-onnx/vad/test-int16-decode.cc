@@ -0,0 +1,82 @@
+#include "utils/cpu-features.h"
+#include "utils/simd-kernels.h"
+#include "vad/test-fake-vad-model.h"
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using namespace VadFilterOnnx;
+
+int main() {
+    std::cout << "Testing int16 decode..." << std::endl;
+    const CpuFeatures &cpu = GetCpuFeatures();
+    std::cout << "CPU features: sse4.1=" << cpu.sse41 << " avx2=" << cpu.avx2
+              << " neon=" << cpu.neon << std::endl;
+
+    // Dispatched kernel matches the scalar definition, incl. tails and extreme values
+    srand(1);
+    for (int n : { 0, 1, 7, 8, 15, 16, 17, 31, 100, 4097 }) {
+        std::vector<int16_t> src(n);
+        for (auto &v : src) {
+            v = static_cast<int16_t>(rand() % 65536 - 32768);
+        }
+        if (n > 1) {
+            src[0] = -32768;
+            src[1] = 32767;
+        }
+        std::vector<float> dst(n);
+        Int16ToFloat(src.data(), n, dst.data());
+        for (int i = 0; i < n; ++i) {
+            assert(dst[i] == static_cast<float>(src[i]) * (1.0f / 32768.0f));
+        }
+    }
+
+    // 1s tone / 1s silence, decoded as int16 and as float in RTP-sized packets
+    VadConfig config;
+    std::vector<int16_t> pcm(config.sample_rate * 20);
+    std::vector<float> audio(pcm.size());
+    for (size_t i = 0; i < pcm.size(); ++i) {
+        if ((i / config.sample_rate) % 2 == 0) {
+            pcm[i] = static_cast<int16_t>(16000 * std::sin(0.1 * i));
+        }
+        audio[i] = pcm[i] / 32768.0f;
+    }
+
+    // Overlapping frames, so the int16 path also carries samples between frames
+    FakeVadModel handle(FakeVadParams{ .frame_shift = 512, .frame_length = 576 });
+    auto a = handle.init(config);
+    auto b = handle.init(config);
+    std::vector<VadSegment> expected, actual;
+    int chunk = 160;
+    for (size_t i = 0; i < pcm.size(); i += chunk) {
+        int n = static_cast<int>(std::min<size_t>(chunk, pcm.size() - i));
+        bool last = i + n >= pcm.size();
+        for (auto &seg : a->decode(audio.data() + i, n, last)) {
+            expected.push_back(seg);
+        }
+        for (auto &seg : b->decode(pcm.data() + i, n, last)) {
+            actual.push_back(seg);
+        }
+    }
+    // One call with more samples than a conversion block
+    auto c = handle.init(config);
+    auto whole = c->decode(pcm.data(), static_cast<int>(pcm.size()), true);
+
+    std::cout << "float: " << expected.size() << " segments, int16: " << actual.size()
+              << " segments, int16 in one call: " << whole.size() << " segments" << std::endl;
+    assert(!expected.empty());
+    assert(actual.size() == expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        assert(actual[i].start == expected[i].start && actual[i].end == expected[i].end);
+    }
+    int num_closed = 0;
+    for (auto &seg : expected) {
+        num_closed += seg.end >= 0;
+    }
+    assert(static_cast<int>(whole.size()) == num_closed);
+
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
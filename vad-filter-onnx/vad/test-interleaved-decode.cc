@@ -0,0 +1,78 @@
+#include "vad/test-fake-vad-model.h"
+#include <cassert>
+#include <iostream>
+#include <vector>
+
+using namespace VadFilterOnnx;
+
+// Stereo frames, each channel a tone or silence
+static std::vector<float> stereo(int sample_rate, int frames, bool left, bool right) {
+    std::vector<float> audio(static_cast<size_t>(frames) * 2, 0.0f);
+    for (int i = 0; i < frames; ++i) {
+        audio[2 * i] = left ? tone(i, sample_rate) : 0.0f;
+        audio[2 * i + 1] = right ? tone(i, sample_rate) : 0.0f;
+    }
+    return audio;
+}
+
+static int count_channel(const std::vector<VadSegment> &segs, int channel) {
+    int n = 0;
+    for (const auto &seg : segs) {
+        n += seg.channel == channel;
+    }
+    return n;
+}
+
+int main() {
+    std::cout << "Testing decode_interleaved..." << std::endl;
+    FakeVadModel handle;
+    VadConfig config;
+    const int rate = config.sample_rate;
+
+    // Both channels in speech, closed by flush_channels()
+    {
+        auto model = handle.init(config);
+        auto speech = stereo(rate, rate, true, true);
+        model->decode_interleaved(speech.data(), rate, 2, ChannelMode::PerChannel, false);
+        auto segs = closed(model->flush_channels());
+        assert(segs.size() == 2);
+        assert(segs[0].channel == 0 && segs[1].channel == 1);
+        assert(closed(model->flush_channels()).empty());
+    }
+
+    // Switching to Downmix closes channel 1, which starts over when fed again
+    {
+        auto model = handle.init(config);
+        auto speech = stereo(rate, rate, true, true);
+        model->decode_interleaved(speech.data(), rate, 2, ChannelMode::PerChannel, false);
+        auto silence = stereo(rate, rate, false, false);
+        auto segs = closed(
+            model->decode_interleaved(silence.data(), rate, 2, ChannelMode::Downmix, false));
+        int closed_right = count_channel(segs, 1);
+        assert(closed_right == 1);
+        std::cout << "  Downmix call: " << segs.size() << " closed segments, " << closed_right
+                  << " of channel 1" << std::endl;
+
+        segs = closed(
+            model->decode_interleaved(silence.data(), rate, 2, ChannelMode::PerChannel, true));
+        assert(count_channel(segs, 1) == 0);
+        assert(closed(model->flush_channels()).empty());
+    }
+
+    // A channel instance that cannot be created fails the call instead of crashing
+    {
+        FakeVadModel limited(FakeVadParams{ .init_budget = 1 });
+        auto model = limited.init(config);
+        assert(model);
+        auto speech = stereo(rate, rate, true, true);
+        auto segs = model->decode_interleaved(speech.data(), rate, 2, ChannelMode::PerChannel,
+                                              true);
+        assert(segs.empty());
+        segs = closed(
+            model->decode_interleaved(speech.data(), rate, 2, ChannelMode::Downmix, true));
+        assert(segs.size() == 1);
+    }
+
+    std::cout << "All decode_interleaved tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,124 @@
+#include "vad/test-fake-vad-model.h"
+#include "vad/vad-file-batch.h"
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+using namespace VadFilterOnnx;
+
+// Tone bursts of `burst` seconds every `period` seconds
+static std::vector<int16_t> make_audio(int sample_rate, int seconds, int burst, int period) {
+    std::vector<int16_t> audio(static_cast<size_t>(sample_rate) * seconds, 0);
+    for (size_t i = 0; i < audio.size(); ++i) {
+        if ((i / sample_rate) % period < static_cast<size_t>(burst)) {
+            audio[i] = static_cast<int16_t>(tone(i, sample_rate, 16000.0f));
+        }
+    }
+    return audio;
+}
+
+// WAV with a LIST chunk before the data, interleaving `channels` copies of the audio
+static void write_wav(const std::string &path, const std::vector<int16_t> &audio, int sample_rate,
+                      int channels) {
+    auto u32 = [](std::ofstream &f, uint32_t v) { f.write(reinterpret_cast<char *>(&v), 4); };
+    auto u16 = [](std::ofstream &f, uint16_t v) { f.write(reinterpret_cast<char *>(&v), 2); };
+    uint32_t data_size = static_cast<uint32_t>(audio.size() * channels * 2);
+    std::ofstream f(path, std::ios::binary);
+    f.write("RIFF", 4);
+    u32(f, 4 + 24 + 14 + 8 + data_size);
+    f.write("WAVE", 4);
+    f.write("fmt ", 4);
+    u32(f, 16);
+    u16(f, 1);
+    u16(f, static_cast<uint16_t>(channels));
+    u32(f, sample_rate);
+    u32(f, sample_rate * channels * 2);
+    u16(f, static_cast<uint16_t>(channels * 2));
+    u16(f, 16);
+    f.write("LIST", 4);
+    u32(f, 5);
+    f.write("INFO\0\0", 6); // odd size, padded
+    f.write("data", 4);
+    u32(f, data_size);
+    for (int16_t s : audio) {
+        for (int c = 0; c < channels; ++c) {
+            f.write(reinterpret_cast<const char *>(&s), 2);
+        }
+    }
+}
+
+static bool same(const std::vector<VadSegment> &a, const std::vector<VadSegment> &b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].start != b[i].start || a[i].end != b[i].end) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main() {
+    std::cout << "Testing process_batch..." << std::endl;
+
+    VadConfig config;
+    FakeVadModel handle;
+
+    std::vector<std::vector<int16_t>> pcm;
+    std::vector<std::vector<float>> floats;
+    for (int i = 0; i < 12; ++i) {
+        pcm.push_back(make_audio(config.sample_rate, 4 + i % 5, 1 + i % 2, 3));
+        std::vector<float> f(pcm.back().size());
+        for (size_t k = 0; k < f.size(); ++k) {
+            f[k] = pcm.back()[k] / 32768.0f;
+        }
+        floats.push_back(std::move(f));
+    }
+    std::string mono_path = "test-process-batch-mono.wav";
+    std::string stereo_path = "test-process-batch-stereo.wav";
+    write_wav(mono_path, pcm[0], config.sample_rate, 1);
+    write_wav(stereo_path, pcm[1], config.sample_rate, 2);
+
+    std::vector<VadBatchInput> inputs;
+    for (size_t i = 0; i < pcm.size(); ++i) {
+        VadBatchInput input;
+        if (i % 2 == 0) {
+            input.pcm16 = pcm[i].data();
+        } else {
+            input.data = floats[i].data();
+        }
+        input.n = static_cast<int>(pcm[i].size());
+        inputs.push_back(input);
+    }
+    VadBatchInput mono;
+    mono.path = mono_path;
+    inputs.push_back(mono);
+    VadBatchInput stereo;
+    stereo.path = stereo_path;
+    inputs.push_back(stereo);
+    VadBatchInput missing;
+    missing.path = "test-process-batch-missing.wav";
+    inputs.push_back(missing);
+
+    auto results = process_batch(&handle, config, inputs, 4);
+    assert(results.size() == inputs.size());
+    for (size_t i = 0; i < pcm.size(); ++i) {
+        auto model = handle.init(config);
+        auto expected = closed(model->decode(pcm[i].data(), static_cast<int>(pcm[i].size()), true));
+        assert(!expected.empty());
+        assert(results[i].ok && same(results[i].segments, expected));
+    }
+    size_t n = pcm.size();
+    assert(results[n].ok && same(results[n].segments, results[0].segments));
+    assert(results[n + 1].ok && same(results[n + 1].segments, results[1].segments));
+    assert(!results[n + 2].ok);
+    std::cout << results.size() << " inputs decoded on 4 workers" << std::endl;
+
+    std::remove(mono_path.c_str());
+    std::remove(stereo_path.c_str());
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,106 @@
+#include "vad/test-fake-vad-model.h"
+#include "vad/vad-sharded-decode.h"
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+using namespace VadFilterOnnx;
+
+struct Burst {
+    double begin_s;
+    double end_s;
+};
+
+static std::vector<float> make_audio(double seconds, const std::vector<Burst> &bursts) {
+    const int rate = 16000;
+    std::vector<float> audio(static_cast<size_t>(seconds * rate), 0.0f);
+    for (const auto &b : bursts) {
+        for (size_t i = static_cast<size_t>(b.begin_s * rate); i < b.end_s * rate; ++i) {
+            audio[i] = 0.3f * std::sin(2.0f * 3.14159265f * 220.0f * i / rate);
+        }
+    }
+    return audio;
+}
+
+int main() {
+    std::cout << "Testing decode_sharded..." << std::endl;
+    // Stateless, so every shard scores the frames a sequential run scores and the stitched
+    // segments can be compared exactly
+    FakeVadModel handle(FakeVadParams{ .silence_prob = 0.05f });
+
+    VadConfig config;
+    config.max_speech_ms = 4000;
+    ShardedDecodeOptions options;
+    options.num_threads = 4;
+    options.min_shard_ms = 5000;
+    options.overlap_ms = 2000;
+    options.compare_sequential = true;
+
+    // 4 shards of 160256 samples: own regions start at 10.016 s, 20.032 s and 30.048 s, warm-up
+    // regions 2 s earlier
+    const int shard_len = 160256;
+    std::vector<Burst> bursts = {
+        { 2.0, 3.0 },
+        { 9.0, 11.5 },  // cut at the first shard end, merged with its continuation
+        { 15.0, 25.0 }, // longer than max_speech_ms across the second shard end: re-split
+        { 28.2, 28.6 }, // closed by the third shard, found again in the fourth's warm-up
+        { 29.5, 29.8 }, // cut at the third shard end, closed in the fourth's warm-up
+        { 33.0, 34.0 },
+        { 36.0, 37.0 },
+    };
+    auto audio = make_audio(40.0, bursts);
+    int n = static_cast<int>(audio.size());
+
+    ShardedDecodeReport report;
+    auto segments = decode_sharded(&handle, config, audio.data(), n, options, &report);
+    auto sequential = handle.init(config)->decode(audio.data(), n, true);
+
+    assert(report.num_shards == 4);
+    assert(report.num_segments == static_cast<int>(segments.size()));
+    assert(report.num_sequential_segments == static_cast<int>(sequential.size()));
+    assert(report.num_segments == report.num_sequential_segments);
+    assert(report.num_unmatched_segments == 0);
+    assert(report.max_boundary_deviation_ms == 0);
+    assert(report.mean_boundary_deviation_ms == 0.0f);
+    for (size_t i = 0; i < segments.size(); ++i) {
+        // Renumbered across shards
+        assert(segments[i].idx == static_cast<int>(i));
+        assert(segments[i].start == sequential[i].start && segments[i].end == sequential[i].end);
+    }
+
+    // One segment spans the first shard end
+    int spanning = 0;
+    for (const auto &seg : segments) {
+        spanning += seg.start < shard_len && seg.end > shard_len;
+    }
+    assert(spanning == 1);
+    // The long burst comes back as max_speech_ms pieces
+    int pieces = 0;
+    for (const auto &seg : segments) {
+        if (seg.start >= 14 * 16000 && seg.end <= 26 * 16000) {
+            assert(seg.end_ms - seg.start_ms <= config.max_speech_ms + 64);
+            pieces++;
+        }
+    }
+    assert(pieces >= 3);
+    // The bursts before the third shard end are reported once each
+    int before_cut = 0;
+    for (const auto &seg : segments) {
+        before_cut += seg.start_ms >= 28000 && seg.end_ms <= 30500;
+    }
+    assert(before_cut == 2);
+    std::cout << "stitched: " << report.num_segments << " segments over " << report.num_shards
+              << " shards match sequential decode" << std::endl;
+
+    // An instance that cannot be created fails the whole decode
+    handle.params.init_budget = 2;
+    report = ShardedDecodeReport();
+    segments = decode_sharded(&handle, config, audio.data(), n, options, &report);
+    assert(segments.empty());
+    assert(report.num_shards == 0);
+    std::cout << "init failure: no segments" << std::endl;
+
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
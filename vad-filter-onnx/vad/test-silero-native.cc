@@ -0,0 +1,255 @@
+#include "utils/mapped-file.h"
+#include "utils/onnx-tensors.h"
+#include "vad-filter-onnx-cxx-api.h"
+#include "vad/silero-v5-native.h"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace VadFilterOnnx;
+
+// Direct evaluation of the graph in double precision from the unmodified ONNX tensors
+class ReferenceSilero {
+  public:
+    ReferenceSilero(const std::vector<OnnxTensor> &tensors, int sample_rate) {
+        int k = sample_rate == 16000 ? 256 : 128;
+        for (const auto &t : tensors) {
+            // "<branch>__Inline_0__<name>"; the basis shape tells the branches apart
+            size_t at = t.name.rfind("stft.forward_basis_buffer");
+            if (at != std::string::npos && t.dims.size() == 3 && t.dims[2] == k) {
+                prefix_ = t.name.substr(0, at);
+            }
+        }
+        for (const auto &t : tensors) {
+            if (t.name.compare(0, prefix_.size(), prefix_) == 0) {
+                tensors_[t.name.substr(prefix_.size())] = &t;
+            }
+        }
+        state_.assign(256, 0.0);
+    }
+    bool ok() const { return tensors_.count("stft.forward_basis_buffer") > 0; }
+
+    double forward(const float *frame, int n) {
+        const OnnxTensor &basis = *tensors_.at("stft.forward_basis_buffer");
+        int k = static_cast<int>(basis.dims[2]);
+        int bins = static_cast<int>(basis.dims[0]) / 2;
+        std::vector<double> x(frame, frame + n);
+        for (int j = 0; j < k / 4; ++j) {
+            x.push_back(frame[n - 2 - j]);
+        }
+        int frames = (static_cast<int>(x.size()) - k) / (k / 2) + 1;
+        // [channel][time]
+        std::vector<std::vector<double>> act(bins, std::vector<double>(frames));
+        for (int t = 0; t < frames; ++t) {
+            for (int f = 0; f < bins; ++f) {
+                double re = 0.0, im = 0.0;
+                for (int i = 0; i < k; ++i) {
+                    re += basis.data[static_cast<size_t>(f) * k + i] * x[t * k / 2 + i];
+                    im += basis.data[static_cast<size_t>(f + bins) * k + i] * x[t * k / 2 + i];
+                }
+                act[f][t] = std::sqrt(re * re + im * im);
+            }
+        }
+        const int strides[4] = { 1, 2, 2, 1 };
+        for (int l = 0; l < 4; ++l) {
+            std::string name = "encoder." + std::to_string(l) + ".reparam_conv.";
+            const OnnxTensor &w = *tensors_.at(name + "weight");
+            const OnnxTensor &b = *tensors_.at(name + "bias");
+            int out = static_cast<int>(w.dims[0]), in = static_cast<int>(w.dims[1]);
+            int len = static_cast<int>(act[0].size());
+            int out_len = (len + 2 - 3) / strides[l] + 1;
+            std::vector<std::vector<double>> y(out, std::vector<double>(out_len));
+            for (int o = 0; o < out; ++o) {
+                for (int t = 0; t < out_len; ++t) {
+                    double sum = b.data[o];
+                    for (int c = 0; c < in; ++c) {
+                        for (int j = 0; j < 3; ++j) {
+                            int s = t * strides[l] + j - 1;
+                            if (s >= 0 && s < len) {
+                                sum += w.data[(static_cast<size_t>(o) * in + c) * 3 + j] * act[c][s];
+                            }
+                        }
+                    }
+                    y[o][t] = std::max(sum, 0.0);
+                }
+            }
+            act = std::move(y);
+        }
+
+        const OnnxTensor &w_ih = *tensors_.at("decoder.rnn.weight_ih");
+        const OnnxTensor &w_hh = *tensors_.at("decoder.rnn.weight_hh");
+        const OnnxTensor &b_ih = *tensors_.at("decoder.rnn.bias_ih");
+        const OnnxTensor &b_hh = *tensors_.at("decoder.rnn.bias_hh");
+        std::vector<double> gates(512);
+        for (int r = 0; r < 512; ++r) {
+            double sum = b_ih.data[r] + b_hh.data[r];
+            for (int j = 0; j < 128; ++j) {
+                sum += w_ih.data[r * 128 + j] * act[j][0] + w_hh.data[r * 128 + j] * state_[j];
+            }
+            gates[r] = sum;
+        }
+        auto sigmoid = [](double v) { return 1.0 / (1.0 + std::exp(-v)); };
+        const OnnxTensor &w_out = *tensors_.at("decoder.decoder.2.weight");
+        double logit = tensors_.at("decoder.decoder.2.bias")->data[0];
+        for (int j = 0; j < 128; ++j) {
+            double c = sigmoid(gates[128 + j]) * state_[128 + j] +
+                       sigmoid(gates[j]) * std::tanh(gates[256 + j]);
+            double h = sigmoid(gates[384 + j]) * std::tanh(c);
+            state_[j] = h;
+            state_[128 + j] = c;
+            logit += std::max(h, 0.0) * w_out.data[j];
+        }
+        return sigmoid(logit);
+    }
+    const std::vector<double> &state() const { return state_; }
+
+  private:
+    std::string prefix_;
+    std::unordered_map<std::string, const OnnxTensor *> tensors_;
+    std::vector<double> state_;
+};
+
+// Voiced-like harmonics with a drifting pitch, alternating with noise and silence
+static std::vector<float> make_audio(int sample_rate, int seconds) {
+    std::vector<float> audio(static_cast<size_t>(sample_rate) * seconds);
+    uint32_t seed = 1;
+    double phase = 0.0;
+    for (size_t i = 0; i < audio.size(); ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        float noise = (static_cast<float>(seed >> 8) / (1 << 24) - 0.5f) * 0.02f;
+        double t = static_cast<double>(i) / sample_rate;
+        phase += 2.0 * 3.14159265358979 * (140.0 + 40.0 * std::sin(2.0 * t)) / sample_rate;
+        float voiced = 0.0f;
+        for (int h = 1; h <= 8; ++h) {
+            voiced += static_cast<float>(std::sin(h * phase) / h);
+        }
+        bool speech = static_cast<int>(t / 1.5) % 2 == 0;
+        audio[i] = noise + (speech ? 0.3f * voiced * static_cast<float>(std::sin(t * 9.0) > -0.5) : 0.0f);
+    }
+    return audio;
+}
+
+static void check_rate(const SileroV5Native &native, const std::vector<OnnxTensor> &tensors,
+                       int sample_rate) {
+    int shift = sample_rate == 16000 ? 512 : 256;
+    int context = shift / 8;
+    int n = shift + context;
+    size_t scratch_size = native.scratch_size(sample_rate, n);
+    ReferenceSilero reference(tensors, sample_rate);
+    if (!scratch_size || !reference.ok()) {
+        std::cout << sample_rate << " Hz: no weights in the model, skipped" << std::endl;
+        return;
+    }
+    std::vector<float> scratch(scratch_size);
+    std::vector<float> state(SileroV5Native::kStateSize, 0.0f), next(state.size());
+
+    auto audio = make_audio(sample_rate, 20);
+    int frames = static_cast<int>((audio.size() - context) / shift);
+    double max_prob_diff = 0.0, max_state_diff = 0.0;
+    int speech_frames = 0;
+    for (int i = 0; i < frames; ++i) {
+        const float *frame = audio.data() + static_cast<size_t>(i) * shift;
+        float prob = native.forward(sample_rate, frame, n, state.data(), next.data(),
+                                    scratch.data());
+        state.swap(next);
+        double expected = reference.forward(frame, n);
+        max_prob_diff = std::max(max_prob_diff, std::fabs(prob - expected));
+        for (size_t j = 0; j < state.size(); ++j) {
+            max_state_diff = std::max(max_state_diff, std::fabs(state[j] - reference.state()[j]));
+        }
+        speech_frames += expected > 0.5;
+    }
+    std::cout << sample_rate << " Hz: " << frames << " frames (" << speech_frames
+              << " speech), max probability diff " << max_prob_diff << ", max state diff "
+              << max_state_diff << std::endl;
+    assert(speech_frames > 0 && speech_frames < frames);
+    assert(max_prob_diff < 1e-4 && max_state_diff < 1e-3);
+
+    // Steady-state cost per frame
+    int runs = 2000;
+    auto begin = std::chrono::steady_clock::now();
+    for (int r = 0; r < runs; ++r) {
+        const float *frame = audio.data() + static_cast<size_t>(r % frames) * shift;
+        native.forward(sample_rate, frame, n, state.data(), next.data(), scratch.data());
+        state.swap(next);
+    }
+    double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin)
+                    .count();
+    std::cout << sample_rate << " Hz: " << us / runs << " us per frame" << std::endl;
+}
+
+// Per-frame probabilities and decode time of the whole audio through the public API
+static std::vector<float> decode_probs(AutoVadModel &handle, const VadConfig &config,
+                                       std::vector<float> audio, double *ms) {
+    auto model = handle.init(config);
+    std::vector<float> probs(model->max_frames(static_cast<int>(audio.size())));
+    int num_frames = 0;
+    auto begin = std::chrono::steady_clock::now();
+    model->decode(audio.data(), static_cast<int>(audio.size()), true, probs.data(), nullptr,
+                  static_cast<int>(probs.size()), &num_frames);
+    *ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin)
+              .count();
+    probs.resize(num_frames);
+    return probs;
+}
+
+int main(int argc, char *argv[]) {
+    std::cout << "Testing the native Silero V5 engine..." << std::endl;
+    if (argc < 2) {
+        std::cout << "Usage: " << argv[0]
+                  << " silero_vad.v5.onnx (e.g. public/models/silero_vad.v5.onnx), skipped"
+                  << std::endl;
+        return 0;
+    }
+
+    auto file = MappedFile::open(argv[1]);
+    assert(file);
+    auto native = SileroV5Native::load(file->data(), file->size());
+    assert(native);
+    std::vector<OnnxTensor> tensors;
+    bool parsed = ReadOnnxFloatTensors(file->data(), file->size(), &tensors);
+    assert(parsed);
+    check_rate(*native, tensors, 16000);
+    check_rate(*native, tensors, 8000);
+
+    // Not a model: the parser rejects it instead of reading past the end
+    std::vector<uint8_t> garbage(4096);
+    for (size_t i = 0; i < garbage.size(); ++i) {
+        garbage[i] = static_cast<uint8_t>(i * 2654435761u >> 13);
+    }
+    assert(!SileroV5Native::load(garbage.data(), garbage.size()));
+    assert(!SileroV5Native::load(file->data(), file->size() / 2));
+
+    // Against ONNX Runtime, through the full decode path
+    for (int sample_rate : { 16000, 8000 }) {
+        VadConfig config;
+        config.sample_rate = sample_rate;
+        auto audio = make_audio(sample_rate, 20);
+        SessionConfig session_config;
+        session_config.enable_session_cache = false;
+        auto ort = AutoVadModel::create(argv[1], session_config);
+        session_config.native_silero_v5 = true;
+        auto fast = AutoVadModel::create(argv[1], session_config);
+        assert(ort && fast);
+        double ort_ms = 0.0, native_ms = 0.0;
+        auto expected = decode_probs(*ort, config, audio, &ort_ms);
+        auto probs = decode_probs(*fast, config, audio, &native_ms);
+        assert(probs.size() == expected.size());
+        float max_diff = 0.0f;
+        for (size_t i = 0; i < probs.size(); ++i) {
+            max_diff = std::max(max_diff, std::fabs(probs[i] - expected[i]));
+        }
+        std::cout << sample_rate << " Hz vs ONNX Runtime: " << probs.size()
+                  << " frames, max probability diff " << max_diff << ", " << ort_ms << " ms vs "
+                  << native_ms << " ms" << std::endl;
+        assert(max_diff < 1e-4f);
+    }
+
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
@@ -1,10 +1,59 @@
 #include "sliding-window-bit.h"
+#include <algorithm>
 #include <cassert>
+#include <cstdlib>
 #include <iostream>
+#include <string>
 #include <vector>
 
 using namespace VadFilterOnnx;
 
+// Compare every query against a plain string of the window contents
+static void check_against_reference(size_t max_size, const std::vector<size_t> &windows, int n) {
+    SlidingWindowBit sw(max_size);
+    for (size_t w : windows) {
+        sw.track(w);
+    }
+    std::string ref;
+    srand(static_cast<unsigned>(max_size));
+    for (int i = 0; i < n; ++i) {
+        // Mostly-silence and mostly-speech stretches, plus runs longer than a word
+        bool value = (i / 97) % 2 ? rand() % 10 != 0 : rand() % 10 == 0;
+        if (i % 1000 > 800) {
+            value = true;
+        }
+        sw.push(value);
+        ref += value ? '1' : '0';
+        if (ref.size() > max_size) {
+            ref.erase(ref.begin());
+        }
+
+        assert(sw.to_string() == ref);
+        size_t ones = std::count(ref.begin(), ref.end(), '1');
+        assert(sw.get_num_ones() == ones);
+        assert(sw.get_num_zeros() == ref.size() - ones);
+        size_t last_zero = ref.find_last_of('0');
+        size_t last_one = ref.find_last_of('1');
+        assert(sw.num_right_ones() ==
+               (last_zero == std::string::npos ? ref.size() : ref.size() - 1 - last_zero));
+        assert(sw.num_right_zeros() ==
+               (last_one == std::string::npos ? ref.size() : ref.size() - 1 - last_one));
+        assert(sw.num_left_ones() == std::min(ref.size(), ref.find_first_not_of('1')));
+        assert(sw.num_left_zeros() == std::min(ref.size(), ref.find_first_not_of('0')));
+
+        // Tracked and untracked windows give the same answers
+        for (size_t w : { windows[0], windows[1], max_size / 3 + 1 }) {
+            size_t len = std::min(w, ref.size());
+            size_t win_ones = std::count(ref.end() - len, ref.end(), '1');
+            assert(sw.num_ones(w) == win_ones);
+            size_t threshold = w * 5 / 6;
+            assert(sw.check_speech(w, threshold) == (ref.size() >= w && win_ones >= threshold));
+            assert(sw.check_silence(w, threshold) ==
+                   (ref.size() >= w && w - win_ones >= threshold));
+        }
+    }
+}
+
 int main() {
     std::cout << "Testing SlidingWindowBit..." << std::endl;
 
@@ -18,14 +67,15 @@ int main() {
     std::cout << "sw(10, 5) with FIFO(1 1 0 1): " << sw.to_string() << std::endl;
     assert(sw.get_num_ones() == 3);
     assert(sw.get_num_zeros() == 1);
-    assert(sw.is_up() == false); // 3 <= 5
+    assert(sw.check_speech(4, 4) == false);
+    assert(sw.check_speech(4, 3) == true);
 
     sw.push(true);
     sw.push(true);
     sw.push(true); // Now 6 ones
     std::cout << "sw(10, 5) with FIFO(1 1 0 1 1 1): " << sw.to_string() << std::endl;
     assert(sw.get_num_ones() == 6);
-    assert(sw.is_up() == true);
+    assert(sw.check_speech(7, 6) == true);
 
     // Test window sliding
     // Push 10 more zeros
@@ -34,7 +84,8 @@ int main() {
     std::cout << "sw(10, 5) with FIFO(0 0 0 0 0 0 0 0 0 0): " << sw.to_string() << std::endl;
     assert(sw.get_num_ones() == 0);
     assert(sw.get_num_zeros() == 10);
-    assert(sw.is_down() == true);
+    assert(sw.check_silence(10, 10) == true);
+    assert(sw.num_right_zeros() == 10);
 
     // Test continuity
     sw.reset();
@@ -52,11 +103,22 @@ int main() {
     assert(sw.num_right_ones() == 1);
     assert(sw.num_right_zeros() == 0);
 
-    // Test max size limit (64)
-    SlidingWindowBit sw64(100); // Should be capped at 64
-    for (int i = 0; i < 100; ++i)
-        sw64.push(true);
-    assert(sw64.get_num_ones() == 64);
+    // Windows longer than a word are not capped
+    SlidingWindowBit sw300(300);
+    for (int i = 0; i < 400; ++i)
+        sw300.push(true);
+    assert(sw300.get_num_ones() == 300);
+    assert(sw300.num_right_ones() == 300);
+    sw300.push(false);
+    assert(sw300.get_num_ones() == 299);
+    assert(sw300.check_silence(300, 1) == true);
+
+    // Randomized comparison: within one word, word multiples, long dictation windows
+    check_against_reference(10, { 5, 10 }, 3000);
+    check_against_reference(64, { 30, 60 }, 3000);
+    check_against_reference(128, { 128, 65 }, 3000);
+    check_against_reference(300, { 30, 300 }, 5000);
+    std::cout << "Randomized reference comparison passed" << std::endl;
 
     // Test to_string()
     SlidingWindowBit sw_str(5);
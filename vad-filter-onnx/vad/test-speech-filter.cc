@@ -0,0 +1,125 @@
+#include "vad/test-fake-vad-model.h"
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <vector>
+
+using namespace VadFilterOnnx;
+
+// Tone bursts of varying length over a low ramp, so every sample is distinct
+static std::vector<float> make_audio(int sample_rate, int seconds) {
+    std::vector<float> audio(static_cast<size_t>(sample_rate) * seconds);
+    for (size_t i = 0; i < audio.size(); ++i) {
+        audio[i] = 1e-3f * (i % 1000) / 1000.0f;
+        size_t t = (i + sample_rate / 7) % (5 * sample_rate);
+        size_t burst = sample_rate / 2 + (i / (5 * sample_rate)) % 4 * sample_rate;
+        if (t < burst) {
+            audio[i] += tone(i, sample_rate);
+        }
+    }
+    return audio;
+}
+
+struct Run {
+    std::vector<VadSegment> segments;            // closed segments
+    std::vector<std::vector<float>> speech;      // concatenated chunks per segment
+    std::vector<std::vector<int>> chunk_starts;  // start of every chunk per segment
+    int early_chunks = 0;                        // chunks emitted before their segment closed
+};
+
+static Run decode_speech_all(VadModel &model, const std::vector<float> &audio, int chunk) {
+    Run run;
+    std::vector<SpeechChunk> chunks;
+    std::vector<float> buffer(chunk);
+    int total = static_cast<int>(audio.size());
+    for (int i = 0; i < total; i += chunk) {
+        int n = std::min(chunk, total - i);
+        // Reuse one buffer, so views of earlier calls would go stale
+        std::copy(audio.begin() + i, audio.begin() + i + n, buffer.begin());
+        for (const auto &seg : model.decode_speech(buffer.data(), n, i + n == total, &chunks)) {
+            if (seg.end != -1) {
+                run.segments.push_back(seg);
+            }
+        }
+        for (const auto &c : chunks) {
+            if (static_cast<int>(run.speech.size()) <= c.idx) {
+                run.speech.resize(c.idx + 1);
+                run.chunk_starts.resize(c.idx + 1);
+            }
+            run.speech[c.idx].insert(run.speech[c.idx].end(), c.data, c.data + c.n);
+            run.chunk_starts[c.idx].push_back(c.start);
+            if (!c.segment_end) {
+                run.early_chunks++;
+            }
+        }
+    }
+    return run;
+}
+
+static void check(const char *name, const VadConfig &config, int chunk) {
+    int rate = config.input_sample_rate > 0 ? config.input_sample_rate : config.sample_rate;
+    auto audio = make_audio(rate, 60);
+    FakeVadModel handle;
+    auto model = handle.init(config);
+    Run run = decode_speech_all(*model, audio, chunk);
+
+    // Same segments as decode()
+    auto reference = handle.init(config);
+    std::vector<float> copy = audio;
+    std::vector<VadSegment> expected;
+    for (const auto &seg : reference->decode(copy.data(), static_cast<int>(copy.size()), true)) {
+        if (seg.end != -1) {
+            expected.push_back(seg);
+        }
+    }
+    assert(!expected.empty() && run.segments.size() == expected.size());
+    assert(run.speech.size() == expected.size());
+
+    int fade = config.filter_fade_ms * rate / 1000;
+    for (size_t k = 0; k < expected.size(); ++k) {
+        const auto &seg = run.segments[k];
+        assert(seg.start == expected[k].start && seg.end == expected[k].end);
+        const auto &speech = run.speech[seg.idx];
+        assert(static_cast<int>(speech.size()) == seg.end - seg.start);
+        assert(run.chunk_starts[seg.idx].front() == seg.start);
+        for (int i = 0; i < seg.end - seg.start; ++i) {
+            float x = audio[seg.start + i];
+            if (i >= fade && i < seg.end - seg.start - fade) {
+                assert(speech[i] == x);
+            } else {
+                assert(std::fabs(speech[i]) <= std::fabs(x));
+            }
+        }
+    }
+    std::cout << name << ", " << chunk << " samples per call: " << expected.size()
+              << " segments, " << run.early_chunks << " chunks before the segment end"
+              << std::endl;
+    // Long segments stream out while they are still open
+    assert(run.early_chunks > 0);
+}
+
+int main() {
+    std::cout << "Testing decode_speech..." << std::endl;
+
+    VadConfig config;
+    config.left_padding_ms = 300;
+    for (int chunk : { 160, 1000, 16000, 100000 }) {
+        check("16k", config, chunk);
+    }
+
+    VadConfig split = config;
+    split.max_speech_ms = 1200;
+    check("max_speech_ms 1200", split, 480);
+
+    VadConfig faded = config;
+    faded.filter_fade_ms = 10;
+    check("10ms fades", faded, 320);
+
+    VadConfig resampled = config;
+    resampled.input_sample_rate = 48000;
+    check("48k input", resampled, 480);
+    check("48k input", resampled, 200000);
+
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,127 @@
+#include "vad/test-fake-vad-model.h"
+#include "vad/vad-stream-pool.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <thread>
+#include <vector>
+
+using namespace VadFilterOnnx;
+
+// Tone bursts of varying length and loudness; every stream gets its own pattern
+static std::vector<float> make_audio(int seconds, int seed) {
+    const int rate = 16000;
+    std::vector<float> audio(static_cast<size_t>(rate) * seconds, 0.0f);
+    uint32_t state = static_cast<uint32_t>(seed) * 2654435761u + 1;
+    size_t i = 0;
+    while (i < audio.size()) {
+        state = state * 1664525u + 1013904223u;
+        size_t len = rate / 4 + (state >> 8) % rate;
+        float amplitude = (state >> 4) % 3 == 0 ? 0.0f : 0.05f + 0.3f * ((state >> 12) % 8) / 8;
+        for (size_t k = 0; k < len && i < audio.size(); ++k, ++i) {
+            audio[i] = amplitude * std::sin(2.0f * 3.14159265f * 300.0f * i / rate);
+        }
+    }
+    return audio;
+}
+
+static std::vector<VadSegment> decode_alone(VadModel &handle, const std::vector<float> &audio,
+                                            int chunk) {
+    auto model = handle.init(VadConfig());
+    return closed(decode_all(*model, audio, chunk));
+}
+
+int main() {
+    std::cout << "Testing VadStreamPool..." << std::endl;
+    RecurrentFakeVadModel handle(
+        FakeVadParams{ .threshold = 2e-3f, .silence_prob = 0.05f, .warmup = true });
+
+    const int num_streams = 24;
+    const int num_feeders = 4;
+    std::vector<std::vector<float>> audio;
+    std::vector<int> chunks;
+    for (int k = 0; k < num_streams; ++k) {
+        audio.push_back(make_audio(10 + k % 5, k));
+        // Chunks shorter and longer than a frame, not multiples of it
+        chunks.push_back(k % 3 == 0 ? 160 : 1600 + 97 * k);
+    }
+
+    for (int num_workers : { 1, 3, 8 }) {
+        VadStreamPool pool(&handle, num_workers);
+        std::vector<int> ids;
+        for (int k = 0; k < num_streams; ++k) {
+            ids.push_back(pool.add_stream(VadConfig()));
+            assert(ids.back() >= 0);
+        }
+
+        // Each feeder thread owns a subset of the streams and interleaves their chunks
+        std::vector<std::thread> feeders;
+        for (int f = 0; f < num_feeders; ++f) {
+            feeders.emplace_back([&, f] {
+                std::vector<size_t> pos(num_streams, 0);
+                bool pending = true;
+                while (pending) {
+                    pending = false;
+                    for (int k = f; k < num_streams; k += num_feeders) {
+                        size_t size = audio[k].size();
+                        if (pos[k] >= size) {
+                            continue;
+                        }
+                        size_t n = std::min(static_cast<size_t>(chunks[k]), size - pos[k]);
+                        bool ok = pool.feed(ids[k], audio[k].data() + pos[k], static_cast<int>(n),
+                                            pos[k] + n == size);
+                        assert(ok);
+                        pos[k] += n;
+                        pending = true;
+                    }
+                }
+            });
+        }
+
+        std::map<int, std::vector<VadSegment>> result;
+        std::map<int, bool> done;
+        int finished = 0;
+        while (finished < num_streams) {
+            VadStreamResult r;
+            bool got = pool.poll(&r, 10000);
+            assert(got);
+            // Nothing arrives for a stream after its final result
+            assert(!done[r.stream_id]);
+            auto &segs = result[r.stream_id];
+            segs.insert(segs.end(), r.segments.begin(), r.segments.end());
+            if (r.finished) {
+                done[r.stream_id] = true;
+                finished++;
+            }
+        }
+        for (auto &t : feeders) {
+            t.join();
+        }
+
+        size_t total = 0;
+        for (int k = 0; k < num_streams; ++k) {
+            assert(done[ids[k]]);
+            auto segs = closed(result[ids[k]]);
+            auto expected = decode_alone(handle, audio[k], chunks[k]);
+            assert(!expected.empty());
+            assert(segs.size() == expected.size());
+            for (size_t i = 0; i < segs.size(); ++i) {
+                assert(segs[i].idx == expected[i].idx && segs[i].start == expected[i].start &&
+                       segs[i].end == expected[i].end);
+            }
+            total += segs.size();
+        }
+        for (int id : ids) {
+            pool.remove_stream(id);
+        }
+        bool fed = pool.feed(ids[0], audio[0].data(), 16, true);
+        assert(!fed);
+        std::cout << num_workers << " workers: " << total << " segments match sequential decode"
+                  << std::endl;
+    }
+
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
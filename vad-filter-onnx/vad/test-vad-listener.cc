@@ -0,0 +1,168 @@
+#include "vad/test-fake-vad-model.h"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace VadFilterOnnx;
+
+// Tone bursts of 1s and 3s every 5s, off the frame grid
+static std::vector<float> make_audio(int sample_rate, int seconds) {
+    std::vector<float> audio(static_cast<size_t>(sample_rate) * seconds, 0.0f);
+    for (size_t i = 0; i < audio.size(); ++i) {
+        size_t t = (i + sample_rate / 7) % (10 * sample_rate);
+        if (t < static_cast<size_t>(sample_rate) ||
+            (t >= static_cast<size_t>(5 * sample_rate) && t < static_cast<size_t>(8 * sample_rate))) {
+            audio[i] = tone(i, sample_rate);
+        }
+    }
+    return audio;
+}
+
+// Records every call together with the input consumed when it was made
+class RecordingListener : public VadListener {
+  public:
+    void on_speech_start(const VadSegment &segment, int position) override {
+        starts.push_back(segment);
+        check(segment, position);
+        max_delay = std::max(max_delay, position - segment.start);
+    }
+    void on_speech_end(const VadSegment &segment, int position) override {
+        ends.push_back(segment);
+        check(segment, position);
+    }
+    void on_forced_split(const VadSegment &ended, const VadSegment &started,
+                         int position) override {
+        splits.emplace_back(ended, started);
+        check(ended, position);
+    }
+
+    std::vector<VadSegment> starts;
+    std::vector<VadSegment> ends;
+    std::vector<std::pair<VadSegment, VadSegment>> splits;
+    int consumed = 0; // input samples passed to decode() so far, including the current call
+    int max_delay = 0;
+
+  private:
+    void check(const VadSegment &segment, int position) {
+        // Decided on input already seen, after the boundary it reports
+        assert(position <= consumed);
+        assert(position >= segment.start && (segment.end == -1 || position >= segment.end));
+    }
+};
+
+int main() {
+    std::cout << "Testing VadListener..." << std::endl;
+
+    VadConfig config;
+    config.max_speech_ms = 2000;
+    auto audio = make_audio(config.sample_rate, 60);
+
+    FakeVadModel handle;
+    auto model = handle.init(config);
+    RecordingListener listener;
+    model->set_listener(&listener);
+
+    std::vector<VadSegment> returned;
+    int chunk = 320;
+    int total = static_cast<int>(audio.size());
+    for (int i = 0; i < total; i += chunk) {
+        int n = std::min(chunk, total - i);
+        size_t starts_before = listener.starts.size() + listener.splits.size();
+        listener.consumed = i + n;
+        auto segs = model->decode(audio.data() + i, n, i + n == total);
+        // Every start-only entry of this call was announced during the call
+        int open = 0;
+        for (const auto &seg : segs) {
+            open += seg.end == -1;
+        }
+        assert(listener.starts.size() + listener.splits.size() - starts_before >=
+               static_cast<size_t>(open));
+        returned.insert(returned.end(), segs.begin(), segs.end());
+    }
+
+    // The callbacks carry the same boundaries as the returned segments
+    std::vector<VadSegment> closed;
+    for (const auto &seg : returned) {
+        if (seg.end != -1) {
+            closed.push_back(seg);
+        }
+    }
+    std::cout << listener.starts.size() << " starts, " << listener.ends.size() << " ends, "
+              << listener.splits.size() << " forced splits, max start delay "
+              << listener.max_delay * 1000 / config.sample_rate << " ms" << std::endl;
+    assert(!listener.splits.empty());
+    assert(listener.starts.size() == listener.ends.size());
+    assert(closed.size() == listener.ends.size() + listener.splits.size());
+    size_t e = 0;
+    size_t s = 0;
+    for (const auto &seg : closed) {
+        const VadSegment *ended = nullptr;
+        if (s < listener.splits.size() && listener.splits[s].first.idx == seg.idx) {
+            ended = &listener.splits[s].first;
+            // The next segment opens where the split one closed
+            assert(listener.splits[s].second.idx == seg.idx + 1);
+            assert(listener.splits[s].second.start >= seg.end);
+            s++;
+        } else {
+            ended = &listener.ends[e++];
+        }
+        assert(ended->idx == seg.idx && ended->start == seg.start && ended->end == seg.end);
+    }
+    for (const auto &start : listener.starts) {
+        assert(start.end == -1);
+    }
+
+    // Same boundaries through the queue, drained by another thread while decoding
+    VadEventQueue queue(64);
+    auto queued_model = handle.init(config);
+    queued_model->set_listener(&queue);
+    std::atomic<bool> done{ false };
+    std::vector<VadEvent> events;
+    std::thread consumer([&] {
+        VadEvent event;
+        for (;;) {
+            if (queue.pop(&event)) {
+                events.push_back(event);
+            } else if (done.load()) {
+                break;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+    for (int i = 0; i < total; i += chunk) {
+        int n = std::min(chunk, total - i);
+        queued_model->decode(audio.data() + i, n, i + n == total);
+    }
+    done.store(true);
+    consumer.join();
+    VadEvent event;
+    while (queue.pop(&event)) {
+        events.push_back(event);
+    }
+    std::cout << events.size() << " queued events" << std::endl;
+    assert(queue.dropped() == 0);
+    assert(events.size() == listener.starts.size() + listener.ends.size() + listener.splits.size());
+    size_t split = 0;
+    for (const auto &ev : events) {
+        if (ev.type == VadEventType::ForcedSplit) {
+            assert(ev.segment.end == listener.splits[split].first.end);
+            assert(ev.started.start == listener.splits[split].second.start);
+            split++;
+        }
+    }
+    assert(split == listener.splits.size());
+
+    // A full queue drops instead of blocking the decoder
+    VadEventQueue small(2);
+    auto small_model = handle.init(config);
+    small_model->set_listener(&small);
+    small_model->decode(audio.data(), total, true);
+    assert(small.dropped() == events.size() - 2);
+
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,123 @@
+#include "vad-filter-onnx-cxx-api.h"
+#include "vad/test-fake-vad-model.h"
+#include <atomic>
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <vector>
+
+using namespace VadFilterOnnx;
+
+// Count every heap allocation made by the process
+static std::atomic<long> g_num_allocs{ 0 };
+
+void *operator new(size_t size) {
+    g_num_allocs.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+void *operator new[](size_t size) { return operator new(size); }
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+void operator delete[](void *p, size_t) noexcept { std::free(p); }
+
+// Decode `audio` in 20ms packets. Returns the number of allocations in the second half.
+template <typename Model>
+static long count_steady_state_allocs(Model &model, std::vector<float> &audio, int sample_rate,
+                                      int *num_segments) {
+    int chunk = sample_rate / 50;
+    int total = static_cast<int>(audio.size());
+    VadSegment segments[16];
+    long allocs = 0;
+    *num_segments = 0;
+    for (int i = 0; i < total; i += chunk) {
+        if (i == total / 2) {
+            allocs = g_num_allocs.load();
+        }
+        int n = std::min(chunk, total - i);
+        *num_segments += model.decode(audio.data() + i, n, false, segments, 16);
+    }
+    return g_num_allocs.load() - allocs;
+}
+
+int main(int argc, char *argv[]) {
+    std::cout << "Testing zero-allocation decode..." << std::endl;
+
+    VadConfig config;
+    config.max_speech_ms = 700; // also exercise forced splits
+    auto audio = alternating_tone(config.sample_rate, 20);
+
+    FakeVadModel handle;
+    auto model = handle.init(config);
+    int num_segments = 0;
+    long allocs = count_steady_state_allocs(*model, audio, config.sample_rate, &num_segments);
+    std::cout << "FakeVadModel: " << num_segments << " segments, " << allocs
+              << " allocations after warm-up" << std::endl;
+    assert(num_segments > 0);
+    assert(allocs == 0);
+
+    // Listener notifications are delivered without allocating
+    VadEventQueue queue(1024);
+    auto listened_model = handle.init(config);
+    listened_model->set_listener(&queue);
+    allocs = count_steady_state_allocs(*listened_model, audio, config.sample_rate, &num_segments);
+    std::cout << "FakeVadModel with listener: " << allocs << " allocations after warm-up"
+              << std::endl;
+    assert(allocs == 0);
+    VadEvent event;
+    int num_events = 0;
+    while (queue.pop(&event)) {
+        num_events++;
+    }
+    assert(num_events > 0 && queue.dropped() == 0);
+
+    // Stats counters stay allocation free and account for every frame and segment
+    VadConfig stats_config = config;
+    stats_config.enable_stats = true;
+    auto stats_model = handle.init(stats_config);
+    allocs = count_steady_state_allocs(*stats_model, audio, config.sample_rate, &num_segments);
+    VadStats stats = stats_model->stats();
+    std::cout << "FakeVadModel with stats: " << allocs << " allocations after warm-up, "
+              << stats.frames << " frames, " << stats.inference_ns << " ns inference, "
+              << stats.framing_ns << " ns framing" << std::endl;
+    assert(allocs == 0);
+    assert(stats.samples == audio.size());
+    assert(stats.frames == audio.size() / 512);
+    assert(stats.inference_runs == stats.frames);
+    assert(stats.segments > 0 && stats.max_speech_splits > 0);
+    assert(stats.buffered_bytes == stats_model->buffered_samples() * 4);
+    uint64_t histogram_runs = 0;
+    for (uint64_t count : stats.inference_latency_us) {
+        histogram_runs += count;
+    }
+    assert(histogram_runs == stats.inference_runs);
+    VadStats total = handle.handle_stats();
+    assert(total.frames == stats.frames && total.buffered_bytes == stats.buffered_bytes);
+    assert(model->stats().frames == 0);
+
+    // Optional: report the steady state of a real model, e.g. public/models/silero_vad.v5.onnx.
+    // ORT's executor itself may still allocate inside Session::Run; the arena keeps those
+    // allocations off the system allocator for intermediate tensors.
+    if (argc > 1) {
+        SessionConfig session_config;
+        session_config.enable_cpu_mem_arena = true;
+        auto api_handle = AutoVadModel::create(argv[1], session_config);
+        if (!api_handle) {
+            return 1;
+        }
+        auto instance = api_handle->init(config);
+        long ort_allocs = count_steady_state_allocs(*instance, audio, config.sample_rate,
+                                                    &num_segments);
+        int num_frames = static_cast<int>(audio.size() / 2 / 512);
+        std::cout << argv[1] << ": " << num_segments << " segments, "
+                  << static_cast<double>(ort_allocs) / num_frames
+                  << " allocations per frame after warm-up" << std::endl;
+    }
+
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,168 @@
+#include "utils/wave-reader.h"
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+using namespace VadFilterOnnx;
+
+static void put_u16(std::vector<uint8_t> &b, uint16_t v) {
+    b.push_back(v & 0xFF);
+    b.push_back(v >> 8);
+}
+
+static void put_u32(std::vector<uint8_t> &b, uint32_t v) {
+    put_u16(b, v & 0xFFFF);
+    put_u16(b, v >> 16);
+}
+
+static void put_chunk(std::vector<uint8_t> &b, const char *id, const std::vector<uint8_t> &body,
+                      uint32_t size) {
+    b.insert(b.end(), id, id + 4);
+    put_u32(b, size);
+    b.insert(b.end(), body.begin(), body.end());
+    if (body.size() & 1) {
+        b.push_back(0);
+    }
+}
+
+// Ramp over [-1, 1) of num_frames frames, channel c scaled by 1 / (c + 1)
+static float expected_sample(int frame, int c, int num_frames) {
+    return (2.0f * frame / num_frames - 1.0f) / (c + 1);
+}
+
+// Size field of the data chunk: the real size, or what writers that cannot seek back leave
+enum class DataSize { Exact, Zero, Max };
+
+// Encode the ramp in `format` (1 or 3) with `bits`, optionally as WAVE_FORMAT_EXTENSIBLE and
+// with LIST/fact chunks around the format
+static std::vector<uint8_t> make_wav(int format, int bits, int channels, int num_frames,
+                                     bool extensible, DataSize data_size) {
+    int bytes = bits / 8;
+    std::vector<uint8_t> data;
+    for (int i = 0; i < num_frames; ++i) {
+        for (int c = 0; c < channels; ++c) {
+            double x = expected_sample(i, c, num_frames);
+            if (format == 3 && bits == 32) {
+                float f = static_cast<float>(x);
+                uint8_t raw[4];
+                memcpy(raw, &f, 4);
+                data.insert(data.end(), raw, raw + 4);
+            } else if (format == 3) {
+                uint8_t raw[8];
+                memcpy(raw, &x, 8);
+                data.insert(data.end(), raw, raw + 8);
+            } else if (bits == 8) {
+                data.push_back(static_cast<uint8_t>(std::min(std::lround(x * 128.0) + 128, 255L)));
+            } else {
+                double scale = std::ldexp(1.0, bits - 1);
+                int64_t v = std::min(std::llround(x * scale), static_cast<long long>(scale) - 1);
+                for (int k = 0; k < bytes; ++k) {
+                    data.push_back(static_cast<uint8_t>(v >> (8 * k)));
+                }
+            }
+        }
+    }
+
+    std::vector<uint8_t> fmt;
+    put_u16(fmt, extensible ? 0xFFFE : format);
+    put_u16(fmt, channels);
+    put_u32(fmt, 16000);
+    put_u32(fmt, 16000 * channels * bytes);
+    put_u16(fmt, channels * bytes);
+    put_u16(fmt, bits);
+    if (extensible) {
+        put_u16(fmt, 22);
+        put_u16(fmt, bits);
+        put_u32(fmt, channels == 1 ? 4 : 3);
+        put_u16(fmt, format);
+        const uint8_t guid_tail[14] = { 0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80,
+                                        0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71 };
+        fmt.insert(fmt.end(), guid_tail, guid_tail + 14);
+    }
+
+    std::vector<uint8_t> wav = { 'R', 'I', 'F', 'F', 0, 0, 0, 0, 'W', 'A', 'V', 'E' };
+    put_chunk(wav, "LIST", { 'I', 'N', 'F', 'O', 'x' }, 5);
+    put_chunk(wav, "fmt ", fmt, static_cast<uint32_t>(fmt.size()));
+    std::vector<uint8_t> fact;
+    put_u32(fact, num_frames);
+    put_chunk(wav, "fact", fact, 4);
+    uint32_t size_field = data_size == DataSize::Exact ? static_cast<uint32_t>(data.size())
+                          : data_size == DataSize::Zero  ? 0u
+                                                         : 0xFFFFFFFFu;
+    put_chunk(wav, "data", data, size_field);
+    uint32_t riff_size = static_cast<uint32_t>(wav.size() - 8);
+    memcpy(&wav[4], &riff_size, 4);
+    return wav;
+}
+
+static void check(const char *name, int format, int bits, int channels, bool extensible,
+                  DataSize data_size, float tolerance) {
+    const int num_frames = 600000;
+    std::string path = "test-wave-reader.wav";
+    auto bytes = make_wav(format, bits, channels, num_frames, extensible, data_size);
+    std::ofstream(path, std::ios::binary)
+        .write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+
+    auto reader = WaveReader::open(path);
+    assert(reader);
+    assert(reader->sample_rate() == 16000 && reader->num_channels() == channels);
+    assert(reader->num_frames() == num_frames);
+
+    // Odd block size, so blocks straddle the release granularity at arbitrary offsets
+    const int block_frames = 777;
+    std::vector<float> block(static_cast<size_t>(block_frames) * channels);
+    float max_error = 0.0f;
+    int frame = 0;
+    while (int n = reader->read(block.data(), block_frames)) {
+        for (int i = 0; i < n; ++i, ++frame) {
+            for (int c = 0; c < channels; ++c) {
+                float error = std::fabs(block[static_cast<size_t>(i) * channels + c] -
+                                        expected_sample(frame, c, num_frames));
+                max_error = std::max(max_error, error);
+            }
+        }
+    }
+    assert(frame == num_frames && reader->position() == num_frames);
+
+    // Reading again after the pages were released gives the same samples
+    reader->seek(12345);
+    int reread = reader->read(block.data(), 1);
+    assert(reread == 1);
+    for (int c = 0; c < channels; ++c) {
+        assert(std::fabs(block[c] - expected_sample(12345, c, num_frames)) <= tolerance);
+    }
+
+    std::cout << name << ": max error " << max_error << std::endl;
+    assert(max_error <= tolerance);
+    std::remove(path.c_str());
+}
+
+int main() {
+    std::cout << "Testing WaveReader..." << std::endl;
+    check("pcm8", 1, 8, 1, false, DataSize::Exact, 1.0f / 128);
+    check("pcm16", 1, 16, 1, false, DataSize::Exact, 1.0f / 32768);
+    check("pcm16 stereo extensible", 1, 16, 2, true, DataSize::Exact, 1.0f / 32768);
+    check("pcm16, zero data size", 1, 16, 1, false, DataSize::Zero, 1.0f / 32768);
+    check("pcm24", 1, 24, 2, false, DataSize::Exact, 1e-6f);
+    check("pcm32 extensible", 1, 32, 1, true, DataSize::Exact, 1e-6f);
+    check("float32", 3, 32, 3, false, DataSize::Exact, 0.0f);
+    check("float32 extensible, unknown data size", 3, 32, 1, true, DataSize::Max, 0.0f);
+    check("float64", 3, 64, 2, false, DataSize::Exact, 1e-7f);
+
+    // Unsupported format and not a WAV
+    std::string path = "test-wave-reader.wav";
+    auto bytes = make_wav(1, 12, 1, 10, false, DataSize::Exact);
+    std::ofstream(path, std::ios::binary)
+        .write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+    assert(!WaveReader::open(path));
+    std::ofstream(path, std::ios::binary) << "not a wav file";
+    assert(!WaveReader::open(path));
+    std::remove(path.c_str());
+
+    std::cout << "All tests passed!" << std::endl;
+    return 0;
+}
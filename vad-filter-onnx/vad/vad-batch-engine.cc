@@ -0,0 +1,183 @@
+#include "vad/vad-batch-engine.h"
+#include <algorithm>
+
+namespace VadFilterOnnx {
+
+std::unique_ptr<VadBatchEngine> VadBatchEngine::create(VadModel *handle, int max_batch_size) {
+    if (!handle) {
+        return nullptr;
+    }
+    if (handle->type() == VadType::FsmnVad) {
+        printf("ERROR: FsmnVad processes variable-length chunks and cannot be batched\n");
+        return nullptr;
+    }
+    return std::make_unique<VadBatchEngine>(handle, std::max(1, max_batch_size));
+}
+
+VadBatchEngine::VadBatchEngine(VadModel *handle, int max_batch_size)
+    : handle_(handle), max_batch_size_(max_batch_size) {}
+
+int VadBatchEngine::add_stream(const VadConfig &config) {
+    auto model = handle_->init(config);
+    if (!model) {
+        return -1;
+    }
+    if (model->resampling()) {
+        // Streams are framed by the engine, which feeds model-rate audio only
+        printf("ERROR: VadBatchEngine does not support input_sample_rate != sample_rate\n");
+        return -1;
+    }
+    int id = next_id_++;
+    streams_[id].model = std::move(model);
+    return id;
+}
+
+void VadBatchEngine::remove_stream(int stream_id) { streams_.erase(stream_id); }
+
+bool VadBatchEngine::accept(int stream_id, const float *data, int n, bool input_finished) {
+    auto it = streams_.find(stream_id);
+    if (it == streams_.end()) {
+        return false;
+    }
+    Stream &s = it->second;
+    if (n > 0) {
+        s.buffer.insert(s.buffer.end(), data, data + n);
+        s.model->stats_delta_.samples += n;
+    }
+    s.input_finished = s.input_finished || input_finished;
+    return true;
+}
+
+bool VadBatchEngine::ready(const Stream &s) const {
+    return s.buffer.size() - s.offset >= static_cast<size_t>(s.model->frame_length());
+}
+
+int VadBatchEngine::run() {
+    for (auto &[id, s] : streams_) {
+        s.stats_scope.emplace(s.model.get());
+    }
+    int num_frames = 0;
+    while (true) {
+        // Group ready streams by frame length and sample rate, one frame per stream per round
+        for (auto &group : groups_) {
+            group.second.clear();
+        }
+        bool any_ready = false;
+        for (auto &[id, s] : streams_) {
+            if (!ready(s)) {
+                continue;
+            }
+            auto key = std::make_pair(s.model->frame_length(), s.model->config().sample_rate);
+            auto it = std::find_if(groups_.begin(), groups_.end(),
+                                   [&key](const auto &g) { return g.first == key; });
+            if (it == groups_.end()) {
+                groups_.emplace_back(key, std::vector<Stream *>());
+                it = groups_.end() - 1;
+            }
+            it->second.push_back(&s);
+            any_ready = true;
+        }
+        if (!any_ready) {
+            break;
+        }
+
+        for (auto &group : groups_) {
+            auto &members = group.second;
+            for (size_t i = 0; i < members.size(); i += max_batch_size_) {
+                int size = static_cast<int>(std::min(members.size() - i,
+                                                     static_cast<size_t>(max_batch_size_)));
+                run_batch(members.data() + i, size);
+                num_frames += size;
+            }
+        }
+    }
+
+    // Close streams whose input has ended and whose remaining samples cannot form a frame
+    for (auto &[id, s] : streams_) {
+        if (s.input_finished) {
+            s.model->flush();
+            s.buffer.clear();
+            s.offset = 0;
+            s.input_finished = false;
+        }
+        s.stats_scope.reset(); // publishes the counters of this run
+    }
+    return num_frames;
+}
+
+void VadBatchEngine::run_batch(Stream *const *batch, int size) {
+    // Frames held by the adaptive stride or under the energy gate do not reach the model
+    models_.clear();
+    frames_.clear();
+    for (int i = 0; i < size; ++i) {
+        const float *frame = batch[i]->buffer.data() + batch[i]->offset;
+        if (!batch[i]->model->skip_forward(frame)) {
+            models_.push_back(batch[i]->model.get());
+            frames_.push_back(frame);
+        }
+    }
+    int count = static_cast<int>(models_.size());
+    probs_.resize(count);
+
+    bool batched = false;
+    if (batching_supported_ && count > 1) {
+        uint64_t begin_ns = StatsClockNs();
+        try {
+            batched = models_[0]->forward_batch(models_.data(), frames_.data(), count,
+                                                probs_.data());
+        } catch (const Ort::Exception &e) {
+            // e.g. the exported graph has a fixed batch dimension of 1
+            printf("WARNING: Batched inference failed, falling back to per-stream Run: %s\n",
+                   e.what());
+            batching_supported_ = false;
+        }
+        if (batched) {
+            // Each stream is charged its share of the batched run
+            uint64_t share_ns = (StatsClockNs() - begin_ns) / count;
+            for (int i = 0; i < count; ++i) {
+                if (models_[i]->stats_) {
+                    models_[i]->stats_delta_.add_inference(share_ns);
+                }
+            }
+        }
+    }
+    if (!batched) {
+        for (int i = 0; i < count; ++i) {
+            VadModel *m = models_[i];
+            uint64_t begin_ns = m->stats_ ? StatsClockNs() : 0;
+            probs_[i] = m->forward(frames_[i], m->frame_length());
+            if (m->stats_) {
+                m->stats_delta_.add_inference(StatsClockNs() - begin_ns);
+            }
+        }
+    }
+    for (int i = 0; i < count; ++i) {
+        models_[i]->finish_frame(probs_[i]);
+    }
+
+    for (int i = 0; i < size; ++i) {
+        Stream &s = *batch[i];
+        s.offset += s.model->frame_shift();
+        if (s.offset * 2 >= s.buffer.size()) {
+            s.buffer.erase(s.buffer.begin(), s.buffer.begin() + s.offset);
+            s.offset = 0;
+        }
+    }
+}
+
+std::vector<VadSegment> VadBatchEngine::fetch(int stream_id) {
+    auto it = streams_.find(stream_id);
+    if (it == streams_.end()) {
+        return {};
+    }
+    std::vector<VadSegment> result = std::move(it->second.model->segs_);
+    it->second.model->segs_.clear();
+    return result;
+}
+
+VadStats VadBatchEngine::stats(int stream_id) const {
+    auto it = streams_.find(stream_id);
+    return it == streams_.end() ? VadStats() : it->second.model->stats();
+}
+
+} // namespace VadFilterOnnx
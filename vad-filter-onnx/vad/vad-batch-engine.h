@@ -0,0 +1,69 @@
+#pragma once
+
+#include "vad/vad-model.h"
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace VadFilterOnnx {
+
+/**
+ * @brief Collects ready frames from many streams of one handle and runs them in a single
+ * batched Session::Run, then feeds each probability back into its stream's state machine.
+ *
+ * Streams may use different VadConfigs. Frames are grouped by frame length and sample rate,
+ * since one batch shares one input tensor and Silero's scalar `sr` input. The energy gate and
+ * the adaptive stride skip the model per stream as in decode(); with enable_stats, each run()
+ * is counted like one decode() call. Not thread-safe.
+ */
+class VadBatchEngine {
+  public:
+    // The handle must outlive the engine. FSMN is chunk based and cannot be batched.
+    static std::unique_ptr<VadBatchEngine> create(VadModel *handle, int max_batch_size = 64);
+
+    explicit VadBatchEngine(VadModel *handle, int max_batch_size);
+
+    int add_stream(const VadConfig &config);
+    void remove_stream(int stream_id);
+
+    // Queue audio for a stream. Data is copied, inference happens in run().
+    bool accept(int stream_id, const float *data, int n, bool input_finished);
+
+    // Run batched inference until no stream has a full frame. Returns the number of frames.
+    int run();
+
+    // Take the segments produced for a stream since the last fetch.
+    std::vector<VadSegment> fetch(int stream_id);
+    // Counters of a stream with enable_stats, published at the end of every run()
+    VadStats stats(int stream_id) const;
+
+    int num_streams() const { return static_cast<int>(streams_.size()); }
+
+  private:
+    struct Stream {
+        std::unique_ptr<VadModel> model;
+        std::vector<float> buffer;
+        size_t offset = 0;
+        bool input_finished = false;
+        std::optional<VadModel::StatsScope> stats_scope; // open during run()
+    };
+
+    bool ready(const Stream &s) const;
+    void run_batch(Stream *const *batch, int size);
+
+    VadModel *handle_;
+    int max_batch_size_;
+    bool batching_supported_ = true;
+    int next_id_ = 0;
+    std::unordered_map<int, Stream> streams_;
+
+    // Scratch buffers reused across runs
+    // (frame_length, sample_rate) -> ready streams
+    std::vector<std::pair<std::pair<int, int>, std::vector<Stream *>>> groups_;
+    std::vector<VadModel *> models_;
+    std::vector<const float *> frames_;
+    std::vector<float> probs_;
+};
+
+} // namespace VadFilterOnnx
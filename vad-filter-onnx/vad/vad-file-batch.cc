@@ -0,0 +1,89 @@
+#include "vad/vad-file-batch.h"
+#include "utils/wave-reader.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+namespace VadFilterOnnx {
+
+namespace {
+
+void decode_input(VadModel *model, const VadBatchInput &input, int input_rate,
+                  VadBatchResult *result) {
+    model->reset();
+    std::vector<VadSegment> segs;
+    if (input.data) {
+        // decode() only reads the samples
+        segs = model->decode(const_cast<float *>(input.data), input.n, true);
+    } else if (input.pcm16) {
+        segs = model->decode(input.pcm16, input.n, true);
+    } else {
+        auto wav = WaveReader::open(input.path);
+        if (!wav) {
+            return;
+        }
+        if (wav->sample_rate() != input_rate) {
+            printf("ERROR: %s is %d Hz, the config expects %d Hz\n", input.path.c_str(),
+                   wav->sample_rate(), input_rate);
+            return;
+        }
+        // One second at a time, converted from the mapping into a fixed block
+        int channels = wav->num_channels();
+        std::vector<float> block(static_cast<size_t>(input_rate) * channels);
+        do {
+            int n = wav->read(block.data(), input_rate);
+            bool last = wav->position() >= wav->num_frames();
+            auto part = channels == 1 ? model->decode(block.data(), n, last)
+                                      : model->decode_interleaved(block.data(), n, channels,
+                                                                  ChannelMode::Downmix, last);
+            segs.insert(segs.end(), part.begin(), part.end());
+        } while (wav->position() < wav->num_frames());
+    }
+    // decode() also reports segment starts as they are found; keep the closed segments
+    for (const auto &seg : segs) {
+        if (seg.end != -1) {
+            result->segments.push_back(seg);
+        }
+    }
+    result->ok = true;
+}
+
+} // namespace
+
+std::vector<VadBatchResult> process_batch(VadModel *handle, const VadConfig &config,
+                                          const std::vector<VadBatchInput> &inputs,
+                                          int num_workers) {
+    std::vector<VadBatchResult> results(inputs.size());
+    if (inputs.empty()) {
+        return results;
+    }
+    if (num_workers <= 0) {
+        num_workers = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+    num_workers = std::min(num_workers, static_cast<int>(inputs.size()));
+    int input_rate = config.input_sample_rate > 0 ? config.input_sample_rate : config.sample_rate;
+
+    // Inputs are claimed one at a time, so long files do not stall a static partition
+    std::atomic<size_t> next{ 0 };
+    auto work = [&]() {
+        auto model = handle->init(config);
+        if (!model) {
+            return;
+        }
+        for (size_t i = next++; i < inputs.size(); i = next++) {
+            decode_input(model.get(), inputs[i], input_rate, &results[i]);
+        }
+    };
+    std::vector<std::thread> workers;
+    for (int i = 1; i < num_workers; ++i) {
+        workers.emplace_back(work);
+    }
+    // The calling thread is the last worker
+    work();
+    for (auto &t : workers) {
+        t.join();
+    }
+    return results;
+}
+
+} // namespace VadFilterOnnx
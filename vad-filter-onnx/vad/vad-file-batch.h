@@ -0,0 +1,20 @@
+#pragma once
+
+#include "vad/vad-model.h"
+#include <vector>
+
+namespace VadFilterOnnx {
+
+/**
+ * @brief Offline decode of many independent inputs on a pool of threads.
+ *
+ * Each worker creates one instance of `handle` and decodes whole inputs with it, taking the
+ * next unclaimed input until none are left; the instance is reset between inputs. Results are
+ * in input order. WAV files are streamed from a memory mapping in one-second blocks (see
+ * WaveReader); multichannel files are downmixed.
+ */
+std::vector<VadBatchResult> process_batch(VadModel *handle, const VadConfig &config,
+                                          const std::vector<VadBatchInput> &inputs,
+                                          int num_workers);
+
+} // namespace VadFilterOnnx
@@ -1,8 +1,12 @@
 #include "vad/vad-model.h"
+#include "utils/embedded-models.h"
+#include "utils/mapped-file.h"
 #include "utils/onnx-common.h"
+#include "utils/simd-kernels.h"
 #include "vad/fsmn-vad-model.h"
 #include "vad/silero-vad-model.h"
 #include "vad/ten-vad-model.h"
+#include <cmath>
 // #include <format>
 // #include <iostream>
 
@@ -10,7 +14,48 @@ namespace VadFilterOnnx {
 
 std::unique_ptr<VadModel> VadModel::create(const std::string &path, int num_threads,
                                            int device_id) {
-    std::shared_ptr<Ort::Session> session = ReadOnnx(path, num_threads, device_id);
+    SessionConfig session_config;
+    session_config.num_threads = num_threads;
+    session_config.device_id = device_id;
+    return create(path, session_config);
+}
+
+std::unique_ptr<VadModel> VadModel::create(const std::string &path,
+                                           const SessionConfig &session_config) {
+    std::shared_ptr<MappedFile> file;
+    if (session_config.native_silero_v5) {
+        file = MappedFile::open(path);
+    }
+    return create(ReadOnnx(path, session_config), session_config, path,
+                  file ? file->data() : nullptr, file ? file->size() : 0);
+}
+
+std::unique_ptr<VadModel> VadModel::create_from_buffer(const void *data, size_t size,
+                                                       const SessionConfig &session_config) {
+    return create(ReadOnnx(data, size, session_config), session_config, "<buffer>", data, size);
+}
+
+std::unique_ptr<VadModel> VadModel::create_embedded(const std::string &name,
+                                                    const SessionConfig &session_config) {
+    const EmbeddedModel *embedded = FindEmbeddedModel(name);
+    if (!embedded) {
+        printf("ERROR: Model %s is not embedded, see VAD_EMBED_MODELS\n", name.c_str());
+        return nullptr;
+    }
+    // Static data: a non-owning owner lets ORT-format models run in place
+    std::shared_ptr<const void> owner(embedded->data, [](const void *) {});
+    auto session = ReadOnnx(embedded->data, embedded->size, session_config, owner,
+                            "embedded:" + name);
+    return create(session, session_config, "embedded:" + name, embedded->data, embedded->size);
+}
+
+std::unique_ptr<VadModel> VadModel::create(std::shared_ptr<Ort::Session> session,
+                                           const SessionConfig &session_config,
+                                           const std::string &path, const void *model_data,
+                                           size_t model_size) {
+    if (!session) {
+        return nullptr;
+    }
     std::vector<const char *> input_names, output_names;
     GetInputOutputInfo(session, input_names, output_names);
 
@@ -21,13 +66,26 @@ std::unique_ptr<VadModel> VadModel::create(const std::string &path, int num_thre
         model->type_ = VadType::SileroVadV4;
         printf("Success to create SileroVadV4 model from %s\n", path.c_str());
     } else if (is_silero_vad_v5(input_names, output_names)) {
-        model = std::make_unique<SileroVadModelV5>();
+        auto silero = std::make_unique<SileroVadModelV5>();
+        if (session_config.native_silero_v5) {
+            silero->load_native(model_data, model_size);
+        }
+        model = std::move(silero);
         model->type_ = VadType::SileroVadV5;
         printf("Success to create SileroVadV5 model from %s\n", path.c_str());
     } else if (is_fsmn_vad(input_names, output_names)) {
         model = std::make_unique<FsmnVadModel>();
         model->type_ = VadType::FsmnVad;
         printf("Success to create FsmnVad model from %s\n", path.c_str());
+    } else if (is_fsmn_vad_backbone(input_names, output_names)) {
+        auto fsmn = std::make_unique<FsmnVadModel>();
+        if (!fsmn->load_frontend(session)) {
+            return nullptr;
+        }
+        model = std::move(fsmn);
+        model->type_ = VadType::FsmnVad;
+        printf("Success to create FsmnVad backbone model with native frontend from %s\n",
+               path.c_str());
     } else if (is_ten_vad(input_names, output_names)) {
         model = std::make_unique<TenVadModel>();
         model->type_ = VadType::TenVad;
@@ -38,6 +96,7 @@ std::unique_ptr<VadModel> VadModel::create(const std::string &path, int num_thre
     }
 
     model->session_ = session;
+    model->warmup_runs_ = session_config.warmup_runs;
     model->input_names_ = std::move(input_names);
     model->output_names_ = std::move(output_names);
     return model;
@@ -50,6 +109,9 @@ VadModel::VadModel(const VadModel &other, const VadConfig &config, int frame_shi
       session_(other.session_),
       input_names_(other.input_names_),
       output_names_(other.output_names_),
+      warmup_runs_(other.warmup_runs_),
+      handle_stats_(other.handle_stats_),
+      silence_states_(other.silence_states_),
       frame_length_(frame_length),
       frame_shift_(frame_shift) {
 
@@ -72,16 +134,129 @@ VadModel::VadModel(const VadModel &other, const VadConfig &config, int frame_shi
     // Initialize window detector with the maximum required window size
     int max_win_frames = std::max(speech_window_size_frames_, silence_window_size_frames_);
     window_detector_ = std::make_unique<SlidingWindowBit>(max_win_frames);
+    window_detector_->track(speech_window_size_frames_);
+    window_detector_->track(silence_window_size_frames_);
+
+    framer_ = std::make_unique<AudioFramer>(frame_length_, frame_shift_);
+
+    input_rate_ = config.input_sample_rate > 0 ? config.input_sample_rate : config.sample_rate;
+    if (input_rate_ != config.sample_rate) {
+        resampler_ = StreamingResampler::create(input_rate_, config.sample_rate);
+    }
+
+    if (config.enable_stats) {
+        stats_ = std::make_shared<VadStatsCounters>();
+    }
+
+    // Avoid reallocations in the steady-state decode path
+    segs_.reserve(16);
+}
+
+VadModel::~VadModel() {
+    // Drop this instance's buffered audio from the handle aggregate
+    if (stats_buffered_bytes_) {
+        handle_stats_->add_buffered_bytes(-stats_buffered_bytes_);
+    }
+}
+
+bool VadModel::check_config(const VadConfig &config) {
+    if (config.sample_rate != 8000 && config.sample_rate != 16000) {
+        printf("ERROR: Unsupported model sample rate %d, use 8000 or 16000 and set "
+               "input_sample_rate for other input rates\n",
+               config.sample_rate);
+        return false;
+    }
+    if (config.input_sample_rate > 0 && config.input_sample_rate != config.sample_rate) {
+        // Validates the ratio and prints the reason on failure
+        return StreamingResampler::create(config.input_sample_rate, config.sample_rate) != nullptr;
+    }
+    return true;
 }
 
 void VadModel::reset() {
     init_state();
+    settled_ = false;
+    framer_->reset();
+    window_detector_->reset();
+    if (resampler_) {
+        resampler_->reset();
+    }
+    for (auto &model : channel_models_) {
+        model->reset();
+    }
+    fed_channels_ = 1;
     current_ = 0;
     last_end_ = 0;
     start_ = -1;
     end_ = -1;
     seg_idx_ = 0;
     segs_.clear();
+    stride_ = 1;
+    hold_ = 0;
+    if (speech_filter_) {
+        speech_filter_->reset();
+    }
+    // Drops counts from warm-up and other paths outside decode()
+    stats_delta_ = VadStatsDelta();
+}
+
+void VadModel::warmup() {
+    if (warmup_runs_ > 0) {
+        // Run silence through the full decode path: the first Session::Run pays for lazy
+        // kernel and buffer initialization, which would otherwise land on the first real frame.
+        int chunk = std::max(frame_length_, 100 * samples_per_ms_);
+        std::vector<float> silence(static_cast<size_t>(warmup_runs_) * chunk + frame_length_,
+                                   0.0f);
+        process(silence.data(), static_cast<int>(silence.size()), true);
+        reset();
+    }
+    // After the warm-up, which must not be gated or strided
+    if (config_.enable_energy_gate) {
+        prepare_energy_gate();
+        reset();
+    }
+    if (config_.enable_adaptive_stride) {
+        max_stride_ =
+            1 + std::max(config_.adaptive_stride_max_latency_ms, 0) * samples_per_ms_ / frame_shift_;
+    }
+}
+
+void VadModel::prepare_energy_gate() {
+    // Iterations allowed for the state to converge on digital silence
+    constexpr int kMaxSettleFrames = 200;
+    constexpr float kSettleTolerance = 1e-6f;
+
+    std::vector<float> *state = recurrent_state();
+    if (state) {
+        std::lock_guard<std::mutex> lock(silence_states_->mutex);
+        auto key = std::make_pair(frame_length_, config_.sample_rate);
+        for (const auto &entry : silence_states_->states) {
+            if (entry.first == key) {
+                settled_state_ = entry.second;
+            }
+        }
+        if (!settled_state_) {
+            // Feed zeros from the reset state until the state stops changing
+            std::vector<float> zeros(frame_length_, 0.0f);
+            std::vector<float> prev = *state;
+            for (int i = 0; i < kMaxSettleFrames; ++i) {
+                forward(zeros.data(), frame_length_);
+                state = recurrent_state();
+                float diff = 0.0f;
+                for (size_t k = 0; k < state->size(); ++k) {
+                    diff = std::max(diff, std::abs((*state)[k] - prev[k]));
+                }
+                prev = *state;
+                if (diff < kSettleTolerance) {
+                    break;
+                }
+            }
+            settled_state_ = std::make_shared<const std::vector<float>>(std::move(prev));
+            silence_states_->states.emplace_back(key, settled_state_);
+        }
+    }
+    // dBFS of the mean square, compared as a sum of squares over the frame
+    gate_floor_ = frame_length_ * std::pow(10.0f, config_.energy_gate_dbfs / 10.0f);
 }
 
 void VadModel::on_voice_start() {
@@ -94,9 +269,13 @@ void VadModel::on_voice_start() {
     // setup start segment
     VadSegment seg;
     seg.idx = seg_idx_;
-    seg.start = start_;
+    seg.start = to_input(start_);
     seg.start_ms = start_ / samples_per_ms_;
+    seg.channel = channel_;
     segs_.push_back(seg);
+    if (listener_ && !splitting_) {
+        listener_->on_speech_start(seg, decision_pos_);
+    }
 }
 
 void VadModel::on_voice_end() {
@@ -109,21 +288,73 @@ void VadModel::on_voice_end() {
     // If on_voice_start was called in the same decode() call, segs_ already has a partial segment.
     if (!segs_.empty() && segs_.back().end == -1) {
         auto &last_seg = segs_.back();
-        last_seg.end = end_;
+        last_seg.end = to_input(end_);
         last_seg.end_ms = end_ / samples_per_ms_;
     } else {
         // Speech started in a previous decode() call, need to add the finished segment.
-        segs_.emplace_back(seg_idx_, start_, end_, start_ / samples_per_ms_,
-                           end_ / samples_per_ms_);
+        segs_.emplace_back(seg_idx_, to_input(start_), to_input(end_), start_ / samples_per_ms_,
+                           end_ / samples_per_ms_, channel_);
+    }
+    if (listener_ && !splitting_) {
+        listener_->on_speech_end(segs_.back(), decision_pos_);
     }
 
     last_end_ = end_;
     start_ = -1;
     end_ = -1;
     seg_idx_++;
+    stats_delta_.segments++;
+}
+
+void VadModel::split_segment() {
+    splitting_ = true;
+    on_voice_end();
+    on_voice_start();
+    splitting_ = false;
+    // Both entries were just appended (or completed) by this frame
+    if (listener_) {
+        listener_->on_forced_split(segs_[segs_.size() - 2], segs_.back(), decision_pos_);
+    }
+    stats_delta_.max_speech_splits++;
+}
+
+void VadModel::set_listener(VadListener *listener) {
+    listener_ = listener;
+    for (auto &model : channel_models_) {
+        model->set_listener(listener);
+    }
+}
+
+void VadModel::publish_stats(uint64_t begin_ns) {
+    stats_active_ = false;
+    uint64_t total_ns = StatsClockNs() - begin_ns;
+    int64_t buffered = framer_->buffered();
+    for (auto &model : channel_models_) {
+        stats_delta_.merge(model->stats_delta_);
+        model->stats_delta_ = VadStatsDelta();
+        buffered += model->framer_->buffered();
+    }
+    buffered *= static_cast<int64_t>(sizeof(float));
+    uint64_t busy_ns = stats_delta_.inference_ns + stats_delta_.state_ns;
+    uint64_t framing_ns = total_ns > busy_ns ? total_ns - busy_ns : 0;
+    int64_t buffered_change = buffered - stats_buffered_bytes_;
+    stats_buffered_bytes_ = buffered;
+    stats_->publish(stats_delta_, framing_ns, buffered_change);
+    handle_stats_->publish(stats_delta_, framing_ns, buffered_change);
+    stats_delta_ = VadStatsDelta();
 }
 
 void VadModel::update_frame_state(float prob) {
+    uint64_t begin_ns = stats_ ? StatsClockNs() : 0;
+    if (num_frames_ < max_frames_) {
+        frame_probs_[num_frames_] = prob;
+        if (frame_starts_) {
+            frame_starts_[num_frames_] = to_input(current_);
+        }
+        num_frames_++;
+    }
+
+    decision_pos_ = to_input(current_ + frame_length_);
     bool is_speech_frame = prob > config_.threshold;
     window_detector_->push(is_speech_frame);
 
@@ -140,10 +371,27 @@ void VadModel::update_frame_state(float prob) {
             on_voice_end();
         }
     }
+    if (stats_) {
+        stats_delta_.frames++;
+        stats_delta_.state_ns += StatsClockNs() - begin_ns;
+    }
+}
+
+void VadModel::step(float prob) {
+    update_frame_state(prob);
+
+    // Check if current speech segment exceeds maximum allowed duration
+    if (start_ != -1) {
+        if (current_ - start_ > max_speech_samples_) {
+            split_segment();
+        }
+    }
+    current_ += frame_shift_;
 }
 
 VadSegment VadModel::flush() {
     if (start_ != -1) {
+        decision_pos_ = to_input(current_);
         on_voice_end();
         if (!segs_.empty()) {
             return segs_.back();
@@ -153,59 +401,309 @@ VadSegment VadModel::flush() {
 }
 
 std::vector<VadSegment> VadModel::decode(float *data, int n, bool input_finished) {
-    if (n == 0 && !input_finished) {
+    StatsScope stats_scope(this);
+    process_input(data, n, input_finished);
+
+    // Move collected segments to result and clear local cache
+    std::vector<VadSegment> result_segments = std::move(segs_);
+    segs_.clear();
+    return result_segments;
+}
+
+std::vector<VadSegment> VadModel::decode_speech(float *data, int n, bool input_finished,
+                                                std::vector<SpeechChunk> *chunks) {
+    StatsScope stats_scope(this);
+    int max_win_frames = std::max(speech_window_size_frames_, silence_window_size_frames_);
+    if (!speech_filter_) {
+        int fade = static_cast<int>(static_cast<int64_t>(config_.filter_fade_ms) * input_rate_ /
+                                    1000);
+        // A segment starts at most the window plus the left padding before the current frame;
+        // the framer and the resampler look-ahead hold back up to a few frames of input
+        int lookback = to_input(max_win_frames * frame_shift_ + left_padding_samples_ +
+                                4 * frame_length_) +
+                       fade;
+        speech_filter_ = std::make_unique<SpeechFilter>(2 * lookback, fade);
+    }
+    process_input(data, n, input_finished);
+
+    // on_voice_end() can still place the end of an open segment this far back
+    int hold_back = std::max(0, max_win_frames * frame_shift_ - right_padding_samples_);
+    int safe_end = start_ == -1 ? 0 : to_input(std::max(start_, current_ - hold_back));
+    speech_filter_->process(data, n, segs_, safe_end, chunks);
+
+    std::vector<VadSegment> result_segments = std::move(segs_);
+    segs_.clear();
+    return result_segments;
+}
+
+std::vector<VadSegment> VadModel::decode(const int16_t *data, int n, bool input_finished) {
+    StatsScope stats_scope(this);
+    process_pcm16(data, n, input_finished);
+
+    std::vector<VadSegment> result_segments = std::move(segs_);
+    segs_.clear();
+    return result_segments;
+}
+
+int VadModel::decode(const int16_t *data, int n, bool input_finished, VadSegment *segments,
+                     int max_segments) {
+    StatsScope stats_scope(this);
+    process_pcm16(data, n, input_finished);
+
+    int count = std::min(static_cast<int>(segs_.size()), max_segments);
+    std::copy(segs_.begin(), segs_.begin() + count, segments);
+    segs_.erase(segs_.begin(), segs_.begin() + count);
+    return count;
+}
+
+std::vector<VadSegment> VadModel::decode(float *data, int n, bool input_finished, float *probs,
+                                         int *frame_starts, int max_frames, int *num_frames) {
+    StatsScope stats_scope(this);
+    frame_probs_ = probs;
+    frame_starts_ = frame_starts;
+    max_frames_ = probs ? max_frames : 0;
+    num_frames_ = 0;
+    auto segments = decode(data, n, input_finished);
+    *num_frames = num_frames_;
+    frame_probs_ = nullptr;
+    frame_starts_ = nullptr;
+    max_frames_ = 0;
+    return segments;
+}
+
+int VadModel::decode(float *data, int n, bool input_finished, VadSegment *segments,
+                     int max_segments) {
+    StatsScope stats_scope(this);
+    process_input(data, n, input_finished);
+
+    int count = std::min(static_cast<int>(segs_.size()), max_segments);
+    std::copy(segs_.begin(), segs_.begin() + count, segments);
+    // erase() keeps the capacity of segs_, so no reallocation after warm-up
+    segs_.erase(segs_.begin(), segs_.begin() + count);
+    return count;
+}
+
+// Large enough to amortize the per-call overhead, small enough to stay in L1/L2
+static constexpr int kPcmBlockSamples = 4096;
+
+void VadModel::process_pcm16(const int16_t *data, int n, bool input_finished) {
+    if (pcm_block_.empty()) {
+        pcm_block_.resize(kPcmBlockSamples);
+    }
+    // Convert and frame one bounded block at a time; the framer carries partial frames over
+    int offset = 0;
+    do {
+        int count = std::min(kPcmBlockSamples, n - offset);
+        Int16ToFloat(data + offset, count, pcm_block_.data());
+        offset += count;
+        process_input(pcm_block_.data(), count, input_finished && offset >= n);
+    } while (offset < n);
+}
+
+std::vector<VadSegment> VadModel::decode_interleaved(const float *data, int num_frames,
+                                                     int num_channels, ChannelMode mode,
+                                                     bool input_finished) {
+    StatsScope stats_scope(this);
+    if (!process_interleaved(data, num_frames, num_channels, mode, input_finished)) {
         return {};
     }
+    return take_channel_segments();
+}
 
-    float *ptr = data;
-    int len = n;
-    if (!reminder_.empty()) {
-        reminder_.insert(reminder_.end(), data, data + n);
-        ptr = reminder_.data();
-        len = static_cast<int>(reminder_.size());
+std::vector<VadSegment> VadModel::decode_interleaved(const int16_t *data, int num_frames,
+                                                     int num_channels, ChannelMode mode,
+                                                     bool input_finished) {
+    StatsScope stats_scope(this);
+    if (num_channels <= 0) {
+        printf("ERROR: Invalid channel count %d\n", num_channels);
+        return {};
+    }
+    if (pcm_block_.empty()) {
+        pcm_block_.resize(kPcmBlockSamples);
     }
+    int block_frames = std::max(1, kPcmBlockSamples / num_channels);
+    if (static_cast<int>(pcm_block_.size()) < block_frames * num_channels) {
+        pcm_block_.resize(block_frames * num_channels);
+    }
+    int offset = 0;
+    do {
+        int count = std::min(block_frames, num_frames - offset);
+        Int16ToFloat(data + static_cast<size_t>(offset) * num_channels, count * num_channels,
+                     pcm_block_.data());
+        offset += count;
+        if (!process_interleaved(pcm_block_.data(), count, num_channels, mode,
+                                 input_finished && offset >= num_frames)) {
+            return {};
+        }
+    } while (offset < num_frames);
+    return take_channel_segments();
+}
 
-    // 2. Main inference loop: process frames by shifting window
-    while (len >= frame_length_) {
-        float prob = forward(ptr, frame_length_);
-        update_frame_state(prob);
+std::vector<VadSegment> VadModel::flush_channels() {
+    flush();
+    for (int c = 1; c < fed_channels_; ++c) {
+        channel_models_[c - 1]->flush();
+    }
+    return take_channel_segments();
+}
 
-        // Check if current speech segment exceeds maximum allowed duration
-        if (start_ != -1) {
-            if (current_ - start_ > max_speech_samples_) {
-                on_voice_end();
-                on_voice_start();
-            }
+std::vector<VadSegment> VadModel::take_channel_segments() {
+    std::vector<VadSegment> result_segments = std::move(segs_);
+    segs_.clear();
+    for (auto &model : channel_models_) {
+        result_segments.insert(result_segments.end(), model->segs_.begin(), model->segs_.end());
+        model->segs_.clear();
+    }
+    return result_segments;
+}
+
+bool VadModel::process_interleaved(const float *data, int frames, int channels, ChannelMode mode,
+                                   bool input_finished) {
+    if (channels <= 0) {
+        printf("ERROR: Invalid channel count %d\n", channels);
+        return false;
+    }
+    int per_channel = mode == ChannelMode::PerChannel ? channels : 1;
+    // Channels no longer fed would resume from stale framer and recurrent state: close their
+    // segments now and start them over
+    for (int c = per_channel; c < fed_channels_; ++c) {
+        VadModel *model = channel_models_[c - 1].get();
+        model->flush();
+        // Keep what this call still returns and publishes
+        std::vector<VadSegment> segs = std::move(model->segs_);
+        VadStatsDelta delta = model->stats_delta_;
+        model->reset();
+        model->segs_ = std::move(segs);
+        model->stats_delta_ = delta;
+    }
+    if (channels == 1) {
+        fed_channels_ = 1;
+        process_input(const_cast<float *>(data), frames, input_finished);
+        return true;
+    }
+    while (static_cast<int>(channel_models_.size()) < per_channel - 1) {
+        auto model = init(config_);
+        if (!model) {
+            printf("ERROR: Failed to create the instance of channel %d\n",
+                   static_cast<int>(channel_models_.size()) + 1);
+            return false;
+        }
+        model->channel_ = static_cast<int>(channel_models_.size()) + 1;
+        model->listener_ = listener_;
+        channel_models_.push_back(std::move(model));
+    }
+    fed_channels_ = per_channel;
+    // Deinterleave or downmix one block at a time into per-channel scratch, then frame it
+    channel_block_.resize(static_cast<size_t>(per_channel) * kPcmBlockSamples);
+    channel_ptrs_.resize(per_channel);
+    for (int c = 0; c < per_channel; ++c) {
+        channel_ptrs_[c] = channel_block_.data() + static_cast<size_t>(c) * kPcmBlockSamples;
+    }
+
+    int offset = 0;
+    do {
+        int count = std::min(kPcmBlockSamples, frames - offset);
+        const float *src = data + static_cast<size_t>(offset) * channels;
+        if (per_channel == 1) {
+            Downmix(src, count, channels, channel_ptrs_[0]);
+        } else {
+            Deinterleave(src, count, channels, channel_ptrs_.data());
+        }
+        offset += count;
+        bool last = input_finished && offset >= frames;
+        process_input(channel_ptrs_[0], count, last);
+        for (int c = 1; c < per_channel; ++c) {
+            channel_models_[c - 1]->process_input(channel_ptrs_[c], count, last);
         }
+    } while (offset < frames);
+    return true;
+}
+
+void VadModel::process_input(float *data, int n, bool input_finished) {
+    stats_delta_.samples += n;
+    if (!resampler_) {
+        process(data, n, input_finished);
+        return;
+    }
+    // Bounded blocks keep the resampler's output buffer small
+    int offset = 0;
+    do {
+        int count = std::min(kPcmBlockSamples, n - offset);
+        bool last = input_finished && offset + count >= n;
+        resampler_->process(data + offset, count, last, &resampled_);
+        offset += count;
+        process(resampled_.data(), static_cast<int>(resampled_.size()), last);
+    } while (offset < n);
+}
+
+bool VadModel::skip_forward(const float *frame) {
+    if (hold_ > 0) {
+        // Confidently idle: repeat the last decision instead of running the model
+        hold_--;
+        stats_delta_.strided_frames++;
+        step(held_prob_);
+        return true;
+    }
+    if (gate_floor_ > 0.0f && DotProduct(frame, frame, frame_length_) < gate_floor_) {
+        // Digital silence: skip the model; re-entry starts from the settled state
+        if (settled_state_ && !settled_) {
+            std::copy(settled_state_->begin(), settled_state_->end(), recurrent_state()->begin());
+            settled_ = true;
+        }
+        stats_delta_.gated_frames++;
+        step_strided(0.0f);
+        return true;
+    }
+    return false;
+}
 
-        // Advance pointers and counters by frame_shift_
-        ptr += frame_shift_;
-        len -= frame_shift_;
-        current_ += frame_shift_;
+void VadModel::finish_frame(float prob) {
+    settled_ = false;
+    step_strided(prob);
+}
+
+void VadModel::step_strided(float prob) {
+    step(prob);
+    if (max_stride_ > 1) {
+        // Double the stride on every idle evaluation, back to full rate otherwise
+        bool idle = start_ == -1 && prob < config_.adaptive_stride_prob;
+        stride_ = idle ? std::min(stride_ * 2, max_stride_) : 1;
+        hold_ = stride_ - 1;
+        held_prob_ = prob;
+    }
+}
+
+void VadModel::process(float *data, int n, bool input_finished) {
+    if (n == 0 && !input_finished) {
+        return;
     }
 
-    // 3. Finalization or buffer state preservation
+    // Main inference loop: frames are views into `data` except the one straddling the
+    // previous chunk
+    framer_->push(data, n);
+    while (const float *frame = framer_->next()) {
+        if (skip_forward(frame)) {
+            continue;
+        }
+        float prob;
+        if (stats_) {
+            uint64_t begin_ns = StatsClockNs();
+            prob = forward(frame, frame_length_);
+            stats_delta_.add_inference(StatsClockNs() - begin_ns);
+        } else {
+            prob = forward(frame, frame_length_);
+        }
+        finish_frame(prob);
+    }
+
+    // Finalization or buffer state preservation
     if (input_finished) {
         // Force close any active speech segment at the end of input
         flush();
-        reminder_.clear();
+        framer_->reset();
     } else {
         // Save unconsumed data and required overlap for the next decode call
-        if (len > 0) {
-            if (!reminder_.empty()) {
-                std::vector<float> next_reminder(ptr, ptr + len);
-                reminder_ = std::move(next_reminder);
-            } else {
-                reminder_.assign(ptr, ptr + len);
-            }
-        } else {
-            reminder_.clear();
-        }
+        framer_->stash();
     }
-
-    // Move collected segments to result and clear local cache
-    std::vector<VadSegment> result_segments = std::move(segs_);
-    segs_.clear();
-    return result_segments;
 }
 } // namespace VadFilterOnnx
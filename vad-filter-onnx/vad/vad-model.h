@@ -1,8 +1,15 @@
 #pragma once
 
+#include "audio-framer.h"
 #include "sliding-window-bit.h"
+#include "utils/resampler.h"
 #include "vad-config.h"
+#include "vad-listener.h"
+#include "vad/speech-filter.h"
+#include "vad/vad-stats.h"
+#include <cstdint>
 #include <memory>
+#include <mutex>
 #include <onnxruntime_cxx_api.h>
 #include <string>
 #include <vector>
@@ -14,26 +21,154 @@ class VadModel {
     // Factory method to load shared resources (Handle)
     static std::unique_ptr<VadModel> create(const std::string &path, int num_threads = 1,
                                             int device_id = -1);
+    static std::unique_ptr<VadModel> create(const std::string &path,
+                                            const SessionConfig &session_config);
+    // Load from memory; the buffer is only read during the call
+    static std::unique_ptr<VadModel> create_from_buffer(const void *data, size_t size,
+                                                        const SessionConfig &session_config);
+    // Load a model compiled into the library, see VAD_EMBED_MODELS
+    static std::unique_ptr<VadModel> create_embedded(const std::string &name,
+                                                     const SessionConfig &session_config);
 
     VadModel() = default;
-    virtual ~VadModel() = default;
+    virtual ~VadModel();
 
     // Create a new independent instance for inference sharing resources from this handle
     virtual std::unique_ptr<VadModel> init(const VadConfig &config) = 0;
 
-    virtual std::vector<VadSegment> decode(float *data, int n, bool input_finished);
+    std::vector<VadSegment> decode(float *data, int n, bool input_finished);
+    // Write up to max_segments into a caller-supplied buffer and return the count. Segments that
+    // do not fit stay queued for the next call. Allocation free once buffers have warmed up.
+    int decode(float *data, int n, bool input_finished, VadSegment *segments, int max_segments);
+    // 16-bit PCM input, converted block-wise with SIMD; never copied as a whole to float
+    std::vector<VadSegment> decode(const int16_t *data, int n, bool input_finished);
+    int decode(const int16_t *data, int n, bool input_finished, VadSegment *segments,
+               int max_segments);
+    // Interleaved multichannel input: num_frames frames of num_channels samples each.
+    // PerChannel returns the segments grouped by channel. Channels a call no longer feeds (a
+    // switch to Downmix or to fewer channels) are closed and start over if fed again. Returns
+    // nothing if a per-channel instance cannot be created.
+    std::vector<VadSegment> decode_interleaved(const float *data, int num_frames, int num_channels,
+                                               ChannelMode mode, bool input_finished);
+    std::vector<VadSegment> decode_interleaved(const int16_t *data, int num_frames,
+                                               int num_channels, ChannelMode mode,
+                                               bool input_finished);
+    // Also write the speech probability and start sample of each frame scored in this call.
+    // Frames beyond max_frames are not recorded; max_frames(n) is always enough.
+    std::vector<VadSegment> decode(float *data, int n, bool input_finished, float *probs,
+                                   int *frame_starts, int max_frames, int *num_frames);
+    // Filter mode: decode() that also returns the speech audio of the segments as chunks, in
+    // order, as soon as it is final. Chunks are views into `data` or an internal pre-roll ring
+    // (see SpeechFilter) and stay valid until the next call. An open segment lags the input by
+    // the silence window, where its end may still fall. Mono float input only.
+    std::vector<VadSegment> decode_speech(float *data, int n, bool input_finished,
+                                          std::vector<SpeechChunk> *chunks);
+    // Close the open segment of this instance (channel 0 after PerChannel decoding)
     VadSegment flush();
+    // Close the open segments of all channels, grouped by channel like decode_interleaved()
+    std::vector<VadSegment> flush_channels();
     void reset();
+    // Notify `listener` of speech boundaries from inside decode(); nullptr to stop. Not owned,
+    // must outlive the decoding. Also applies to the per-channel instances.
+    void set_listener(VadListener *listener);
+
+    VadType type() const { return type_; }
+    const VadConfig &config() const { return config_; }
+    int frame_length() const { return frame_length_; }
+    int frame_shift() const { return frame_shift_; }
+    // Samples carried over to the next decode() call; 0 on a handle
+    int buffered_samples() const { return framer_ ? framer_->buffered() : 0; }
+    // Upper bound of the frames scored by a decode() call with n samples; 0 on a handle
+    int max_frames(int n) const {
+        if (!framer_) {
+            return 0;
+        }
+        int m = resampler_ ? resampler_->max_output(n) : n;
+        return (framer_->buffered() + m) / frame_shift_ + 1;
+    }
+    // Whether decode() resamples, i.e. positions differ between input and model samples
+    bool resampling() const { return resampler_ != nullptr; }
+
+    // Counters of this instance; all zero unless VadConfig::enable_stats. Safe to call from
+    // any thread while another one decodes.
+    VadStats stats() const { return stats_ ? stats_->snapshot() : VadStats(); }
+    // Sum over all instances of the handle that have stats enabled
+    VadStats handle_stats() const { return handle_stats_->snapshot(); }
+
+    // Run one frame for each of `batch` instances (all created from the same handle) in a
+    // single Session::Run. Returns false if the model cannot be batched.
+    virtual bool forward_batch(VadModel *const * /*models*/, const float *const * /*frames*/,
+                               int /*batch*/, float * /*probs*/) {
+        return false;
+    }
 
   protected:
+    friend class VadBatchEngine;
+
+    // Times one public decode() call and publishes the counters at its end; nested scopes
+    // (decode() calling decode()) are no-ops
+    class StatsScope {
+      public:
+        explicit StatsScope(VadModel *model) : model_(model) {
+            if (model_->stats_ && !model_->stats_active_) {
+                model_->stats_active_ = true;
+                begin_ns_ = StatsClockNs();
+            }
+        }
+        ~StatsScope() {
+            if (begin_ns_) {
+                model_->publish_stats(begin_ns_);
+            }
+        }
+
+      private:
+        VadModel *model_;
+        uint64_t begin_ns_ = 0;
+    };
+
+    // model_data: the ONNX bytes behind the session, for engines that read the weights
+    // themselves (SessionConfig::native_silero_v5); only read during the call
+    static std::unique_ptr<VadModel> create(std::shared_ptr<Ort::Session> session,
+                                            const SessionConfig &session_config,
+                                            const std::string &path,
+                                            const void *model_data = nullptr,
+                                            size_t model_size = 0);
+    // Checked by init() before creating an instance
+    static bool check_config(const VadConfig &config);
+
     // Protected constructor for sub-classes to share resources and pre-calculate parameters
     VadModel(const VadModel &other, const VadConfig &config, int frame_shift, int frame_length);
 
-    virtual float forward(float *data, int n) = 0;
+    // Run inference on the input and append detected segments to segs_
+    virtual void process(float *data, int n, bool input_finished);
+    // Resample to the model rate if needed, then process()
+    void process_input(float *data, int n, bool input_finished);
+    void process_pcm16(const int16_t *data, int n, bool input_finished);
+    bool process_interleaved(const float *data, int frames, int channels, ChannelMode mode,
+                             bool input_finished);
+    std::vector<VadSegment> take_channel_segments();
+    virtual float forward(const float *data, int n) = 0;
     virtual void init_state() = 0;
+    // Recurrent state read by the next forward(), nullptr for stateless models
+    virtual std::vector<float> *recurrent_state() { return nullptr; }
+    // Called by init() after reset(): dummy decode so the first real frame runs at steady state,
+    // then the energy gate setup
+    void warmup();
+    void prepare_energy_gate();
     void update_frame_state(float prob);
+    void step(float prob);
+    // Per-frame path shared by process() and VadBatchEngine. skip_forward() decides frames held
+    // by the adaptive stride or under the energy gate and returns false if the model must run;
+    // finish_frame() then takes the model's probability.
+    bool skip_forward(const float *frame);
+    void finish_frame(float prob);
+    // step() followed by the adaptive stride update
+    void step_strided(float prob);
     void on_voice_start();
     void on_voice_end();
+    // max_speech_ms reached: close the segment and open the next one at the same frame
+    void split_segment();
+    void publish_stats(uint64_t begin_ns);
 
     VadType type_ = VadType::None;
     VadConfig config_;
@@ -41,7 +176,61 @@ class VadModel {
     std::vector<const char *> input_names_;
     std::vector<const char *> output_names_;
     Ort::AllocatorWithDefaultOptions allocator_;
+    int warmup_runs_ = 0;
     std::unique_ptr<SlidingWindowBit> window_detector_;
+    std::unique_ptr<AudioFramer> framer_;
+    std::vector<float> pcm_block_; // int16 conversion scratch, see kPcmBlockSamples
+    std::unique_ptr<StreamingResampler> resampler_; // input_sample_rate -> sample_rate
+    std::vector<float> resampled_;
+    // Multichannel: instances for channels 1.. in PerChannel mode, this one is channel 0
+    std::vector<std::unique_ptr<VadModel>> channel_models_;
+    std::vector<float> channel_block_;
+    std::vector<float *> channel_ptrs_;
+    int channel_ = 0;
+    int fed_channels_ = 1; // channels fed by the last interleaved call, this one included
+
+    // Hot-path counters: per-frame updates go to stats_delta_, published once per decode()
+    std::shared_ptr<VadStatsCounters> stats_;
+    std::shared_ptr<VadStatsCounters> handle_stats_ = std::make_shared<VadStatsCounters>();
+    VadStatsDelta stats_delta_;
+    int64_t stats_buffered_bytes_ = 0;
+    bool stats_active_ = false;
+
+    // Energy gate: frames with a sum of squares below gate_floor_ skip forward()
+    struct SilenceStates {
+        std::mutex mutex;
+        // Keyed by (frame_length, sample_rate); computed once per handle
+        std::vector<std::pair<std::pair<int, int>, std::shared_ptr<const std::vector<float>>>>
+            states;
+    };
+    std::shared_ptr<SilenceStates> silence_states_ = std::make_shared<SilenceStates>();
+    std::shared_ptr<const std::vector<float>> settled_state_;
+    float gate_floor_ = 0.0f;
+    bool settled_ = false;
+
+    // Adaptive stride: the model runs on one frame in stride_, the others repeat held_prob_
+    int max_stride_ = 1;
+    int stride_ = 1;
+    int hold_ = 0;
+    float held_prob_ = 0.0f;
+
+    // Boundary notifications; decision_pos_ is the input position reached by the current frame
+    VadListener *listener_ = nullptr;
+    int decision_pos_ = 0;
+    bool splitting_ = false;
+
+    // forward_batch() scratch of the instance that runs the batch, grown to the largest batch
+    struct BatchBuffers {
+        std::vector<float> x;
+        std::vector<float> states[5];
+        std::vector<const float *> src;
+        std::vector<float *> dst;
+        std::vector<Ort::Value> inputs;
+    };
+    BatchBuffers batch_;
+
+    // Filter mode, created by the first decode_speech()
+    std::unique_ptr<SpeechFilter> speech_filter_;
 
     // Pre-calculated parameters (in samples or frames)
     int samples_per_ms_;
@@ -54,6 +243,12 @@ class VadModel {
     int left_padding_samples_;
     int right_padding_samples_;
     int max_speech_samples_;
+    int input_rate_;
+
+    // Model sample position -> input sample position
+    int to_input(int pos) const {
+        return static_cast<int>(static_cast<int64_t>(pos) * input_rate_ / config_.sample_rate);
+    }
 
     // vad status
     int start_ = -1; // Speech start position, -1 means silence
@@ -62,7 +257,12 @@ class VadModel {
     int last_end_ = 0;
     int seg_idx_ = 0;
     std::vector<VadSegment> segs_;
-    std::vector<float> reminder_;
+
+    // Per-frame output, only set during decode() with probability buffers
+    float *frame_probs_ = nullptr;
+    int *frame_starts_ = nullptr;
+    int max_frames_ = 0;
+    int num_frames_ = 0;
 };
 
 } // namespace VadFilterOnnx
@@ -0,0 +1,224 @@
+#include "vad/vad-sharded-decode.h"
+#include <algorithm>
+#include <cstdlib>
+#include <thread>
+
+namespace VadFilterOnnx {
+
+namespace {
+
+struct ShardSegment {
+    int start;
+    int end;
+    int shard;
+    bool cut;    // closed by the shard end rather than by silence
+    bool split;  // closed by max_speech_ms
+    bool merged; // stitched across a shard boundary
+};
+
+// Collects the idx of the segments closed by max_speech_ms
+class SplitRecorder : public VadListener {
+  public:
+    void on_forced_split(const VadSegment &ended, const VadSegment & /*started*/,
+                         int /*position*/) override {
+        split_idx.push_back(ended.idx);
+    }
+
+    std::vector<int> split_idx;
+};
+
+// Decode data[begin, end), segments found during the warm-up included.
+void decode_shard(VadModel *model, float *data, int begin, int end, int shard, bool last,
+                  std::vector<ShardSegment> *out) {
+    SplitRecorder splits;
+    model->set_listener(&splits);
+    auto segs = model->decode(data + begin, end - begin, last);
+    for (const auto &seg : segs) {
+        // Start-only segments are completed by flush() below
+        if (seg.end == -1) {
+            continue;
+        }
+        bool split = std::find(splits.split_idx.begin(), splits.split_idx.end(), seg.idx) !=
+                     splits.split_idx.end();
+        out->push_back({ seg.start + begin, seg.end + begin, shard, false, split, false });
+    }
+    if (!last) {
+        VadSegment seg = model->flush();
+        if (seg.idx != -1) {
+            out->push_back({ seg.start + begin, seg.end + begin, shard, true, false, false });
+        }
+    }
+    model->set_listener(nullptr);
+}
+
+void report_deviation(const std::vector<VadSegment> &stitched,
+                      const std::vector<VadSegment> &sequential, ShardedDecodeReport *report) {
+    std::vector<bool> matched(stitched.size(), false);
+    long long sum_ms = 0;
+    int num_matched = 0;
+    size_t j = 0;
+    report->num_unmatched_segments = 0;
+    report->max_boundary_deviation_ms = 0;
+    for (const auto &s : sequential) {
+        while (j < stitched.size() && stitched[j].end <= s.start) {
+            ++j;
+        }
+        // Pick the stitched segment with the largest overlap
+        int best = -1;
+        int best_overlap = 0;
+        for (size_t k = j; k < stitched.size() && stitched[k].start < s.end; ++k) {
+            int overlap = std::min(s.end, stitched[k].end) - std::max(s.start, stitched[k].start);
+            if (overlap > best_overlap) {
+                best_overlap = overlap;
+                best = static_cast<int>(k);
+            }
+        }
+        if (best == -1) {
+            report->num_unmatched_segments++;
+            continue;
+        }
+        matched[best] = true;
+        int d_start = std::abs(stitched[best].start_ms - s.start_ms);
+        int d_end = std::abs(stitched[best].end_ms - s.end_ms);
+        report->max_boundary_deviation_ms =
+            std::max({ report->max_boundary_deviation_ms, d_start, d_end });
+        sum_ms += d_start + d_end;
+        num_matched++;
+    }
+    report->num_unmatched_segments +=
+        static_cast<int>(std::count(matched.begin(), matched.end(), false));
+    report->mean_boundary_deviation_ms =
+        num_matched > 0 ? static_cast<float>(sum_ms) / (2 * num_matched) : 0.0f;
+}
+
+} // namespace
+
+std::vector<VadSegment> decode_sharded(VadModel *handle, const VadConfig &config, float *data,
+                                       int n, const ShardedDecodeOptions &options,
+                                       ShardedDecodeReport *report) {
+    auto probe = handle->init(config);
+    if (!probe || n <= 0) {
+        return {};
+    }
+    if (probe->resampling()) {
+        printf("ERROR: decode_sharded does not support input_sample_rate != sample_rate\n");
+        return {};
+    }
+    int samples_per_ms = config.sample_rate / 1000;
+    int shift = probe->frame_shift();
+    // Samples past a shard end needed by the frames that start inside the shard
+    int tail = probe->frame_length() - shift;
+
+    // Shard boundaries and overlaps are aligned to the frame shift so every shard sees the
+    // same frame grid as a sequential run.
+    long long min_shard = std::max(1LL, static_cast<long long>(options.min_shard_ms) * samples_per_ms);
+    int num_shards = static_cast<int>(std::clamp(n / min_shard, 1LL,
+                                                 static_cast<long long>(std::max(1, options.num_threads))));
+    int shard_len = (n + num_shards - 1) / num_shards;
+    shard_len = (shard_len + shift - 1) / shift * shift;
+    num_shards = (n + shard_len - 1) / shard_len;
+    int overlap = std::max(0, options.overlap_ms * samples_per_ms) / shift * shift;
+
+    std::vector<std::unique_ptr<VadModel>> models;
+    models.push_back(std::move(probe));
+    for (int i = 1; i < num_shards; ++i) {
+        models.push_back(handle->init(config));
+        if (!models.back()) {
+            printf("ERROR: decode_sharded failed to create the instance of shard %d\n", i);
+            return {};
+        }
+    }
+
+    std::vector<std::vector<ShardSegment>> results(num_shards);
+    std::vector<std::thread> workers;
+    for (int i = 0; i < num_shards; ++i) {
+        int own_begin = i * shard_len;
+        int own_end = std::min(n, own_begin + shard_len);
+        int begin = std::max(0, own_begin - overlap);
+        bool last = own_end >= n;
+        int end = last ? n : std::min(n, own_end + tail);
+        workers.emplace_back(decode_shard, models[i].get(), data, begin, end, i, last,
+                             &results[i]);
+    }
+    for (auto &t : workers) {
+        t.join();
+    }
+
+    // Stitch: merge a segment cut by a shard end (or overlapping one found during the next
+    // shard's warm-up) with its continuation in the next shard. The next shard counts
+    // max_speech_ms from where its warm-up picked up the speech, not from where a sequential
+    // run did, so its max_speech_ms splits of the continuation are undone too; the merged
+    // segment is re-split below.
+    int tolerance = (config.speech_window_size_ms + config.left_padding_ms) * samples_per_ms;
+    std::vector<ShardSegment> merged;
+    for (int i = 0; i < num_shards; ++i) {
+        int own_begin = i * shard_len;
+        for (const auto &seg : results[i]) {
+            // Segments that end inside the warm-up region were closed by the previous shard,
+            // unless it had to cut them
+            bool warmup = seg.end <= own_begin;
+            if (!merged.empty()) {
+                auto &prev = merged.back();
+                bool overlaps = seg.start <= prev.end && seg.end >= prev.start;
+                bool continues = prev.cut && seg.start >= prev.start &&
+                                 seg.start <= prev.end + tolerance;
+                bool across = prev.shard != seg.shard && (overlaps || continues) &&
+                              (prev.cut || !warmup);
+                bool piece = prev.merged && prev.split && prev.shard == seg.shard;
+                if (across || piece) {
+                    // Only the next shard saw where a cut segment really ends
+                    prev.end = prev.cut ? seg.end : std::max(prev.end, seg.end);
+                    prev.shard = seg.shard;
+                    prev.cut = seg.cut;
+                    prev.split = seg.split;
+                    prev.merged = true;
+                    continue;
+                }
+            }
+            if (warmup) {
+                continue;
+            }
+            merged.push_back(seg);
+        }
+    }
+
+    // Re-apply max_speech_ms to stitched segments; a sequential run splits once a segment
+    // exceeds the limit, at the next frame boundary, and starts the next piece there.
+    int max_speech = config.max_speech_ms * samples_per_ms;
+    std::vector<VadSegment> segments;
+    auto emit = [&](int start, int end) {
+        int idx = static_cast<int>(segments.size());
+        segments.emplace_back(idx, start, end, start / samples_per_ms, end / samples_per_ms);
+    };
+    for (const auto &seg : merged) {
+        int start = seg.start;
+        while (seg.merged) {
+            int split = ((start + max_speech) / shift + 1) * shift;
+            if (seg.end <= split) {
+                break;
+            }
+            emit(start, split);
+            start = split;
+        }
+        emit(start, seg.end);
+    }
+
+    if (report) {
+        *report = ShardedDecodeReport();
+        report->num_shards = num_shards;
+        report->num_segments = static_cast<int>(segments.size());
+        if (options.compare_sequential) {
+            auto model = handle->init(config);
+            if (model) {
+                auto sequential = model->decode(data, n, true);
+                report->num_sequential_segments = static_cast<int>(sequential.size());
+                report_deviation(segments, sequential, report);
+            } else {
+                printf("WARNING: decode_sharded could not run the sequential comparison\n");
+            }
+        }
+    }
+    return segments;
+}
+
+} // namespace VadFilterOnnx
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "vad/vad-model.h"
+#include <vector>
+
+namespace VadFilterOnnx {
+
+/**
+ * @brief Offline decode of a long buffer split into shards that run on parallel threads.
+ *
+ * Each shard runs on its own instance of `handle` and first warms up its recurrent state on
+ * `overlap_ms` of audio preceding the shard. Per-shard segments are stitched into one list:
+ * segments cut at a shard end are merged with their continuation and re-split by
+ * max_speech_ms, duplicates found in the warm-up region are dropped, and `idx` is renumbered.
+ * Returns no segments if an instance cannot be created.
+ */
+std::vector<VadSegment> decode_sharded(VadModel *handle, const VadConfig &config, float *data,
+                                       int n, const ShardedDecodeOptions &options,
+                                       ShardedDecodeReport *report = nullptr);
+
+} // namespace VadFilterOnnx
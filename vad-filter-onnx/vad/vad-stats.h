@@ -0,0 +1,126 @@
+#pragma once
+
+#include "vad-config.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace VadFilterOnnx {
+
+// Monotonic clock for the stats; only read when stats are enabled
+inline uint64_t StatsClockNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now().time_since_epoch())
+                                     .count());
+}
+
+// Plain counters accumulated by the decode thread during one decode() call
+struct VadStatsDelta {
+    uint64_t samples = 0;
+    uint64_t frames = 0;
+    uint64_t gated_frames = 0;
+    uint64_t strided_frames = 0;
+    uint64_t inference_runs = 0;
+    uint64_t inference_ns = 0;
+    uint64_t state_ns = 0;
+    uint64_t segments = 0;
+    uint64_t max_speech_splits = 0;
+    uint64_t inference_latency_us[VadStats::kNumLatencyBuckets] = {};
+
+    void add_inference(uint64_t ns) {
+        inference_runs++;
+        inference_ns += ns;
+        uint64_t us = ns / 1000;
+        int bucket = 0;
+        while (us > 0 && bucket < VadStats::kNumLatencyBuckets - 1) {
+            us >>= 1;
+            bucket++;
+        }
+        inference_latency_us[bucket]++;
+    }
+
+    void merge(const VadStatsDelta &o) {
+        samples += o.samples;
+        frames += o.frames;
+        gated_frames += o.gated_frames;
+        strided_frames += o.strided_frames;
+        inference_runs += o.inference_runs;
+        inference_ns += o.inference_ns;
+        state_ns += o.state_ns;
+        segments += o.segments;
+        max_speech_splits += o.max_speech_splits;
+        for (int i = 0; i < VadStats::kNumLatencyBuckets; ++i) {
+            inference_latency_us[i] += o.inference_latency_us[i];
+        }
+    }
+};
+
+// Counters readable from any thread without locking. publish() uses atomic adds, so an
+// instance and the handle aggregate shared by many instances take the same path; it runs once
+// per decode() call, the per-frame work only touches the plain VadStatsDelta.
+class VadStatsCounters {
+  public:
+    void publish(const VadStatsDelta &d, uint64_t framing_ns, int64_t buffered_bytes_change) {
+        auto add = [](auto &counter, auto v) {
+            if (v) {
+                counter.fetch_add(v, std::memory_order_relaxed);
+            }
+        };
+        add(decode_calls_, uint64_t{ 1 });
+        add(samples_, d.samples);
+        add(frames_, d.frames);
+        add(gated_frames_, d.gated_frames);
+        add(strided_frames_, d.strided_frames);
+        add(inference_runs_, d.inference_runs);
+        add(inference_ns_, d.inference_ns);
+        add(state_ns_, d.state_ns);
+        add(framing_ns_, framing_ns);
+        add(segments_, d.segments);
+        add(max_speech_splits_, d.max_speech_splits);
+        add(buffered_bytes_, buffered_bytes_change);
+        for (int i = 0; i < VadStats::kNumLatencyBuckets; ++i) {
+            add(inference_latency_us_[i], d.inference_latency_us[i]);
+        }
+    }
+
+    void add_buffered_bytes(int64_t change) {
+        buffered_bytes_.fetch_add(change, std::memory_order_relaxed);
+    }
+
+    VadStats snapshot() const {
+        VadStats s;
+        s.decode_calls = decode_calls_.load(std::memory_order_relaxed);
+        s.samples = samples_.load(std::memory_order_relaxed);
+        s.frames = frames_.load(std::memory_order_relaxed);
+        s.gated_frames = gated_frames_.load(std::memory_order_relaxed);
+        s.strided_frames = strided_frames_.load(std::memory_order_relaxed);
+        s.inference_runs = inference_runs_.load(std::memory_order_relaxed);
+        s.inference_ns = inference_ns_.load(std::memory_order_relaxed);
+        s.state_ns = state_ns_.load(std::memory_order_relaxed);
+        s.framing_ns = framing_ns_.load(std::memory_order_relaxed);
+        s.segments = segments_.load(std::memory_order_relaxed);
+        s.max_speech_splits = max_speech_splits_.load(std::memory_order_relaxed);
+        s.buffered_bytes = buffered_bytes_.load(std::memory_order_relaxed);
+        for (int i = 0; i < VadStats::kNumLatencyBuckets; ++i) {
+            s.inference_latency_us[i] = inference_latency_us_[i].load(std::memory_order_relaxed);
+        }
+        return s;
+    }
+
+  private:
+    std::atomic<uint64_t> decode_calls_{ 0 };
+    std::atomic<uint64_t> samples_{ 0 };
+    std::atomic<uint64_t> frames_{ 0 };
+    std::atomic<uint64_t> gated_frames_{ 0 };
+    std::atomic<uint64_t> strided_frames_{ 0 };
+    std::atomic<uint64_t> inference_runs_{ 0 };
+    std::atomic<uint64_t> inference_ns_{ 0 };
+    std::atomic<uint64_t> state_ns_{ 0 };
+    std::atomic<uint64_t> framing_ns_{ 0 };
+    std::atomic<uint64_t> segments_{ 0 };
+    std::atomic<uint64_t> max_speech_splits_{ 0 };
+    std::atomic<int64_t> buffered_bytes_{ 0 };
+    std::atomic<uint64_t> inference_latency_us_[VadStats::kNumLatencyBuckets] = {};
+};
+
+} // namespace VadFilterOnnx
@@ -0,0 +1,204 @@
+#include "vad/vad-stream-pool.h"
+#include <algorithm>
+#include <chrono>
+
+namespace VadFilterOnnx {
+
+namespace {
+// Index of the pool worker running on this thread, -1 for other threads
+thread_local int tls_worker = -1;
+} // namespace
+
+VadStreamPool::VadStreamPool(VadModel *handle, int num_workers) : handle_(handle) {
+    if (num_workers <= 0) {
+        num_workers = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (int i = 0; i < num_workers; ++i) {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+    for (int i = 0; i < num_workers; ++i) {
+        workers_[i]->thread = std::thread(&VadStreamPool::run, this, i);
+    }
+}
+
+VadStreamPool::~VadStreamPool() {
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto &w : workers_) {
+        w->thread.join();
+    }
+}
+
+int VadStreamPool::add_stream(const VadConfig &config) {
+    auto model = handle_->init(config);
+    if (!model) {
+        return -1;
+    }
+    auto stream = std::make_shared<Stream>();
+    stream->model = std::move(model);
+    std::unique_lock<std::shared_mutex> lock(streams_mutex_);
+    stream->id = next_id_++;
+    streams_[stream->id] = stream;
+    return stream->id;
+}
+
+void VadStreamPool::remove_stream(int stream_id) {
+    // A worker still holding the stream keeps it alive until its decode returns
+    std::unique_lock<std::shared_mutex> lock(streams_mutex_);
+    streams_.erase(stream_id);
+}
+
+bool VadStreamPool::ready(const Stream &s) const {
+    return s.input_finished ||
+           static_cast<int>(s.pending.size()) + s.carried >= s.model->frame_length();
+}
+
+bool VadStreamPool::feed(int stream_id, const float *data, int n, bool input_finished) {
+    std::shared_ptr<Stream> stream;
+    {
+        std::shared_lock<std::shared_mutex> lock(streams_mutex_);
+        auto it = streams_.find(stream_id);
+        if (it == streams_.end()) {
+            return false;
+        }
+        stream = it->second;
+    }
+
+    bool wake = false;
+    {
+        std::lock_guard<std::mutex> lock(stream->mutex);
+        if (n > 0) {
+            stream->pending.insert(stream->pending.end(), data, data + n);
+        }
+        stream->input_finished = stream->input_finished || input_finished;
+        if (!stream->scheduled && ready(*stream)) {
+            stream->scheduled = true;
+            wake = true;
+        }
+    }
+    if (wake) {
+        schedule(std::move(stream));
+    }
+    return true;
+}
+
+void VadStreamPool::schedule(std::shared_ptr<Stream> stream) {
+    // Workers push to their own deque, other threads spread streams round-robin
+    int w = tls_worker;
+    if (w < 0) {
+        w = static_cast<int>(next_worker_.fetch_add(1, std::memory_order_relaxed) %
+                             workers_.size());
+    }
+    {
+        std::lock_guard<std::mutex> lock(workers_[w]->mutex);
+        workers_[w]->tasks.push_back(std::move(stream));
+    }
+    // Seq-cst pairs with run(): a worker counts itself idle before checking num_tasks_, and
+    // the task is counted before num_idle_ is read, so either the worker sees the task or this
+    // sees the worker. The lock keeps the notify from landing before that worker blocks.
+    num_tasks_++;
+    if (num_idle_ > 0) {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        wake_.notify_one();
+    }
+}
+
+std::shared_ptr<VadStreamPool::Stream> VadStreamPool::pop(int worker) {
+    // Own deque first, oldest task first: a rescheduled stream goes to the back, behind every
+    // stream that was waiting, so a busy stream cannot starve the others
+    {
+        Worker &own = *workers_[worker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            auto stream = std::move(own.tasks.front());
+            own.tasks.pop_front();
+            num_tasks_--;
+            return stream;
+        }
+    }
+    // Steal the oldest task of another worker
+    int num = static_cast<int>(workers_.size());
+    for (int k = 1; k < num; ++k) {
+        Worker &victim = *workers_[(worker + k) % num];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            auto stream = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            num_tasks_--;
+            return stream;
+        }
+    }
+    return nullptr;
+}
+
+void VadStreamPool::run(int worker) {
+    tls_worker = worker;
+    std::vector<float> work;
+    while (true) {
+        auto stream = pop(worker);
+        if (stream) {
+            decode(stream, work);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(wake_mutex_);
+        num_idle_++;
+        wake_.wait(lock, [this] { return stop_ || num_tasks_ > 0; });
+        num_idle_--;
+        if (stop_) {
+            break;
+        }
+    }
+}
+
+void VadStreamPool::decode(const std::shared_ptr<Stream> &stream, std::vector<float> &work) {
+    bool input_finished;
+    {
+        std::lock_guard<std::mutex> lock(stream->mutex);
+        // Swap buffers so the feeding thread reuses the worker's previous allocation
+        work.clear();
+        std::swap(work, stream->pending);
+        input_finished = stream->input_finished;
+        stream->input_finished = false;
+    }
+
+    VadStreamResult result;
+    result.stream_id = stream->id;
+    result.segments = stream->model->decode(work.data(), static_cast<int>(work.size()),
+                                            input_finished);
+    result.finished = input_finished;
+
+    bool again;
+    {
+        std::lock_guard<std::mutex> lock(stream->mutex);
+        stream->carried = stream->model->buffered_samples();
+        again = ready(*stream);
+        stream->scheduled = again;
+    }
+
+    if (!result.segments.empty() || result.finished) {
+        {
+            std::lock_guard<std::mutex> lock(results_mutex_);
+            results_.push_back(std::move(result));
+        }
+        results_ready_.notify_one();
+    }
+    if (again) {
+        schedule(stream);
+    }
+}
+
+bool VadStreamPool::poll(VadStreamResult *result, int timeout_ms) {
+    std::unique_lock<std::mutex> lock(results_mutex_);
+    if (!results_ready_.wait_for(lock, std::chrono::milliseconds(timeout_ms),
+                                 [this] { return !results_.empty(); })) {
+        return false;
+    }
+    *result = std::move(results_.front());
+    results_.pop_front();
+    return true;
+}
+
+} // namespace VadFilterOnnx
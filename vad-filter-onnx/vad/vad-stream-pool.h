@@ -0,0 +1,87 @@
+#pragma once
+
+#include "vad/vad-model.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace VadFilterOnnx {
+
+/**
+ * @brief Decodes many streams of one handle on a fixed set of worker threads.
+ *
+ * Audio can be fed from any thread. A stream is scheduled once it holds enough samples for a
+ * frame; each worker owns a FIFO queue of scheduled streams and steals from the other workers
+ * when its own queue is empty. A stream is decoded by at most one worker at a time, so its state
+ * is never shared. Segments are delivered through a completion queue.
+ *
+ * Create the handle with SessionConfig::num_threads = 1: parallelism comes from the workers.
+ */
+class VadStreamPool {
+  public:
+    // The handle must outlive the pool
+    VadStreamPool(VadModel *handle, int num_workers);
+    ~VadStreamPool();
+
+    int add_stream(const VadConfig &config);
+    void remove_stream(int stream_id);
+
+    // Queue audio for a stream. Data is copied. Thread-safe.
+    bool feed(int stream_id, const float *data, int n, bool input_finished);
+
+    // Wait up to timeout_ms for a result. Returns false on timeout.
+    bool poll(VadStreamResult *result, int timeout_ms);
+
+    int num_workers() const { return static_cast<int>(workers_.size()); }
+
+  private:
+    struct Stream {
+        int id = -1;
+        std::unique_ptr<VadModel> model;
+        std::mutex mutex;
+        std::vector<float> pending;
+        int carried = 0; // samples held by the model's framer
+        bool input_finished = false;
+        bool scheduled = false;
+    };
+
+    struct Worker {
+        std::mutex mutex;
+        std::deque<std::shared_ptr<Stream>> tasks;
+        std::thread thread;
+    };
+
+    bool ready(const Stream &s) const;
+    void schedule(std::shared_ptr<Stream> stream);
+    std::shared_ptr<Stream> pop(int worker);
+    void run(int worker);
+    void decode(const std::shared_ptr<Stream> &stream, std::vector<float> &work);
+
+    VadModel *handle_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+
+    std::shared_mutex streams_mutex_;
+    std::unordered_map<int, std::shared_ptr<Stream>> streams_;
+    int next_id_ = 0;
+
+    // Idle workers sleep until a stream is scheduled. schedule() only takes wake_mutex_ when
+    // num_idle_ says a worker may be sleeping.
+    std::mutex wake_mutex_;
+    std::condition_variable wake_;
+    std::atomic<int> num_tasks_{ 0 };
+    std::atomic<int> num_idle_{ 0 };
+    std::atomic<unsigned> next_worker_{ 0 };
+    std::atomic<bool> stop_{ false };
+
+    std::mutex results_mutex_;
+    std::condition_variable results_ready_;
+    std::deque<VadStreamResult> results_;
+};
+
+} // namespace VadFilterOnnx